@@ -459,7 +459,7 @@ protected:
     // Leaf nodes
     if (npts) {
      for (int i = 0; i < npts; i++) {
-         std::vector<double> tp = point(pts, leaf.p[i]);
+         const auto &tp = point(pts, leaf.p[i]);
          if (tp[0] >= params[threadNum].p[0] && tp[0] <= params[threadNum].p0[0]
           && tp[1] >= params[threadNum].p[1] && tp[1] <= params[threadNum].p0[1]
           && tp[2] >= params[threadNum].p[2] && tp[2] <= params[threadNum].p0[2]) {
@@ -10,7 +10,7 @@
 
 
 struct IndexAccessor {
-    inline point operator() (const std::vector<point> &data, size_t index) {
+    inline const point &operator() (const std::vector<point> &data, size_t index) {
         return data[index];
     }
 };
@@ -73,6 +73,7 @@ class Test3DTK : public BboxIntersectionTest {
 
     public:
         bool intersections_exact() { return true; } //bounding box search
+        bool concurrent_queries_safe() { return false; } //search parameters are stored per OpenMP thread number, not per caller
 
         Test3DTK() {}
         ~Test3DTK() {
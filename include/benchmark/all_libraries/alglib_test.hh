@@ -10,6 +10,7 @@ class TestAlglib : public BboxIntersectionTest {
         alglib::kdtree tree;
     public:
         bool intersections_exact() { return true; } //bounding box search
+        bool concurrent_queries_safe() { return false; } //query results are buffered inside the tree
 
         TestAlglib() {}
         void build_tree(const std::vector<point> &pts, const std::vector<size_t> &indices) {
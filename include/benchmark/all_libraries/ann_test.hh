@@ -7,13 +7,22 @@ using namespace std;
 
 class TestANN : public BboxIntersectionTest {
     private:
-        ANNbd_tree* tree;
+        ANNbd_tree* tree = nullptr;
         ANNsplitRule split_rule = ANN_KD_SUGGEST; //author's suggestion, sliding midpoint
         ANNshrinkRule shrink_rule = ANN_BD_NONE; //kdtree
         int num_data_pts;
+        //sized once the tree is built and reused by every query. queries aren't concurrent, so one set is enough
+        vector<int> intersections_indices_vect;
+        vector<double> distances;
+
+        void resize_query_scratch() {
+            intersections_indices_vect.resize(num_data_pts);
+            distances.resize(num_data_pts);
+        }
 
     public:
         bool intersections_exact() { return false; } //using a circular radius is not exact
+        bool concurrent_queries_safe() { return false; } //searches share global state
 
         TestANN() {}
         ~TestANN() {
@@ -31,6 +40,7 @@ class TestANN : public BboxIntersectionTest {
                 }
             }
             tree = new ANNbd_tree( data_pts, num_data_pts, num_dims, bucket_size, split_rule, shrink_rule); 
+            resize_query_scratch();
         }
 
         void build_tree(const std::vector<point> &pts, const std::vector<size_t> &pt_indices) {
@@ -51,6 +61,7 @@ class TestANN : public BboxIntersectionTest {
             }
 
             tree = new ANNbd_tree( data_pts, num_data_pts, num_dims, bucket_size, split_rule, shrink_rule); 
+            resize_query_scratch();
         }
 
         void build_tree_bd(const std::vector<point> &pts, const std::vector<size_t> &pt_indices) {
@@ -65,8 +76,6 @@ class TestANN : public BboxIntersectionTest {
             size_t num_nearest_neighbors_to_find = num_data_pts; //don't want to do KNN, want all in radius
             double epsilon = 0.0; //don't want an approximate search
 
-            vector<int> intersections_indices_vect(num_data_pts);
-            vector<double> distances(num_data_pts);
             get_max_squared_radius(my_bbox, mid_pt, squared_radius_search_bound);
 
             size_t num_intersected_pts = tree->annkFRSearch(&mid_pt[0], squared_radius_search_bound, num_data_pts, &intersections_indices_vect[0], &distances[0], epsilon);
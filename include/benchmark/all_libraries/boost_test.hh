@@ -3,6 +3,8 @@
 
 #include <boost/geometry/index/rtree.hpp>
 #include <boost/geometry/geometry.hpp>
+#include <boost/iterator/function_output_iterator.hpp>
+#include <type_traits>
 
 
 typedef boost::geometry::model::point<double, NUM_DIMS, boost::geometry::cs::cartesian> boost_point;
@@ -32,42 +34,44 @@ static void print_boost_point(boost_point my_pt, bool suppress_newline = true) {
 
 
 
-template <class BuildAlg>
+template <class BuildAlg, class T = double>
 class TestBoost : public BboxIntersectionTest {
-
+    typedef boost::geometry::model::point<T, NUM_DIMS, boost::geometry::cs::cartesian> scalar_boost_point;
+    typedef std::pair<scalar_boost_point, size_t> scalar_boost_point_w_index;
+    typedef boost::geometry::model::box<scalar_boost_point> scalar_boost_bbox;
+    typedef std::pair<scalar_boost_bbox, size_t> scalar_boost_bbox_w_index;
 
     private:
-        boost::geometry::index::rtree<boost_point_w_index, BuildAlg> *tree;
-        boost::geometry::index::rtree<boost_bbox_w_index, BuildAlg> *tree_boxes;
+        boost::geometry::index::rtree<scalar_boost_point_w_index, BuildAlg> *tree = nullptr;
+        boost::geometry::index::rtree<scalar_boost_bbox_w_index, BuildAlg> *tree_boxes = nullptr;
         bool uses_boxes = false;
 
-        struct boost_point_w_index_iterator : std::vector<boost_point_w_index>::const_iterator
-        {
-            using base_class = std::vector<boost_point_w_index>::const_iterator;
-            using value_type = size_t;
+        template <class PointT>
+        static scalar_boost_point make_scalar_boost_point(const PointT &pt) {
+            return scalar_boost_point(pt[0], pt[1], pt[2]);
+        }
 
-            using base_class::base_class;
+        //rounded outward so reduced precision searches don't miss results on the query boundary
+        static scalar_boost_bbox make_query_bbox(const bbox &my_bbox) {
+            scalar_bbox<T> rounded_bbox = round_bbox_outward<T>(my_bbox);
+            return scalar_boost_bbox(make_scalar_boost_point(rounded_bbox.first), make_scalar_boost_point(rounded_bbox.second));
+        }
 
-            value_type operator*() const {
-                auto const& src = base_class::operator*();
-                return (src.second );
+        //the query writes each value straight through the output iterator, so no temporary vector of values is built
+        template <class OutputFunc>
+        void _get_intersections(const bbox &my_bbox, OutputFunc output) {
+            if(uses_boxes) {
+                tree_boxes->query(boost::geometry::index::intersects(make_query_bbox(my_bbox)), 
+                    boost::make_function_output_iterator([&output](const scalar_boost_bbox_w_index &value) { output(value.second); }));
             }
-        };
-
-        struct boost_bbox_w_index_iterator : std::vector<boost_bbox_w_index>::const_iterator
-        {
-            using base_class = std::vector<boost_bbox_w_index>::const_iterator;
-            using value_type = size_t;
-
-            using base_class::base_class;
-
-            value_type operator*() const {
-                auto const& src = base_class::operator*();
-                return (src.second);
+            else {
+                tree->query(boost::geometry::index::intersects(make_query_bbox(my_bbox)), 
+                    boost::make_function_output_iterator([&output](const scalar_boost_point_w_index &value) { output(value.second); }));
             }
-        };
+        }
     public:
-        bool intersections_exact() { return true; } //bounding box search
+        //bounding box search, but single precision coordinates only give a superset of the results
+        bool intersections_exact() { return std::is_same<T, double>::value; }
 
         TestBoost() {}
         ~TestBoost() {
@@ -76,11 +80,12 @@ class TestBoost : public BboxIntersectionTest {
         }
 
         void build_tree(const std::vector<point> &pts, const std::vector<size_t> &indices) {
-            std::vector<boost_point_w_index> data;
+            std::vector<scalar_boost_point_w_index> data;
+            data.reserve(pts.size());
             for(int i = 0; i < pts.size(); i++) {
-                data.push_back(std::make_pair(make_boost_point(pts[i]),indices[i]));
+                data.push_back(std::make_pair(make_scalar_boost_point(pts[i]),indices[i]));
             }
-             tree = new boost::geometry::index::rtree<boost_point_w_index, BuildAlg>(data.begin(), data.end());
+             tree = new boost::geometry::index::rtree<scalar_boost_point_w_index, BuildAlg>(data.begin(), data.end());
         }     
 
         void build_tree_bbox(const std::vector<point> &pts, const std::vector<size_t> &indices) {
@@ -89,26 +94,22 @@ class TestBoost : public BboxIntersectionTest {
                 return;
             }
             uses_boxes = true; 
-            std::vector<boost_bbox_w_index> data;
+            std::vector<scalar_boost_bbox_w_index> data;
+            data.reserve(pts.size()/2);
             for(int i = 0; i < pts.size(); i += 2) {
-                data.push_back(std::make_pair(make_boost_bbox(pts[i], pts[i+1]),indices[i/2]));
+                data.push_back(std::make_pair(scalar_boost_bbox(make_scalar_boost_point(pts[i]), make_scalar_boost_point(pts[i+1])),indices[i/2]));
             }
-             tree_boxes = new boost::geometry::index::rtree<boost_bbox_w_index, BuildAlg>(data.begin(), data.end());
+             tree_boxes = new boost::geometry::index::rtree<scalar_boost_bbox_w_index, BuildAlg>(data.begin(), data.end());
         }      
 
         void get_intersections(const bbox &my_bbox, std::vector<size_t> &intersections_indices) {
-            if(uses_boxes) {
-                std::vector<boost_bbox_w_index> results;
-                tree_boxes->query(boost::geometry::index::intersects(make_boost_bbox(my_bbox.first, my_bbox.second)), std::back_inserter(results));
-                intersections_indices.assign(boost_bbox_w_index_iterator(results.begin()),
-                                           boost_bbox_w_index_iterator(results.end()));
-            }
-            else {
-                std::vector<boost_point_w_index> results;
-                tree->query(boost::geometry::index::intersects(make_boost_bbox(my_bbox.first, my_bbox.second)), std::back_inserter(results));
-                intersections_indices.assign(boost_point_w_index_iterator(results.begin()),
-                                           boost_point_w_index_iterator(results.end()));
-            }
+            _get_intersections(my_bbox, [&intersections_indices](size_t index) { intersections_indices.push_back(index); });
+        }
+
+        bool visits_natively() { return true; }
+
+        void visit_intersections(const bbox &my_bbox, ResultSink &sink) {
+            _get_intersections(my_bbox, [&sink](size_t index) { sink.push(index); });
         }
 };
 
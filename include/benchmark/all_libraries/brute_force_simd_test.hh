@@ -0,0 +1,255 @@
+#ifndef BRUTE_FORCE_SIMD_HH
+#define BRUTE_FORCE_SIMD_HH
+
+#include <memory>
+
+//the vector kernels are compiled with per-function target attributes and picked at runtime, so the rest of the build doesn't need -mavx2/-mavx512f
+#if defined(__x86_64__) && defined(__GNUC__)
+    #define BRUTE_FORCE_SIMD_X86 1
+    #include <immintrin.h>
+#else
+    #define BRUTE_FORCE_SIMD_X86 0
+#endif
+
+using namespace std;
+
+enum BruteForceKernel : unsigned short {
+    SCALAR_KERNEL,
+    AVX2_KERNEL,
+    AVX512_KERNEL
+};
+
+//brute force over structure-of-arrays coordinates (one array per dimension, or per box face), so each comparison loads
+//one coordinate for several data points at once. matches are compacted without branches into a small block buffer,
+//which is then appended to the results, so the scan never pushes one index at a time
+class TestBruteForceSIMD : public BboxIntersectionTest {
+
+    private:
+        //number of data points/boxes scanned between appends to the results
+        static const size_t BLOCK_SIZE = 1024;
+
+        BruteForceKernel kernel;
+        bool uses_boxes = false;
+        size_t num_items = 0;
+        //points: mins holds x, y, z. boxes: mins holds the lower corners' x, y, z, and maxs holds the upper corners'
+        std::vector<double> mins[NUM_DIMS];
+        std::vector<double> maxs[NUM_DIMS];
+
+    public:
+        //the kernels are public so the native trees can scan their leaves with them.
+        //the vector kernels store a whole register of indices, even when only some of them match, so out needs this much padding
+        static const size_t BLOCK_PADDING = 8;
+
+        //whether item i overlaps the query. for points the min and max arrays are the same
+        static inline bool item_intersects(const bbox &query, const double *const *item_mins, const double *const *item_maxs, size_t i) {
+            return(
+                   query.first[0] <= item_maxs[0][i] && item_mins[0][i] <= query.second[0]
+                && query.first[1] <= item_maxs[1][i] && item_mins[1][i] <= query.second[1]
+                && query.first[2] <= item_maxs[2][i] && item_mins[2][i] <= query.second[2]
+            );
+        }
+
+        //writes the indices in [begin, end) that intersect the query to out, returning how many there were
+        static size_t scalar_kernel(const bbox &query, const double *const *item_mins, const double *const *item_maxs,
+            size_t begin, size_t end, size_t *out)
+        {
+            size_t num_matches = 0;
+            for(size_t i = begin; i < end; i++) {
+                //always store, but only keep the index by advancing past it if it matches
+                out[num_matches] = i;
+                num_matches += item_intersects(query, item_mins, item_maxs, i);
+            }
+            return num_matches;
+        }
+
+        #if BRUTE_FORCE_SIMD_X86
+            //for each 4 bit match mask, the 32 bit lane permutation that moves the matching 64 bit indices to the front
+            struct avx2_compaction_table {
+                int32_t permutations[16][8];
+
+                avx2_compaction_table() {
+                    for(int mask = 0; mask < 16; mask++) {
+                        int num_set = 0;
+                        for(int j = 0; j < 8; j++) {
+                            permutations[mask][j] = 0;
+                        }
+                        for(int lane = 0; lane < 4; lane++) {
+                            if(mask & (1 << lane)) {
+                                permutations[mask][2*num_set] = 2*lane;
+                                permutations[mask][2*num_set+1] = 2*lane+1;
+                                num_set++;
+                            }
+                        }
+                    }
+                }
+            };
+
+            __attribute__((target("avx2")))
+            static size_t avx2_kernel(const bbox &query, const double *const *item_mins, const double *const *item_maxs,
+                size_t begin, size_t end, size_t *out)
+            {
+                static const avx2_compaction_table table;
+                size_t num_matches = 0;
+                __m256d query_mins[NUM_DIMS];
+                __m256d query_maxs[NUM_DIMS];
+                for(int d = 0; d < NUM_DIMS; d++) {
+                    query_mins[d] = _mm256_set1_pd(query.first[d]);
+                    query_maxs[d] = _mm256_set1_pd(query.second[d]);
+                }
+                const __m256i lane_offsets = _mm256_set_epi64x(3, 2, 1, 0);
+
+                size_t i = begin;
+                for(; i + 4 <= end; i += 4) {
+                    __m256d matches = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+                    for(int d = 0; d < NUM_DIMS; d++) {
+                        matches = _mm256_and_pd(matches, _mm256_cmp_pd(query_mins[d], _mm256_loadu_pd(item_maxs[d] + i), _CMP_LE_OQ));
+                        matches = _mm256_and_pd(matches, _mm256_cmp_pd(_mm256_loadu_pd(item_mins[d] + i), query_maxs[d], _CMP_LE_OQ));
+                    }
+                    int mask = _mm256_movemask_pd(matches);
+                    __m256i indices = _mm256_add_epi64(_mm256_set1_epi64x(i), lane_offsets);
+                    __m256i permutation = _mm256_loadu_si256((const __m256i *)table.permutations[mask]);
+                    _mm256_storeu_si256((__m256i *)(out + num_matches), _mm256_permutevar8x32_epi32(indices, permutation));
+                    num_matches += __builtin_popcount(mask);
+                }
+                return num_matches + scalar_kernel(query, item_mins, item_maxs, i, end, out + num_matches);
+            }
+
+            __attribute__((target("avx512f")))
+            static size_t avx512_kernel(const bbox &query, const double *const *item_mins, const double *const *item_maxs,
+                size_t begin, size_t end, size_t *out)
+            {
+                size_t num_matches = 0;
+                __m512d query_mins[NUM_DIMS];
+                __m512d query_maxs[NUM_DIMS];
+                for(int d = 0; d < NUM_DIMS; d++) {
+                    query_mins[d] = _mm512_set1_pd(query.first[d]);
+                    query_maxs[d] = _mm512_set1_pd(query.second[d]);
+                }
+                const __m512i lane_offsets = _mm512_set_epi64(7, 6, 5, 4, 3, 2, 1, 0);
+
+                size_t i = begin;
+                for(; i + 8 <= end; i += 8) {
+                    __mmask8 mask = 0xFF;
+                    for(int d = 0; d < NUM_DIMS; d++) {
+                        mask = _mm512_mask_cmp_pd_mask(mask, query_mins[d], _mm512_loadu_pd(item_maxs[d] + i), _CMP_LE_OQ);
+                        mask = _mm512_mask_cmp_pd_mask(mask, _mm512_loadu_pd(item_mins[d] + i), query_maxs[d], _CMP_LE_OQ);
+                    }
+                    __m512i indices = _mm512_add_epi64(_mm512_set1_epi64(i), lane_offsets);
+                    _mm512_mask_compressstoreu_epi64(out + num_matches, mask, indices);
+                    num_matches += __builtin_popcount(mask);
+                }
+                return num_matches + scalar_kernel(query, item_mins, item_maxs, i, end, out + num_matches);
+            }
+        #endif
+
+        static bool kernel_supported(BruteForceKernel kernel) {
+            #if BRUTE_FORCE_SIMD_X86
+                if(kernel == AVX2_KERNEL) {
+                    return __builtin_cpu_supports("avx2");
+                }
+                if(kernel == AVX512_KERNEL) {
+                    return __builtin_cpu_supports("avx512f");
+                }
+                return true;
+            #else
+                return kernel == SCALAR_KERNEL;
+            #endif
+        }
+
+        static size_t run_kernel(BruteForceKernel kernel, const bbox &query, const double *const *item_mins, const double *const *item_maxs,
+            size_t begin, size_t end, size_t *out)
+        {
+            #if BRUTE_FORCE_SIMD_X86
+                if(kernel == AVX512_KERNEL) {
+                    return avx512_kernel(query, item_mins, item_maxs, begin, end, out);
+                }
+                if(kernel == AVX2_KERNEL) {
+                    return avx2_kernel(query, item_mins, item_maxs, begin, end, out);
+                }
+            #endif
+            return scalar_kernel(query, item_mins, item_maxs, begin, end, out);
+        }
+
+    private:
+        //calls output(const size_t *indices, size_t num_indices) once per block of matches
+        template <class OutputFunc>
+        void scan(const bbox &query, OutputFunc output) {
+            const double *item_mins[NUM_DIMS];
+            const double *item_maxs[NUM_DIMS];
+            for(int d = 0; d < NUM_DIMS; d++) {
+                item_mins[d] = mins[d].data();
+                item_maxs[d] = uses_boxes ? maxs[d].data() : mins[d].data();
+            }
+
+            size_t block[BLOCK_SIZE + BLOCK_PADDING];
+            for(size_t begin = 0; begin < num_items; begin += BLOCK_SIZE) {
+                size_t end = std::min(begin + BLOCK_SIZE, num_items);
+                size_t num_matches = run_kernel(kernel, query, item_mins, item_maxs, begin, end, block);
+                if(num_matches > 0) {
+                    output(block, num_matches);
+                }
+            }
+        }
+
+    public:
+
+        //exact double precision comparisons
+        bool intersections_exact() { return true; }
+
+        //falls back to the scalar kernel if the cpu doesn't support the requested one
+        TestBruteForceSIMD(BruteForceKernel requested_kernel = SCALAR_KERNEL) {
+            kernel = requested_kernel;
+            if(!kernel_supported(kernel)) {
+                std::cerr << "error. this cpu doesn't support brute force kernel " << kernel << ". using the scalar kernel instead" << std::endl;
+                kernel = SCALAR_KERNEL;
+            }
+        }
+        ~TestBruteForceSIMD() {
+        }
+
+
+        void build_tree(const std::vector<point> &pts, const std::vector<size_t> &indices) {
+            num_items = pts.size();
+            for(int d = 0; d < NUM_DIMS; d++) {
+                mins[d].resize(num_items);
+                for(size_t i = 0; i < num_items; i++) {
+                    mins[d][i] = pts[i][d];
+                }
+            }
+        }
+
+        void build_tree_bbox(const std::vector<point> &pts, const std::vector<size_t> &indices) {
+            if((pts.size() % 2) !=0) {
+                std::cerr << "error. your point list size has to be even to insert bounding boxes" << std::endl;
+                return;
+            }
+            uses_boxes = true;
+            //indices were inserted as i/2 (since there are two points to a bbox)
+            num_items = pts.size()/2;
+            for(int d = 0; d < NUM_DIMS; d++) {
+                mins[d].resize(num_items);
+                maxs[d].resize(num_items);
+                for(size_t i = 0; i < num_items; i++) {
+                    mins[d][i] = pts[2*i][d];
+                    maxs[d][i] = pts[2*i+1][d];
+                }
+            }
+        }
+
+        void get_intersections(const bbox &my_bbox, std::vector<size_t> &intersections_indices) {
+            scan(my_bbox, [&intersections_indices](const size_t *indices, size_t num_indices) {
+                intersections_indices.insert(intersections_indices.end(), indices, indices + num_indices);
+            });
+        }
+
+        bool visits_natively() { return true; }
+
+        void visit_intersections(const bbox &my_bbox, ResultSink &sink) {
+            scan(my_bbox, [&sink](const size_t *indices, size_t num_indices) {
+                sink.push_range(indices, num_indices);
+            });
+        }
+
+};
+
+#endif //BRUTE_FORCE_SIMD_HH
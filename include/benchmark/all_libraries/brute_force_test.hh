@@ -1,35 +1,61 @@
 #ifndef BRUTE_FORCE_HH
 #define BRUTE_FORCE_HH
 
+#include <type_traits>
+
 using namespace std;
 
+template <class T = double>
 class TestBruteForce : public BboxIntersectionTest {
 
 
     private:
-        vector<point> tree;
+        vector<scalar_point<T>> tree;
+        bool uses_boxes = false;
 
-        bool point_intersect(const bbox &query, const point &pt) {
+        bool point_intersect(const scalar_bbox<T> &query, const scalar_point<T> &pt) {
             return(
-                   query.first[0] <= pt[0] && pt[0] <= query.second[0] 
-                && query.first[1] <= pt[1] && pt[1] <= query.second[1] 
-                && query.first[2] <= pt[2] && pt[2] <= query.second[2] 
+                   query.first[0] <= pt[0] && pt[0] <= query.second[0]
+                && query.first[1] <= pt[1] && pt[1] <= query.second[1]
+                && query.first[2] <= pt[2] && pt[2] <= query.second[2]
             );
         }
 
-        bool bbox_intersect(const bbox &query, const point &min_corner, const point &max_corner) {
+        bool bbox_intersect(const scalar_bbox<T> &query, const scalar_point<T> &min_corner, const scalar_point<T> &max_corner) {
             //make sure the query min is less than the box's max and the box's min is less than the query max
             return(
-                   query.first[0] <= max_corner[0] && min_corner[0] <= query.second[0] 
-                && query.first[1] <= max_corner[1] && min_corner[1] <= query.second[1] 
-                && query.first[2] <= max_corner[2] && min_corner[2] <= query.second[2] 
+                   query.first[0] <= max_corner[0] && min_corner[0] <= query.second[0]
+                && query.first[1] <= max_corner[1] && min_corner[1] <= query.second[1]
+                && query.first[2] <= max_corner[2] && min_corner[2] <= query.second[2]
             );
         }
 
 
+        template <class OutputFunc>
+        void scan_points(const bbox &my_bbox, OutputFunc output) {
+            scalar_bbox<T> query = round_bbox_outward<T>(my_bbox);
+            for(int i = 0; i < tree.size(); i++) {
+                if(point_intersect(query, tree[i])) {
+                    output(i);
+                }
+            }
+        }
+
+        template <class OutputFunc>
+        void scan_bboxes(const bbox &my_bbox, OutputFunc output) {
+            scalar_bbox<T> query = round_bbox_outward<T>(my_bbox);
+            for(int i = 0; i < tree.size(); i+=2) {
+                if(bbox_intersect(query, tree[i], tree[i+1])) {
+                    //indices were inserted as i/2 (since there are two points to a bbox)
+                    output(i/2);
+                }
+            }
+        }
+
     public:
 
-        bool intersections_exact() { return true; } //brute force check
+        //brute force check, but single precision coordinates only give a superset of the results
+        bool intersections_exact() { return std::is_same<T, double>::value; }
 
         TestBruteForce() {}
         ~TestBruteForce() {
@@ -37,31 +63,40 @@ class TestBruteForce : public BboxIntersectionTest {
 
 
         void build_tree(const std::vector<point> &pts, const std::vector<size_t> &indices) {
-            tree = pts;
-            size_t total_size = 0;
-            for(int i = 0; i < pts.size(); i++) {
-                for(int j = 0; j < pts[i].size(); j++) {
-                    total_size += sizeof(pts[i][j]);
-                }
+            convert_points(pts, tree);
+        }
+
+        void build_tree_bbox(const std::vector<point> &pts, const std::vector<size_t> &indices) {
+            if((pts.size() % 2) !=0) {
+                std::cerr << "error. your point list size has to be even to insert bounding boxes" << std::endl;
+                return;
             }
+            uses_boxes = true;
+            build_tree(pts, indices);
         }
 
         void get_intersections(const bbox &my_bbox, std::vector<size_t> &intersections_indices) {
-            intersections_indices.reserve(tree.size());
-            for(int i = 0; i < tree.size(); i++) {
-                if(point_intersect(my_bbox, tree[i])) {
-                    intersections_indices.push_back(i);
-                }
+            if(uses_boxes) {
+                get_intersections_bboxes(my_bbox, intersections_indices);
+                return;
             }
+            intersections_indices.reserve(tree.size());
+            scan_points(my_bbox, [&intersections_indices](size_t index) { intersections_indices.push_back(index); });
         }
 
         void get_intersections_bboxes(const bbox &my_bbox, std::vector<size_t> &intersections_indices) {
             intersections_indices.reserve(tree.size());
-            for(int i = 0; i < tree.size(); i+=2) {
-                if(bbox_intersect(my_bbox, tree[i], tree[i+1])) {
-                    //indices were inserted as i/2 (since there are two points to a bbox)
-                    intersections_indices.push_back(i/2);
-                }
+            scan_bboxes(my_bbox, [&intersections_indices](size_t index) { intersections_indices.push_back(index); });
+        }
+
+        bool visits_natively() { return true; }
+
+        void visit_intersections(const bbox &my_bbox, ResultSink &sink) {
+            if(uses_boxes) {
+                scan_bboxes(my_bbox, [&sink](size_t index) { sink.push(index); });
+            }
+            else {
+                scan_points(my_bbox, [&sink](size_t index) { sink.push(index); });
             }
         }
 
@@ -12,6 +12,8 @@
 #include <CGAL/Range_tree_k.h>
 #include <CGAL/AABB_tree.h>
 #include <CGAL/AABB_traits.h>
+#include <type_traits>
+#include <boost/iterator/function_output_iterator.hpp>
 
 
 #ifndef NUM_ELEMS_PER_NODE
@@ -44,32 +46,40 @@ static void print_cgal_point(const cgal_point &pt) {
 
 
 namespace TestCGAL {
+    //the AABB trees stay double only since CGAL::Bbox_3 always stores doubles
+    template <class T = double>
     class KDTree : public BboxIntersectionTest {
-        typedef boost::tuple<cgal_point,uint32_t>              cgal_point_with_index;
-        typedef CGAL::Search_traits_3<cgal_kernel> cgal_traits_base;
+        typedef CGAL::Simple_cartesian<T> scalar_kernel;
+        typedef typename scalar_kernel::Point_3 scalar_cgal_point;
+        typedef boost::tuple<scalar_cgal_point,uint32_t>              cgal_point_with_index;
+        typedef CGAL::Search_traits_3<scalar_kernel> cgal_traits_base;
         typedef CGAL::Search_traits_adapter<cgal_point_with_index, CGAL::Nth_of_tuple_property_map<0, cgal_point_with_index>, cgal_traits_base> Traits;
         typedef CGAL::Kd_tree<Traits> cgal_kd_tree;
         typedef CGAL::Fuzzy_iso_box<Traits> cgal_fuzzy_iso_box;
         typedef CGAL::Sliding_midpoint<Traits> cgal_sliding_midpoint;
 
         private:
-            cgal_kd_tree *tree;
+            cgal_kd_tree *tree = nullptr;
 
-            struct boost_tuple_iterator : std::vector<cgal_point_with_index>::const_iterator
-            {
-                using base_class = std::vector<cgal_point_with_index>::const_iterator;
-                using value_type = size_t;
-
-                using base_class::base_class;
+            static scalar_cgal_point make_scalar_cgal_point(const scalar_point<T> &pt) {
+                return(scalar_cgal_point(pt[0],pt[1],pt[2]));
+            }
 
-                value_type operator*() const {
-                    auto const& src = base_class::operator*();
-                    return (boost::get<1>(src) );
-                }
-            };
+            //the search writes each match straight through the output iterator, so no temporary vector of matches is built
+            template <class OutputFunc>
+            void _get_intersections(const bbox &my_bbox, OutputFunc output) {
+                size_t index = 0; //dummy, don't need our query points to have indices
+                scalar_bbox<T> query = round_bbox_outward<T>(my_bbox);
+                cgal_point_with_index lower_pt =  boost::make_tuple(make_scalar_cgal_point(query.first), index);
+                cgal_point_with_index upper_pt = boost::make_tuple(make_scalar_cgal_point(query.second), index);
+                //the search isn't "fuzzy" since we don't define an error term/epsilon
+                tree->search(boost::make_function_output_iterator([&output](const cgal_point_with_index &value) { output(boost::get<1>(value)); }),
+                    cgal_fuzzy_iso_box(lower_pt, upper_pt));
+            }
 
         public:
-            bool intersections_exact() { return true; } //bounding box search
+            //bounding box search, but single precision coordinates only give a superset of the results
+            bool intersections_exact() { return std::is_same<T, double>::value; }
 
             KDTree() {}
             ~KDTree() {
@@ -87,20 +97,18 @@ namespace TestCGAL {
                 tree = new cgal_kd_tree(sliding_midpoint);
 
                 for(int i = 0; i < pts.size(); i++){
-                    tree->insert(boost::make_tuple(make_cgal_point(pts[i]),i));
+                    tree->insert(boost::make_tuple(scalar_cgal_point((T)pts[i][0],(T)pts[i][1],(T)pts[i][2]),i));
                 }
             }
 
             void get_intersections(const bbox &my_bbox, std::vector<size_t> &intersections_indices) {
-                size_t index = 0; //dummy, don't need our query points to have indices
-                cgal_point_with_index lower_pt =  boost::make_tuple(make_cgal_point(my_bbox.first), index);
-                cgal_point_with_index upper_pt = boost::make_tuple(make_cgal_point(my_bbox.second), index);
-                std::vector<cgal_point_with_index> matching_points;
-                //the search isn't "fuzzy" since we don't define an error term/epsilon
-                tree->search(std::back_inserter(matching_points), cgal_fuzzy_iso_box(lower_pt, upper_pt));
-                intersections_indices.reserve(matching_points.size());
-                intersections_indices.assign(boost_tuple_iterator(matching_points.begin()),
-                                           boost_tuple_iterator(matching_points.end()));
+                _get_intersections(my_bbox, [&intersections_indices](size_t index) { intersections_indices.push_back(index); });
+            }
+
+            bool visits_natively() { return true; }
+
+            void visit_intersections(const bbox &my_bbox, ResultSink &sink) {
+                _get_intersections(my_bbox, [&sink](size_t index) { sink.push(index); });
             }
     };
 
@@ -116,21 +124,7 @@ namespace TestCGAL {
         private:
             // Range_tree_3_type tree;
             Range_tree_3_type *tree;
-            double tolerance = DEFAULT_TOLERANCE; 
-
-
-            struct key_iterator : std::vector<Key>::const_iterator
-            {
-                using base_class = std::vector<Key>::const_iterator;
-                using value_type = size_t;
-
-                using base_class::base_class;
-
-                value_type operator*() const {
-                    auto const& src = base_class::operator*();
-                    return (src.second);
-                }
-            };
+            double tolerance = DEFAULT_TOLERANCE;
 
         public:
             RangeTree() {}
@@ -142,6 +136,7 @@ namespace TestCGAL {
 
             void build_tree(const std::vector<point> &pts, const std::vector<size_t> &indices) {
                 std::vector<Key> InputList ;
+                InputList.reserve(pts.size());
                 for(int i = 0; i < pts.size(); i++) {
                     InputList.push_back(Key(Point(pts[i][0],pts[i][1],pts[i][2]), indices[i]));
                 }
@@ -150,14 +145,11 @@ namespace TestCGAL {
             }
 
             void get_intersections(const bbox &my_bbox, std::vector<size_t> &intersections_indices) {
-                std::vector<Key> OutputList;
                 size_t index = 0; //dummy, we don't need the search interval to have an index
                 //need to add a tolerance since window query doens't include points directly on the end of the interval
                 Interval win(Interval(Key(Point(my_bbox.first[0]-tolerance,my_bbox.first[1]-tolerance,my_bbox.first[2]-tolerance), index), 
                     Key(Point(my_bbox.second[0]+tolerance, my_bbox.second[1]+tolerance,my_bbox.second[2]+tolerance), index)));
-                tree->window_query(win, std::back_inserter(OutputList));
-                intersections_indices.assign(key_iterator(OutputList.begin()),
-                                           key_iterator(OutputList.end()));
+                tree->window_query(win, boost::make_function_output_iterator([&intersections_indices](const Key &key) { intersections_indices.push_back(key.second); }));
             }
     };
 
@@ -176,18 +168,6 @@ namespace TestCGAL {
             Segment_tree_3_type *tree;
             double tolerance = DEFAULT_TOLERANCE; 
 
-            struct interval_iterator : std::vector<Interval>::const_iterator
-            {
-                using base_class = std::vector<Interval>::const_iterator;
-                using value_type = size_t;
-
-                using base_class::base_class;
-
-                value_type operator*() const {
-                    auto const& src = base_class::operator*();
-                    return (src.second);
-                }
-            };
         public:
             SegmentTree() {}
             ~SegmentTree() {
@@ -205,6 +185,7 @@ namespace TestCGAL {
                     return;
                 }
                 std::vector<Interval> InputList;
+                InputList.reserve(pts.size()/2);
                 for(int i = 0; i < pts.size(); i += 2) {
                     InputList.push_back(Interval(Pure_interval(Key(pts[i][0],pts[i][1],pts[i][2]), Key(pts[i+1][0],pts[i+1][1],pts[i+1][2])), indices[i/2]));
                 }
@@ -214,7 +195,6 @@ namespace TestCGAL {
 
             void get_intersections(const bbox &my_bbox, std::vector<size_t> &intersections_indices) {
 
-                std::vector<Interval> OutputList;
                 size_t index = 0; //dummy, we don't need the search interval to have an index
                 //need to add a tolerance since window query doens't include points directly on the end of the interval
                 Interval win(Pure_interval(
@@ -223,9 +203,7 @@ namespace TestCGAL {
                     index
                 );
 
-                tree->window_query(win, std::back_inserter(OutputList));
-                intersections_indices.assign(interval_iterator(OutputList.begin()),
-                                           interval_iterator(OutputList.end()));
+                tree->window_query(win, boost::make_function_output_iterator([&intersections_indices](const Interval &interval) { intersections_indices.push_back(interval.second); }));
             }
     };
 
@@ -292,8 +270,8 @@ namespace TestCGAL {
             typedef CGAL::AABB_tree<My_AABB_traits> Tree;
 
             private:
-                Tree *tree;
-                std::vector<My_triangle> *triangles;
+                Tree *tree = nullptr;
+                std::vector<My_triangle> *triangles = nullptr;
 
                 struct primitive_iterator : std::vector<Tree::Primitive_id>::const_iterator
                 {
@@ -324,6 +302,7 @@ namespace TestCGAL {
 
                     //segfaults if we don't allocate it on the heap
                     triangles = new std::vector<My_triangle>();
+                    triangles->reserve(pts.size()/3);
                     for(int i = 0; i < pts.size(); i += 3) {
                         //need the points to vary in the x, y, and z dimensions
                         triangles->push_back(My_triangle(make_cgal_point(pts[i]),make_cgal_point(pts[i+1]),make_cgal_point(pts[i+2]),indices[i/3]));
@@ -392,8 +371,8 @@ namespace TestCGAL {
             typedef CGAL::AABB_tree<My_AABB_traits> Tree;
 
             private:
-                Tree *tree;
-                std::vector<cgal_isobbox_with_index> *bboxes;
+                Tree *tree = nullptr;
+                std::vector<cgal_isobbox_with_index> *bboxes = nullptr;
 
                 struct primitive_iterator : std::vector<Tree::Primitive_id>::const_iterator
                 {
@@ -424,6 +403,7 @@ namespace TestCGAL {
 
                     //segfaults if we don't allocate it on the heap, this is mentioned in the documentation (the iterator must be kept available for the lifetime of the tree)
                     bboxes = new std::vector<cgal_isobbox_with_index>();
+                    bboxes->reserve(pts.size()/2);
                     for(int i = 0; i < pts.size(); i += 2) {
                         //need the points to vary in the x, y, and z dimensions
                         bboxes->push_back(boost::make_tuple(make_cgal_isobbox(pts[i], pts[i+1]),indices[i/2]));
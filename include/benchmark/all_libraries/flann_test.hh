@@ -6,12 +6,64 @@
 using namespace std;
 
 namespace TestFLANN {
+    //how far apart the squared radii of the queries searched together can be
+    static const double BATCH_SQUARED_RADIUS_RATIO = 1.5;
+
+    //searches the batch's queries sorted by radius, one flann search per run of queries whose squared radii are within
+    //BATCH_SQUARED_RADIUS_RATIO of the run's smallest, using the run's largest radius. the results are returned in the queries' order
+    template <class T, class PointT, class Tree>
+    void radius_search_batch(Tree *tree, const bbox *queries, size_t num_queries, batch_results &results) {
+        if(num_queries == 0) {
+            return;
+        }
+        int num_dims = NUM_DIMS;
+        std::vector<PointT> query_mid_pts(num_queries);
+        std::vector<T> squared_radii(num_queries);
+        std::vector<size_t> order(num_queries);
+        for(size_t i = 0; i < num_queries; i++) {
+            get_max_squared_radius(queries[i], query_mid_pts[i], squared_radii[i]);
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(), [&squared_radii](size_t a, size_t b) { return squared_radii[a] < squared_radii[b]; });
+        //the mid points are stored in radius order, so each run's queries are a contiguous block of rows
+        std::vector<T> mid_pts(num_queries*num_dims);
+        for(size_t i = 0; i < num_queries; i++) {
+            std::copy(query_mid_pts[order[i]].begin(), query_mid_pts[order[i]].end(), mid_pts.begin() + i*num_dims);
+        }
+
+        size_t num_leaves_to_check = FLANN_CHECKS_UNLIMITED;
+        bool search_for_approx_neighbors = false;
+        bool sorted = false;
+
+        std::vector<std::vector<int>> query_results(num_queries);
+        for(size_t run_begin = 0; run_begin < num_queries; ) {
+            size_t run_end = run_begin + 1;
+            while(run_end < num_queries && squared_radii[order[run_end]] <= squared_radii[order[run_begin]] * BATCH_SQUARED_RADIUS_RATIO) {
+                run_end++;
+            }
+            T squared_radius_search_bound = squared_radii[order[run_end-1]] + DEFAULT_TOLERANCE; //doens't include things right on the border so we add a tolerance
+
+            Matrix<T> query(mid_pts.data() + run_begin*num_dims, run_end - run_begin, num_dims);
+            vector<vector<T>> dists;
+            vector<vector<int>> indices;
+            tree->radiusSearch( query, indices, dists, squared_radius_search_bound, flann::SearchParams(num_leaves_to_check, search_for_approx_neighbors, sorted) );
+            for(size_t i = run_begin; i < run_end; i++) {
+                query_results[order[i]] = std::move(indices[i - run_begin]);
+            }
+            run_begin = run_end;
+        }
+        for(size_t i = 0; i < num_queries; i++) {
+            results.indices.insert(results.indices.end(), query_results[i].begin(), query_results[i].end());
+            results.offsets.push_back(results.indices.size());
+        }
+    }
+
     class KDTree : public BboxIntersectionTest {
         private:
 
-            flann::KDTreeSingleIndex<flann::L2_Simple<double>> *tree;
+            flann::KDTreeSingleIndex<flann::L2_Simple<double>> *tree = nullptr;
             //produces an error if the data is not kept accessible
-            double *flattened;
+            double *flattened = nullptr;
 
             void build_tree(const std::vector<point> &pts, const std::vector<size_t> &indices, flann::IndexParams build_params) {
                 int num_rows = pts.size();
@@ -80,13 +132,19 @@ namespace TestFLANN {
                 size_t num_results = tree->radiusSearch( query, indices, dists, squared_radius_search_bound, flann::SearchParams(num_leaves_to_check, search_for_approx_neighbors, sorted) );
                 std::copy(indices[0].begin(), indices[0].begin()+num_results, std::back_inserter(intersections_indices));
             }
+
+            //flann searches every row of the query matrix in one call, but only takes one radius. so the batch is searched in runs of
+            //queries with similar radii, each with the run's largest radius, and the extra results are filtered out like any other radius search
+            void get_intersections_batch(const bbox *queries, size_t num_queries, batch_results &results) {
+                radius_search_batch<double, point>(tree, queries, num_queries, results);
+            }
     };
 
     #if USE_GPU
         class CUDA : public BboxIntersectionTest {
             private:
                 //note - could use other distance functions
-                flann::KDTreeCuda3dIndex<flann::L2_Simple<float>> *tree;
+                flann::KDTreeCuda3dIndex<flann::L2_Simple<float>> *tree = nullptr;
 
                 void build_tree(const std::vector<point> &pts, const std::vector<size_t> &indices, flann::IndexParams build_params) {
                     int num_rows = pts.size();
@@ -158,6 +216,11 @@ namespace TestFLANN {
                     size_t num_results = tree->radiusSearch( query, indices, dists, squared_radius_search_bound, flann::SearchParams(num_leaves_to_check, search_for_approx_neighbors, sorted) );
                     std::copy(indices[0].begin(), indices[0].begin() + num_results,  std::back_inserter(intersections_indices));
                 }
+
+                //same as the cpu version: one device search per run of queries with similar radii
+                void get_intersections_batch(const bbox *queries, size_t num_queries, batch_results &results) {
+                    radius_search_batch<float, point_f>(tree, queries, num_queries, results);
+                }
         };
     #endif
 }
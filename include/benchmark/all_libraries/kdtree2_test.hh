@@ -62,7 +62,8 @@ class TestKDTree2 : public BboxIntersectionTest {
 
         //closed region -> includes Points that fall on the boundary
         void get_intersections(const bbox &my_bbox, std::vector<size_t> &intersections_indices) {
-            point_f mid_pt;
+            //r_nearest takes a std::vector
+            std::vector<float> mid_pt(NUM_DIMS);
             float squared_radius_search_bound = 0;
             get_max_squared_radius(my_bbox, mid_pt, squared_radius_search_bound);
 
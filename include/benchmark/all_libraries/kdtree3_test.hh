@@ -17,6 +17,7 @@ class TestKDTree3 : public BboxIntersectionTest {
 
         void _build_tree(const std::vector<point> &pts, const std::vector<size_t> &indices, size_t bucket_size) {
             vector<point_type::Point3d> points_kdtree;
+            points_kdtree.reserve(pts.size());
             for(int i = 0; i < pts.size(); i++) {
                 points_kdtree.push_back(point_type::Point3d(pts[i][0], pts[i][1], pts[i][2]));
             }
@@ -8,7 +8,7 @@ using namespace std;
 
 class TestKDTree : public BboxIntersectionTest {
     private:
-        KDTree *tree;
+        KDTree *tree = nullptr;
 
     public:
 
@@ -16,16 +16,22 @@ class TestKDTree : public BboxIntersectionTest {
 
         TestKDTree() {}
         ~TestKDTree() {
-            free(tree);
+            delete tree;
         }
    
 
+        //the library only accepts a vector of vectors
         void build_tree(const std::vector<point> &pts, const std::vector<size_t> &indices) {
-            tree = new KDTree(pts);
+            pointVec pts_vec;
+            pts_vec.reserve(pts.size());
+            for(const point &pt : pts) {
+                pts_vec.push_back(point_t(pt.begin(), pt.end()));
+            }
+            tree = new KDTree(pts_vec);
         }
 
         void get_intersections(const bbox &my_bbox, std::vector<size_t> &intersections_indices) {
-            point mid_pt;
+            point_t mid_pt(NUM_DIMS);
             double radius_search_bound = 0;
             get_max_radius(my_bbox, mid_pt, radius_search_bound);
             radius_search_bound+=DEFAULT_TOLERANCE;
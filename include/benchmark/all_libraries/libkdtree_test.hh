@@ -26,7 +26,7 @@ class TestLibkdtree : public BboxIntersectionTest {
     typedef LibKDTree::KDTree<NUM_DIMS,my_point> kdtree;
     private:
 
-        kdtree *tree;
+        kdtree *tree = nullptr;
     public:
         bool intersections_exact() { return false; } //manhattan distance is not exact
 
@@ -38,6 +38,7 @@ class TestLibkdtree : public BboxIntersectionTest {
 
         void build_tree(const std::vector<point> &pts, const std::vector<size_t> &indices) {
             vector<my_point> pts_w_index;
+            pts_w_index.reserve(pts.size());
             for(int i = 0; i < pts.size(); i++) {
                 pts_w_index.push_back(my_point(point_w_index(pts[i],indices[i])));
             }
@@ -7,11 +7,23 @@ using namespace std;
 
 class TestLibnabo : public BboxIntersectionTest {
     private:
-        Nabo::NNSearchD *tree;
-        Eigen::MatrixXd *matrix;
+        Nabo::NNSearchD *tree = nullptr;
+        Eigen::MatrixXd *matrix = nullptr;
         double tolerance = DEFAULT_TOLERANCE;
         bool is_linear_heap = true;
 
+        //the result matrices hold k = num data pts entries, so they are reused across queries instead of being reallocated by each one.
+        //thread local since libnabo's searches are otherwise safe to issue concurrently
+        struct QueryScratch {
+            Eigen::MatrixXi indices;
+            Eigen::MatrixXd dists;
+            Eigen::MatrixXd query;
+        };
+
+        static QueryScratch &get_query_scratch() {
+            static thread_local QueryScratch scratch;
+            return scratch;
+        }
 
     public:
 
@@ -60,9 +72,10 @@ class TestLibnabo : public BboxIntersectionTest {
             size_t k = matrix->cols();
             int num_queries = 1;
             double epsilon = 0.0; //don't want an approximate search
-            Eigen::MatrixXi indices;
-            Eigen::MatrixXd dists;
-            Eigen::MatrixXd query;
+            QueryScratch &scratch = get_query_scratch();
+            Eigen::MatrixXi &indices = scratch.indices;
+            Eigen::MatrixXd &dists = scratch.dists;
+            Eigen::MatrixXd &query = scratch.query;
             int num_dims = my_bbox.first.size();
 
             point mid_pt;
@@ -94,6 +107,51 @@ class TestLibnabo : public BboxIntersectionTest {
             }
          
         }
+
+        //libnabo searches every column of the query matrix in one call and takes a separate radius for each query. 
+        //the output is dense (k rows per query), so large batches are split up
+        void get_intersections_batch(const bbox *queries, size_t num_queries, batch_results &results) {
+            size_t k = matrix->cols();
+            double epsilon = 0.0; //don't want an approximate search
+            int num_dims = NUM_DIMS;
+            size_t max_queries_per_search = max_dense_batch_size(k);
+
+            for(size_t first_query = 0; first_query < num_queries; first_query += max_queries_per_search) {
+                size_t num_sub_queries = std::min(max_queries_per_search, num_queries - first_query);
+                Eigen::MatrixXi indices(k, num_sub_queries);
+                Eigen::MatrixXd dists(k, num_sub_queries);
+                //is column major
+                Eigen::MatrixXd query(num_dims, num_sub_queries);
+                Eigen::VectorXd max_radii(num_sub_queries);
+
+                for(size_t j = 0; j < num_sub_queries; j++) {
+                    point mid_pt;
+                    double radius_search_bound = 0;
+                    get_max_radius(queries[first_query+j], mid_pt, radius_search_bound);
+                    for(int i = 0; i < num_dims; i++) {
+                        query(i,j) = mid_pt[i];
+                    }
+                    max_radii(j) = radius_search_bound + tolerance;
+                }
+                tree->knn(query, indices, dists, max_radii, k, epsilon, Nabo::NNSearchD::ALLOW_SELF_MATCH);
+
+                for(size_t j = 0; j < num_sub_queries; j++) {
+                    for(int i = 0; i < k; i++) {
+                        // means we've found fewer than the max possible number of intersections
+                        if(indices(i,j)  == -1) {
+                            // just have to make sure its not index 0 on a tree heap which will be -1 unless all points match the query
+                            if((i > 0 || is_linear_heap)) {
+                                break;
+                            }
+                        }
+                        else {
+                            results.indices.push_back(indices(i,j));
+                        }
+                    }
+                    results.offsets.push_back(results.indices.size());
+                }
+            }
+        }
 };
 
 #endif //LIBNABO_TEST_HH
@@ -40,6 +40,31 @@ public:
     }
 };
 
+//hands each result straight to a ResultSink
+class SinkIdVisitor : public SpatialIndex::IVisitor
+{
+private:
+    ResultSink *m_sink;
+
+public:
+    SinkIdVisitor(ResultSink &sink) : m_sink(&sink) {
+    }
+
+    void visitNode(const SpatialIndex::INode& )
+    {
+
+    }
+
+    void visitData(const SpatialIndex::IData& d)
+    {
+        m_sink->push(d.getIdentifier());
+    }
+
+    void visitData(std::vector<const SpatialIndex::IData*>& )
+    {
+    }
+};
+
 class MyDataStream : public SpatialIndex::IDataStream
 {
 public:
@@ -98,8 +123,8 @@ public:
 
 class TestLibspatialindex : public BboxIntersectionTest {
     private:
-        SpatialIndex::ISpatialIndex* tree;
-        SpatialIndex::IStorageManager* storage_manager;
+        SpatialIndex::ISpatialIndex* tree = nullptr;
+        SpatialIndex::IStorageManager* storage_manager = nullptr;
 
         void _build_tree(const std::vector<point> &pts, const std::vector<size_t> &indices, bool is_pts = true, 
             size_t interior_node_capacity = NUM_ELEMS_PER_NODE, 
@@ -132,11 +157,14 @@ class TestLibspatialindex : public BboxIntersectionTest {
     public:
 
         bool intersections_exact() { return true; } //bounding box search
+        bool concurrent_queries_safe() { return false; } //the tree locks itself during a query and throws if it is already locked
 
         TestLibspatialindex() {}
 
         ~TestLibspatialindex() {
+            //the tree writes its nodes to the storage manager, so it goes first
             delete tree;
+            delete storage_manager;
         }
 
 
@@ -179,6 +207,14 @@ class TestLibspatialindex : public BboxIntersectionTest {
             tree->intersectsWithQuery(query_region, vis);
              
         }
+
+        bool visits_natively() { return true; }
+
+        void visit_intersections(const bbox &my_bbox, ResultSink &sink) {
+            SpatialIndex::Region query_region(&my_bbox.first[0], &my_bbox.second[0], my_bbox.first.size());
+            SinkIdVisitor vis(sink);
+            tree->intersectsWithQuery(query_region, vis);
+        }
 };
 
 #endif //LIBSPATIALINDEX_TEST_HH
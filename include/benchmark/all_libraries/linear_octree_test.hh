@@ -0,0 +1,221 @@
+#ifndef LINEAR_OCTREE_HH
+#define LINEAR_OCTREE_HH
+
+#include <cfloat>
+#include <cmath>
+#include <numeric>
+
+//an in-house linear octree for points: the points are quantized to 21 bits per dimension and sorted by their 63 bit morton codes, so
+//every octree cell is a contiguous range of the sorted points, which is found with a search over the codes. a query walks the octree
+//cells from the root: cells that miss the query's quantized box are skipped, cells strictly inside it are returned as one range of
+//indices without testing their points (quantizing never decreases a coordinate's cell, so their points are strictly inside the query),
+//and cells on its boundary are split into their 8 children, or scanned with the brute force kernels once they hold at most bucket_size points.
+//the children of a cell are found in order, each by galloping forward from where its sibling's range ended (or by binary search)
+class TestLinearOctree : public BboxIntersectionTest {
+
+    private:
+        static const int MORTON_BITS = 21;
+        static const uint32_t MAX_QUANTIZED = (uint32_t(1) << MORTON_BITS) - 1;
+        static const size_t SCAN_BLOCK_SIZE = 256;
+
+        size_t bucket_size;
+        bool galloping;
+        BruteForceKernel kernel;
+        size_t num_items = 0;
+        double lows[NUM_DIMS];
+        double scales[NUM_DIMS];
+        //the points' morton codes, sorted, and the points (structure-of-arrays) and their indices in the same order
+        std::vector<uint64_t> codes;
+        std::vector<size_t> item_ids;
+        std::vector<double> coords[NUM_DIMS];
+
+        //nondecreasing in value, which is what lets the query skip its interior cells' tests
+        inline uint32_t quantize(double value, int dim) const {
+            double quantized = std::floor((value - lows[dim]) * scales[dim]);
+            if(!(quantized > 0)) {
+                return 0;
+            }
+            if(quantized >= MAX_QUANTIZED) {
+                return MAX_QUANTIZED;
+            }
+            return static_cast<uint32_t>(quantized);
+        }
+
+        //puts two zero bits between each of the low 21 bits
+        static inline uint64_t spread_bits(uint64_t value) {
+            value &= 0x1fffff;
+            value = (value | value << 32) & 0x1f00000000ffff;
+            value = (value | value << 16) & 0x1f0000ff0000ff;
+            value = (value | value << 8) & 0x100f00f00f00f00f;
+            value = (value | value << 4) & 0x10c30c30c30c30c3;
+            value = (value | value << 2) & 0x1249249249249249;
+            return value;
+        }
+
+        static inline uint64_t morton_code(const uint32_t quantized[NUM_DIMS]) {
+            return (spread_bits(quantized[0]) << 2) | (spread_bits(quantized[1]) << 1) | spread_bits(quantized[2]);
+        }
+
+        //the first position in [begin, end) whose code is at least code
+        inline size_t find_code(uint64_t code, size_t begin, size_t end) const {
+            if(galloping) {
+                size_t step = 1;
+                size_t low = begin;
+                while(begin + step < end && codes[begin + step - 1] < code) {
+                    low = begin + step;
+                    step *= 2;
+                }
+                end = std::min(begin + step, end);
+                begin = low;
+            }
+            return std::lower_bound(codes.begin() + begin, codes.begin() + end, code) - codes.begin();
+        }
+
+        //a cell is its lower corner (quantized) and its side, as a power of two, and holds the points in [begin, end)
+        template <class OutputFunc, class ScanFunc>
+        void search_cell(const uint32_t query_lows[NUM_DIMS], const uint32_t query_highs[NUM_DIMS], const uint32_t cell_lows[NUM_DIMS],
+            int side_bits, size_t begin, size_t end, OutputFunc &output, ScanFunc &scan) const
+        {
+            uint32_t side = uint32_t(1) << side_bits;
+            bool interior = true;
+            for(int d = 0; d < NUM_DIMS; d++) {
+                uint32_t cell_high = cell_lows[d] + (side - 1);
+                if(cell_lows[d] > query_highs[d] || cell_high < query_lows[d]) {
+                    return;
+                }
+                interior &= cell_lows[d] > query_lows[d] && cell_high < query_highs[d];
+            }
+            if(interior) {
+                output(item_ids.data() + begin, end - begin);
+                return;
+            }
+            if(end - begin <= bucket_size || side_bits == 0) {
+                scan(begin, end);
+                return;
+            }
+            //the children are in morton order, each starting where the last one ended
+            uint64_t first_code = morton_code(cell_lows);
+            uint64_t child_span = uint64_t(1) << (NUM_DIMS * (side_bits - 1));
+            size_t child_begin = begin;
+            for(uint64_t child = 0; child < 8 && child_begin < end; child++) {
+                size_t child_end = (child == 7) ? end : find_code(first_code + (child+1) * child_span, child_begin, end);
+                if(child_end > child_begin) {
+                    uint32_t child_lows[NUM_DIMS];
+                    for(int d = 0; d < NUM_DIMS; d++) {
+                        child_lows[d] = cell_lows[d] + (((child >> (NUM_DIMS-1-d)) & 1) << (side_bits - 1));
+                    }
+                    search_cell(query_lows, query_highs, child_lows, side_bits - 1, child_begin, child_end, output, scan);
+                }
+                child_begin = child_end;
+            }
+        }
+
+        //calls output(const size_t *indices, size_t num_indices) once per interior cell or block of scanned matches
+        template <class OutputFunc>
+        void search(const bbox &query, OutputFunc output) const {
+            if(num_items == 0) {
+                return;
+            }
+            uint32_t query_lows[NUM_DIMS], query_highs[NUM_DIMS];
+            const double *item_coords[NUM_DIMS];
+            for(int d = 0; d < NUM_DIMS; d++) {
+                query_lows[d] = quantize(query.first[d], d);
+                query_highs[d] = quantize(query.second[d], d);
+                item_coords[d] = coords[d].data();
+            }
+            size_t block[SCAN_BLOCK_SIZE + TestBruteForceSIMD::BLOCK_PADDING];
+            auto scan = [&](size_t begin, size_t end) {
+                for(; begin < end; begin += SCAN_BLOCK_SIZE) {
+                    size_t block_end = std::min(begin + SCAN_BLOCK_SIZE, end);
+                    size_t num_matches = TestBruteForceSIMD::run_kernel(kernel, query, item_coords, item_coords, begin, block_end, block);
+                    for(size_t i = 0; i < num_matches; i++) {
+                        block[i] = item_ids[block[i]];
+                    }
+                    if(num_matches > 0) {
+                        output(block, num_matches);
+                    }
+                }
+            };
+            uint32_t root_lows[NUM_DIMS] = {0, 0, 0};
+            search_cell(query_lows, query_highs, root_lows, MORTON_BITS, 0, num_items, output, scan);
+        }
+
+    public:
+
+        //exact double precision comparisons
+        bool intersections_exact() { return true; }
+
+        //falls back to the scalar kernel if the cpu doesn't support the requested one
+        TestLinearOctree(size_t bucket_sz = NUM_ELEMS_PER_NODE, bool use_galloping = true, BruteForceKernel requested_kernel = AVX2_KERNEL) {
+            bucket_size = std::max(bucket_sz, size_t(1));
+            galloping = use_galloping;
+            kernel = requested_kernel;
+            if(!TestBruteForceSIMD::kernel_supported(kernel)) {
+                std::cerr << "error. this cpu doesn't support brute force kernel " << kernel << ". using the scalar kernel for the buckets instead" << std::endl;
+                kernel = SCALAR_KERNEL;
+            }
+        }
+        ~TestLinearOctree() {
+        }
+
+        void build_tree(const std::vector<point> &pts, const std::vector<size_t> &indices) {
+            num_items = pts.size();
+            double highs[NUM_DIMS];
+            for(int d = 0; d < NUM_DIMS; d++) {
+                lows[d] = DBL_MAX;
+                highs[d] = -DBL_MAX;
+            }
+            for(size_t i = 0; i < num_items; i++) {
+                for(int d = 0; d < NUM_DIMS; d++) {
+                    lows[d] = std::min(lows[d], pts[i][d]);
+                    highs[d] = std::max(highs[d], pts[i][d]);
+                }
+            }
+            for(int d = 0; d < NUM_DIMS; d++) {
+                scales[d] = (num_items > 0 && highs[d] > lows[d]) ? (MAX_QUANTIZED + 1.0) / (highs[d] - lows[d]) : 0;
+            }
+
+            std::vector<uint64_t> unsorted_codes(num_items);
+            for(size_t i = 0; i < num_items; i++) {
+                uint32_t quantized[NUM_DIMS];
+                for(int d = 0; d < NUM_DIMS; d++) {
+                    quantized[d] = quantize(pts[i][d], d);
+                }
+                unsorted_codes[i] = morton_code(quantized);
+            }
+            std::vector<size_t> order(num_items);
+            std::iota(order.begin(), order.end(), 0);
+            std::sort(order.begin(), order.end(), [&unsorted_codes](size_t a, size_t b) { return unsorted_codes[a] < unsorted_codes[b]; });
+
+            codes.resize(num_items);
+            item_ids.resize(num_items);
+            for(int d = 0; d < NUM_DIMS; d++) {
+                coords[d].resize(num_items);
+            }
+            for(size_t i = 0; i < num_items; i++) {
+                codes[i] = unsorted_codes[order[i]];
+                item_ids[i] = indices[order[i]];
+                for(int d = 0; d < NUM_DIMS; d++) {
+                    coords[d][i] = pts[order[i]][d];
+                }
+            }
+        }
+
+        void get_intersections(const bbox &my_bbox, std::vector<size_t> &intersections_indices) {
+            search(my_bbox, [&intersections_indices](const size_t *indices, size_t num_indices) {
+                intersections_indices.insert(intersections_indices.end(), indices, indices + num_indices);
+            });
+        }
+
+        bool visits_natively() { return true; }
+
+        //interior cells reach the sink as one range each
+        void visit_intersections(const bbox &my_bbox, ResultSink &sink) {
+            search(my_bbox, [&sink](const size_t *indices, size_t num_indices) {
+                sink.push_range(indices, num_indices);
+            });
+        }
+
+};
+
+#endif //LINEAR_OCTREE_HH
@@ -2,6 +2,8 @@
 #define NANOFLANN_TEST_HH
 
 #include <nanoflann.hpp>
+#include <type_traits>
+#include <algorithm>
 using namespace std;
 
 /** A simple vector-of-vectors adaptor for nanoflann, without duplicating the storage.
@@ -68,13 +70,14 @@ struct KDTreeVectorOfVectorsAdaptor
 }; // end of KDTreeVectorOfVectorsAdaptor
 
 
+template <class T = double>
 struct MyPointCloud
 {
 
-    std::vector<point>  pts;
+    std::vector<scalar_point<T>>  pts;
 
     MyPointCloud(const vector<point> &points) {
-        pts = points;
+        convert_points(points, pts);
     }
 
     // Must return the number of data points
@@ -83,7 +86,7 @@ struct MyPointCloud
     // Returns the dim'th component of the idx'th point in the class:
     // Since this is inlined and the "dim" argument is typically an immediate value, the
     //  "if/else's" are actually solved at compile time.
-    inline double kdtree_get_pt(const size_t idx, const size_t dim) const
+    inline T kdtree_get_pt(const size_t idx, const size_t dim) const
     {
         return pts[idx][dim];
     }
@@ -97,9 +100,10 @@ struct MyPointCloud
 };
 
 
-struct pair_iterator : std::vector<std::pair<size_t,double>>::const_iterator
+template <class T = double>
+struct pair_iterator : std::vector<std::pair<size_t,T>>::const_iterator
 {
-    using base_class = std::vector<std::pair<size_t,double>>::const_iterator;
+    using base_class = typename std::vector<std::pair<size_t,T>>::const_iterator;
     using value_type = size_t;
 
     using base_class::base_class;
@@ -112,16 +116,19 @@ struct pair_iterator : std::vector<std::pair<size_t,double>>::const_iterator
 
 
 
+template <class T = double>
 class TestNanoflann : public BboxIntersectionTest {
-    typedef std::vector<point> pt_vector;
-    typedef KDTreeVectorOfVectorsAdaptor< pt_vector, double>  my_kdtree;
-    typedef nanoflann::KDTreeSingleIndexAdaptor<nanoflann::L2_Adaptor<double, MyPointCloud>, MyPointCloud, NUM_DIMS> kdtree_duplicated_storage;
+    typedef std::vector<scalar_point<T>> pt_vector;
+    typedef KDTreeVectorOfVectorsAdaptor< pt_vector, T>  my_kdtree;
+    typedef nanoflann::KDTreeSingleIndexAdaptor<nanoflann::L2_Adaptor<T, MyPointCloud<T>>, MyPointCloud<T>, NUM_DIMS> kdtree_duplicated_storage;
 
     private:
 
-        my_kdtree *tree;
-        kdtree_duplicated_storage *tree_duplicated_storage;
-        MyPointCloud *cloud;
+        my_kdtree *tree = nullptr;
+        kdtree_duplicated_storage *tree_duplicated_storage = nullptr;
+        MyPointCloud<T> *cloud = nullptr;
+        //the adaptor references its input, so reduced precision coordinates have to outlive the tree
+        pt_vector converted_pts;
         bool use_duplicated_storage = false;
 
         void _build_tree(const std::vector<point> &pts, const std::vector<size_t> &indices, size_t bucket_size = NUM_ELEMS_PER_NODE, bool duplicate_storage = false)
@@ -129,16 +136,60 @@ class TestNanoflann : public BboxIntersectionTest {
             use_duplicated_storage = duplicate_storage;
             if(use_duplicated_storage) {
                 // MyPointCloud cloud(pts);
-                cloud = new MyPointCloud(pts);
+                cloud = new MyPointCloud<T>(pts);
                 tree_duplicated_storage = new kdtree_duplicated_storage(NUM_DIMS, *cloud, nanoflann::KDTreeSingleIndexAdaptorParams(bucket_size));
                 tree_duplicated_storage->buildIndex();
             }
             else {
-                tree = new my_kdtree(NUM_DIMS, pts, bucket_size);
+                tree = new my_kdtree(NUM_DIMS, as_scalar_points(pts, converted_pts), bucket_size);
                 tree->index->buildIndex();
             }
         }
 
+        //same interface as nanoflann's RadiusResultSet, but pushes each match into a sink
+        struct SinkResultSet {
+            T radius;
+            ResultSink &sink;
+            size_t count = 0;
+
+            SinkResultSet(T radius_, ResultSink &sink_) : radius(radius_), sink(sink_) {}
+
+            void init() {}
+            void clear() { count = 0; }
+            size_t size() const { return count; }
+            bool full() const { return true; }
+            T worstDist() const { return radius; }
+
+            template <class DistT, class IndexT>
+            bool addPoint(DistT dist, IndexT index) {
+                if(dist < radius) {
+                    sink.push(index);
+                    count++;
+                }
+                return true;
+            }
+        };
+
+        //returns the squared radius of the sphere around mid_pt that covers the query box
+        T get_query_sphere(const bbox &my_bbox, scalar_point<T> &mid_pt) {
+            T squared_radius_search_bound = 0;
+            if(std::is_same<T, double>::value) {
+                get_max_squared_radius(my_bbox, mid_pt, squared_radius_search_bound);
+            }
+            else {
+                //the midpoint gets rounded too, so measure to the farther face of the outward rounded box 
+                //and pad by a few ulps so the sphere still covers the whole query
+                scalar_bbox<T> query = round_bbox_outward<T>(my_bbox);
+                for(int i = 0; i < NUM_DIMS; i++) {
+                    mid_pt[i] = (query.first[i] + query.second[i]) / 2;
+                    T extent = std::max(mid_pt[i] - query.first[i], query.second[i] - mid_pt[i]);
+                    squared_radius_search_bound += extent * extent;
+                }
+                squared_radius_search_bound *= (1 + 8 * std::numeric_limits<T>::epsilon());
+            }
+            return squared_radius_search_bound + DEFAULT_TOLERANCE;
+        }
+
     public:
 
         bool intersections_exact() { return false; } //circular radius is not exact
@@ -170,12 +221,10 @@ class TestNanoflann : public BboxIntersectionTest {
             nanoflann::SearchParams params;
             params.sorted = false;
 
-            point mid_pt;
-            double squared_radius_search_bound = 0;
-            get_max_squared_radius(my_bbox, mid_pt, squared_radius_search_bound);
-            squared_radius_search_bound += DEFAULT_TOLERANCE;
+            scalar_point<T> mid_pt;
+            T squared_radius_search_bound = get_query_sphere(my_bbox, mid_pt);
 
-            std::vector<std::pair<size_t,double>>   ret_matches;
+            std::vector<std::pair<size_t,T>>   ret_matches;
             if(use_duplicated_storage) {
                 tree_duplicated_storage->radiusSearch(&mid_pt[0], squared_radius_search_bound, ret_matches, params);
             }
@@ -190,6 +239,23 @@ class TestNanoflann : public BboxIntersectionTest {
 
                  
         }
+
+        bool visits_natively() { return true; }
+
+        //uses a custom result set so matches go straight to the sink instead of into a vector of (index, distance) pairs
+        void visit_intersections(const bbox &my_bbox, ResultSink &sink) {
+            nanoflann::SearchParams params;
+            params.sorted = false;
+
+            scalar_point<T> mid_pt;
+            SinkResultSet result_set(get_query_sphere(my_bbox, mid_pt), sink);
+            if(use_duplicated_storage) {
+                tree_duplicated_storage->radiusSearchCustomCallback(&mid_pt[0], result_set, params);
+            }
+            else {
+                tree->index->radiusSearchCustomCallback(&mid_pt[0], result_set, params);
+            }
+        }
 };
 
 #endif //NANOFLANN_TEST_HH
@@ -0,0 +1,239 @@
+#ifndef NATIVE_KDTREE_HH
+#define NATIVE_KDTREE_HH
+
+#include <thread>
+#include <cfloat>
+#include <numeric>
+
+//an in-house static kd-tree, as a reference for what a tree without any library's baggage can do. it is pointerless: the nodes are a
+//complete binary tree in one array (node i's children are nodes 2i+1 and 2i+2), and every node's items are a contiguous range of the
+//items, which are permuted into leaf order and stored as structure-of-arrays. a node's range is its parent's, halved, so a node only
+//stores the bounding box of its items. a query skips the subtrees whose boxes it misses, takes the subtrees whose boxes it contains
+//without testing their items, and scans the leaves it partially overlaps with the brute force kernels.
+//bboxes are split by their centers, and a node's box covers all of its items' boxes
+class TestNativeKdtree : public BboxIntersectionTest {
+
+    private:
+        struct node_bounds {
+            double mins[NUM_DIMS];
+            double maxs[NUM_DIMS];
+        };
+
+        //the leaves are scanned in blocks of at most this many items, so the scan's buffer can live on the stack
+        static const size_t LEAF_SCAN_BLOCK_SIZE = 256;
+        //deeper than any tree whose item ranges fit in a size_t
+        static const size_t MAX_DEPTH = 64;
+
+        size_t leaf_size;
+        size_t num_build_threads;
+        BruteForceKernel kernel;
+        bool uses_boxes = false;
+        size_t num_items = 0;
+        //the leaves are the nodes at this depth
+        size_t depth = 0;
+        std::vector<node_bounds> nodes;
+        //the index of each item (in leaf order) that is returned for it
+        std::vector<size_t> item_ids;
+        //points: mins holds x, y, z. boxes: mins holds the lower corners' x, y, z, and maxs holds the upper corners'
+        std::vector<double> mins[NUM_DIMS];
+        std::vector<double> maxs[NUM_DIMS];
+
+        //the splits only compare centers, so the bboxes' centers aren't halved
+        inline double get_center(const std::vector<point> &pts, size_t position, int dim) const {
+            return uses_boxes ? pts[2*position][dim] + pts[2*position+1][dim] : pts[position][dim];
+        }
+
+        //order holds the positions (in pts) of the items, and is partitioned in place. the top levels' subtrees are built by their own threads
+        void build_node(const std::vector<point> &pts, std::vector<size_t> &order, size_t node, size_t begin, size_t end, size_t level, size_t num_threads) {
+            node_bounds &bounds = nodes[node];
+            for(int d = 0; d < NUM_DIMS; d++) {
+                bounds.mins[d] = DBL_MAX;
+                bounds.maxs[d] = -DBL_MAX;
+            }
+            size_t pts_per_item = uses_boxes ? 2 : 1;
+            for(size_t i = begin; i < end; i++) {
+                for(int d = 0; d < NUM_DIMS; d++) {
+                    bounds.mins[d] = std::min(bounds.mins[d], pts[pts_per_item*order[i]][d]);
+                    bounds.maxs[d] = std::max(bounds.maxs[d], pts[pts_per_item*order[i] + pts_per_item-1][d]);
+                }
+            }
+            //nodes with fewer than 2 items still get split, so that the search's ranges always match the nodes' boxes
+            if(level == depth) {
+                return;
+            }
+
+            int split_dim = 0;
+            for(int d = 1; d < NUM_DIMS; d++) {
+                if(bounds.maxs[d] - bounds.mins[d] > bounds.maxs[split_dim] - bounds.mins[split_dim]) {
+                    split_dim = d;
+                }
+            }
+            size_t mid = begin + (end - begin)/2;
+            std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end, [&](size_t a, size_t b) {
+                return get_center(pts, a, split_dim) < get_center(pts, b, split_dim);
+            });
+
+            if(num_threads > 1) {
+                std::thread left_thread(&TestNativeKdtree::build_node, this, std::cref(pts), std::ref(order), 2*node+1, begin, mid, level+1, num_threads/2);
+                build_node(pts, order, 2*node+2, mid, end, level+1, num_threads - num_threads/2);
+                left_thread.join();
+            }
+            else {
+                build_node(pts, order, 2*node+1, begin, mid, level+1, 1);
+                build_node(pts, order, 2*node+2, mid, end, level+1, 1);
+            }
+        }
+
+        void build(const std::vector<point> &pts, const std::vector<size_t> &indices) {
+            size_t pts_per_item = uses_boxes ? 2 : 1;
+            num_items = pts.size() / pts_per_item;
+            depth = 0;
+            while((num_items + (size_t(1) << depth) - 1) >> depth > leaf_size) {
+                depth++;
+            }
+            //every node gets its box from build_node. nodes that get no items (only possible for tiny leaf sizes) get an empty box, which no query overlaps
+            nodes.resize((size_t(2) << depth) - 1);
+
+            std::vector<size_t> order(num_items);
+            std::iota(order.begin(), order.end(), 0);
+            if(num_items > 0) {
+                build_node(pts, order, 0, 0, num_items, 0, num_build_threads);
+            }
+
+            item_ids.resize(num_items);
+            for(int d = 0; d < NUM_DIMS; d++) {
+                mins[d].resize(num_items);
+                if(uses_boxes) {
+                    maxs[d].resize(num_items);
+                }
+            }
+            for(size_t i = 0; i < num_items; i++) {
+                item_ids[i] = indices[order[i]];
+                for(int d = 0; d < NUM_DIMS; d++) {
+                    mins[d][i] = pts[pts_per_item*order[i]][d];
+                    if(uses_boxes) {
+                        maxs[d][i] = pts[2*order[i]+1][d];
+                    }
+                }
+            }
+        }
+
+        static inline bool overlaps(const bbox &query, const node_bounds &bounds) {
+            return(
+                   query.first[0] <= bounds.maxs[0] && bounds.mins[0] <= query.second[0]
+                && query.first[1] <= bounds.maxs[1] && bounds.mins[1] <= query.second[1]
+                && query.first[2] <= bounds.maxs[2] && bounds.mins[2] <= query.second[2]
+            );
+        }
+
+        static inline bool contains(const bbox &query, const node_bounds &bounds) {
+            return(
+                   query.first[0] <= bounds.mins[0] && bounds.maxs[0] <= query.second[0]
+                && query.first[1] <= bounds.mins[1] && bounds.maxs[1] <= query.second[1]
+                && query.first[2] <= bounds.mins[2] && bounds.maxs[2] <= query.second[2]
+            );
+        }
+
+        //calls output(const size_t *indices, size_t num_indices) once per contained subtree or block of a leaf's matches
+        template <class OutputFunc>
+        void search(const bbox &query, OutputFunc output) const {
+            if(num_items == 0) {
+                return;
+            }
+            const double *item_mins[NUM_DIMS];
+            const double *item_maxs[NUM_DIMS];
+            for(int d = 0; d < NUM_DIMS; d++) {
+                item_mins[d] = mins[d].data();
+                item_maxs[d] = uses_boxes ? maxs[d].data() : mins[d].data();
+            }
+
+            struct stack_entry {
+                size_t node;
+                size_t begin;
+                size_t end;
+                size_t level;
+            };
+            //depth first, so there is at most one pending sibling per level
+            stack_entry stack[MAX_DEPTH + 1];
+            size_t stack_size = 0;
+            stack[stack_size++] = stack_entry{0, 0, num_items, 0};
+            size_t block[LEAF_SCAN_BLOCK_SIZE + TestBruteForceSIMD::BLOCK_PADDING];
+
+            while(stack_size > 0) {
+                stack_entry entry = stack[--stack_size];
+                const node_bounds &bounds = nodes[entry.node];
+                if(!overlaps(query, bounds)) {
+                    continue;
+                }
+                if(contains(query, bounds)) {
+                    output(item_ids.data() + entry.begin, entry.end - entry.begin);
+                }
+                else if(entry.level == depth) {
+                    for(size_t begin = entry.begin; begin < entry.end; begin += LEAF_SCAN_BLOCK_SIZE) {
+                        size_t end = std::min(begin + LEAF_SCAN_BLOCK_SIZE, entry.end);
+                        size_t num_matches = TestBruteForceSIMD::run_kernel(kernel, query, item_mins, item_maxs, begin, end, block);
+                        for(size_t i = 0; i < num_matches; i++) {
+                            block[i] = item_ids[block[i]];
+                        }
+                        if(num_matches > 0) {
+                            output(block, num_matches);
+                        }
+                    }
+                }
+                else {
+                    size_t mid = entry.begin + (entry.end - entry.begin)/2;
+                    stack[stack_size++] = stack_entry{2*entry.node+2, mid, entry.end, entry.level+1};
+                    stack[stack_size++] = stack_entry{2*entry.node+1, entry.begin, mid, entry.level+1};
+                }
+            }
+        }
+
+    public:
+
+        //exact double precision comparisons
+        bool intersections_exact() { return true; }
+
+        //num_build_threads of 0 uses every hardware thread. falls back to the scalar leaf kernel if the cpu doesn't support the requested one
+        TestNativeKdtree(size_t leaf_sz = NUM_ELEMS_PER_NODE, BruteForceKernel requested_kernel = AVX2_KERNEL, size_t num_threads = 0) {
+            leaf_size = std::max(leaf_sz, size_t(1));
+            num_build_threads = (num_threads == 0) ? std::max(std::thread::hardware_concurrency(), 1u) : num_threads;
+            kernel = requested_kernel;
+            if(!TestBruteForceSIMD::kernel_supported(kernel)) {
+                std::cerr << "error. this cpu doesn't support brute force kernel " << kernel << ". using the scalar kernel for the leaves instead" << std::endl;
+                kernel = SCALAR_KERNEL;
+            }
+        }
+        ~TestNativeKdtree() {
+        }
+
+        void build_tree(const std::vector<point> &pts, const std::vector<size_t> &indices) {
+            uses_boxes = false;
+            build(pts, indices);
+        }
+
+        void build_tree_bbox(const std::vector<point> &pts, const std::vector<size_t> &indices) {
+            if((pts.size() % 2) !=0) {
+                std::cerr << "error. your point list size has to be even to insert bounding boxes" << std::endl;
+                return;
+            }
+            uses_boxes = true;
+            build(pts, indices);
+        }
+
+        void get_intersections(const bbox &my_bbox, std::vector<size_t> &intersections_indices) {
+            search(my_bbox, [&intersections_indices](const size_t *indices, size_t num_indices) {
+                intersections_indices.insert(intersections_indices.end(), indices, indices + num_indices);
+            });
+        }
+
+        bool visits_natively() { return true; }
+
+        void visit_intersections(const bbox &my_bbox, ResultSink &sink) {
+            search(my_bbox, [&sink](const size_t *indices, size_t num_indices) {
+                sink.push_range(indices, num_indices);
+            });
+        }
+
+};
+
+#endif //NATIVE_KDTREE_HH
@@ -0,0 +1,332 @@
+#ifndef NATIVE_RTREE_HH
+#define NATIVE_RTREE_HH
+
+#include <cfloat>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <type_traits>
+
+enum PackingOrder : unsigned short {
+    STR_PACKING,
+    HILBERT_PACKING
+};
+
+//an in-house static packed r-tree. the items are sorted once (sort-tile-recursive or hilbert order), then packed fan_out at a time into
+//the leaves, and each level above packs fan_out consecutive nodes of the level below, so node k's children are nodes k*fan_out to
+//k*fan_out + fan_out-1 and every subtree's items are a contiguous range. there are no pointers: each level is one array, holding each
+//node's child bounds as structure-of-arrays (min x of all fan_out children, then min y, ..., then max z), padded with empty boxes, so
+//one node's children are tested with fixed length loops. a query takes the children its box contains without looking inside them.
+//the bounds can be stored as floats, rounded outwards, in which case the leaves' candidates are refined against the double precision items
+template <typename CoordType = double>
+class TestNativeRtree : public BboxIntersectionTest {
+
+    private:
+        //hilbert order uses this many bits of each center coordinate
+        static const int HILBERT_BITS = 21;
+        //bounds the per node scratch arrays of the search
+        static const size_t MAX_FAN_OUT = 64;
+
+        size_t fan_out;
+        PackingOrder packing;
+        size_t num_items = 0;
+        //level 0 holds the leaves, whose children are the items. the last level is the root
+        std::vector<std::vector<CoordType>> level_bounds;
+        std::vector<size_t> level_sizes;
+        //how many items a node of each level covers (fan_out to the power of level+1), saturated
+        std::vector<size_t> level_spans;
+        //the index of each item (in packed order) that is returned for it
+        std::vector<size_t> item_ids;
+        //only kept for float bounds, to refine the leaves' candidates
+        std::vector<double> item_mins[NUM_DIMS];
+        std::vector<double> item_maxs[NUM_DIMS];
+
+        static inline bool exact_bounds() { return std::is_same<CoordType, double>::value; }
+
+        static inline CoordType round_down(double value) {
+            CoordType rounded = static_cast<CoordType>(value);
+            if(static_cast<double>(rounded) > value) {
+                rounded = std::nextafter(rounded, -std::numeric_limits<CoordType>::infinity());
+            }
+            return rounded;
+        }
+
+        static inline CoordType round_up(double value) {
+            CoordType rounded = static_cast<CoordType>(value);
+            if(static_cast<double>(rounded) < value) {
+                rounded = std::nextafter(rounded, std::numeric_limits<CoordType>::infinity());
+            }
+            return rounded;
+        }
+
+        //skilling's transpose of the axes into the hilbert curve, then the bits are interleaved into one index
+        static uint64_t hilbert_index(uint32_t coords[NUM_DIMS]) {
+            for(uint32_t q = uint32_t(1) << (HILBERT_BITS-1); q > 1; q >>= 1) {
+                uint32_t p = q - 1;
+                for(int i = 0; i < NUM_DIMS; i++) {
+                    if(coords[i] & q) {
+                        coords[0] ^= p;
+                    }
+                    else {
+                        uint32_t t = (coords[0] ^ coords[i]) & p;
+                        coords[0] ^= t;
+                        coords[i] ^= t;
+                    }
+                }
+            }
+            for(int i = 1; i < NUM_DIMS; i++) {
+                coords[i] ^= coords[i-1];
+            }
+            uint32_t t = 0;
+            for(uint32_t q = uint32_t(1) << (HILBERT_BITS-1); q > 1; q >>= 1) {
+                if(coords[NUM_DIMS-1] & q) {
+                    t ^= q - 1;
+                }
+            }
+            uint64_t index = 0;
+            for(int bit = HILBERT_BITS-1; bit >= 0; bit--) {
+                for(int i = 0; i < NUM_DIMS; i++) {
+                    index = (index << 1) | (((coords[i] ^ t) >> bit) & 1);
+                }
+            }
+            return index;
+        }
+
+        //centers are doubled (mins + maxs), which doesn't change the order
+        void hilbert_sort(const std::vector<double> (&centers)[NUM_DIMS], std::vector<size_t> &order) const {
+            double lows[NUM_DIMS], scales[NUM_DIMS];
+            for(int d = 0; d < NUM_DIMS; d++) {
+                auto range = std::minmax_element(centers[d].begin(), centers[d].end());
+                lows[d] = *range.first;
+                double extent = *range.second - *range.first;
+                scales[d] = extent > 0 ? ((uint32_t(1) << HILBERT_BITS) - 1) / extent : 0;
+            }
+            std::vector<uint64_t> keys(num_items);
+            for(size_t i = 0; i < num_items; i++) {
+                uint32_t coords[NUM_DIMS];
+                for(int d = 0; d < NUM_DIMS; d++) {
+                    coords[d] = static_cast<uint32_t>((centers[d][i] - lows[d]) * scales[d]);
+                }
+                keys[i] = hilbert_index(coords);
+            }
+            std::sort(order.begin(), order.end(), [&keys](size_t a, size_t b) { return keys[a] < keys[b]; });
+        }
+
+        //sort-tile-recursive: slabs along x, each cut into strips along y, each sorted along z. a slab (or strip) holds a whole number of leaves
+        void str_sort(const std::vector<double> (&centers)[NUM_DIMS], std::vector<size_t>::iterator begin, std::vector<size_t>::iterator end, int dim) const {
+            auto by_dim = [&centers, dim](size_t a, size_t b) { return centers[dim][a] < centers[dim][b]; };
+            std::sort(begin, end, by_dim);
+            if(dim == NUM_DIMS-1) {
+                return;
+            }
+            size_t num_leaves = (size_t(end - begin) + fan_out - 1) / fan_out;
+            size_t num_slices = static_cast<size_t>(std::ceil(std::pow(double(num_leaves), 1.0 / (NUM_DIMS - dim))));
+            size_t slice_size = ((num_leaves + num_slices - 1) / num_slices) * fan_out;
+            for(auto slice_begin = begin; slice_begin < end; slice_begin += std::min(slice_size, size_t(end - slice_begin))) {
+                str_sort(centers, slice_begin, slice_begin + std::min(slice_size, size_t(end - slice_begin)), dim+1);
+            }
+        }
+
+        //allocates a level with every child's box empty, so padding children never overlap a query. above the leaves, each child's box is
+        //the union of its own children's boxes
+        void pack_level(size_t level) {
+            size_t num_nodes = level_sizes[level];
+            std::vector<CoordType> &bounds = level_bounds[level];
+            bounds.resize(num_nodes * 2*NUM_DIMS * fan_out);
+            for(size_t node = 0; node < num_nodes; node++) {
+                CoordType *node_bounds = &bounds[node * 2*NUM_DIMS * fan_out];
+                std::fill(node_bounds, node_bounds + NUM_DIMS*fan_out, std::numeric_limits<CoordType>::infinity());
+                std::fill(node_bounds + NUM_DIMS*fan_out, node_bounds + 2*NUM_DIMS*fan_out, -std::numeric_limits<CoordType>::infinity());
+                if(level == 0) {
+                    continue;
+                }
+                for(size_t child = node*fan_out; child < std::min((node+1)*fan_out, level_sizes[level-1]); child++) {
+                    size_t c = child - node*fan_out;
+                    const CoordType *child_bounds = &level_bounds[level-1][child * 2*NUM_DIMS * fan_out];
+                    for(int d = 0; d < NUM_DIMS; d++) {
+                        for(size_t grandchild = 0; grandchild < fan_out; grandchild++) {
+                            node_bounds[d*fan_out + c] = std::min(node_bounds[d*fan_out + c], child_bounds[d*fan_out + grandchild]);
+                            node_bounds[(NUM_DIMS+d)*fan_out + c] = std::max(node_bounds[(NUM_DIMS+d)*fan_out + c], child_bounds[(NUM_DIMS+d)*fan_out + grandchild]);
+                        }
+                    }
+                }
+            }
+        }
+
+        void build(const std::vector<point> &pts, const std::vector<size_t> &indices, size_t pts_per_item) {
+            num_items = pts.size() / pts_per_item;
+            std::vector<double> centers[NUM_DIMS];
+            for(int d = 0; d < NUM_DIMS; d++) {
+                centers[d].resize(num_items);
+                for(size_t i = 0; i < num_items; i++) {
+                    centers[d][i] = pts[pts_per_item*i][d] + pts[pts_per_item*i + pts_per_item-1][d];
+                }
+            }
+            std::vector<size_t> order(num_items);
+            std::iota(order.begin(), order.end(), 0);
+            if(packing == HILBERT_PACKING) {
+                hilbert_sort(centers, order);
+            }
+            else {
+                str_sort(centers, order.begin(), order.end(), 0);
+            }
+
+            item_ids.resize(num_items);
+            for(size_t i = 0; i < num_items; i++) {
+                item_ids[i] = indices[order[i]];
+            }
+            for(int d = 0; d < NUM_DIMS; d++) {
+                item_mins[d].clear();
+                item_maxs[d].clear();
+                if(!exact_bounds()) {
+                    item_mins[d].resize(num_items);
+                    item_maxs[d].resize(num_items);
+                    for(size_t i = 0; i < num_items; i++) {
+                        item_mins[d][i] = pts[pts_per_item*order[i]][d];
+                        item_maxs[d][i] = pts[pts_per_item*order[i] + pts_per_item-1][d];
+                    }
+                }
+            }
+
+            level_sizes.clear();
+            level_spans.clear();
+            size_t level_size = std::max((num_items + fan_out - 1) / fan_out, size_t(1));
+            size_t span = fan_out;
+            while(true) {
+                level_sizes.push_back(level_size);
+                level_spans.push_back(span);
+                if(level_size == 1) {
+                    break;
+                }
+                level_size = (level_size + fan_out - 1) / fan_out;
+                span = (span > SIZE_MAX / fan_out) ? SIZE_MAX : span * fan_out;
+            }
+            level_bounds.assign(level_sizes.size(), std::vector<CoordType>());
+
+            //the leaves' child bounds are the items' bounds
+            pack_level(0);
+            std::vector<CoordType> &leaf_bounds = level_bounds[0];
+            for(size_t i = 0; i < num_items; i++) {
+                CoordType *node_bounds = &leaf_bounds[(i / fan_out) * 2*NUM_DIMS * fan_out];
+                size_t c = i % fan_out;
+                for(int d = 0; d < NUM_DIMS; d++) {
+                    node_bounds[d*fan_out + c] = round_down(pts[pts_per_item*order[i]][d]);
+                    node_bounds[(NUM_DIMS+d)*fan_out + c] = round_up(pts[pts_per_item*order[i] + pts_per_item-1][d]);
+                }
+            }
+            for(size_t level = 1; level < level_sizes.size(); level++) {
+                pack_level(level);
+            }
+        }
+
+        inline bool item_intersects(const bbox &query, size_t item) const {
+            return(
+                   query.first[0] <= item_maxs[0][item] && item_mins[0][item] <= query.second[0]
+                && query.first[1] <= item_maxs[1][item] && item_mins[1][item] <= query.second[1]
+                && query.first[2] <= item_maxs[2][item] && item_mins[2][item] <= query.second[2]
+            );
+        }
+
+        //calls output(const size_t *indices, size_t num_indices) once per contained subtree or leaf's matches.
+        //children are compared in double precision, so float bounds (rounded outwards) only ever overlap more and contain less
+        template <class OutputFunc>
+        void search(const bbox &query, size_t level, size_t node, OutputFunc &output) const {
+            const CoordType *node_bounds = &level_bounds[level][node * 2*NUM_DIMS * fan_out];
+            bool overlapping[MAX_FAN_OUT];
+            bool contained[MAX_FAN_OUT];
+            for(size_t c = 0; c < fan_out; c++) {
+                bool overlaps = true;
+                bool contains = true;
+                for(int d = 0; d < NUM_DIMS; d++) {
+                    double child_min = node_bounds[d*fan_out + c];
+                    double child_max = node_bounds[(NUM_DIMS+d)*fan_out + c];
+                    overlaps &= (query.first[d] <= child_max) & (child_min <= query.second[d]);
+                    contains &= (query.first[d] <= child_min) & (child_max <= query.second[d]);
+                }
+                overlapping[c] = overlaps;
+                contained[c] = contains;
+            }
+
+            size_t first_child = node * fan_out;
+            if(level == 0) {
+                size_t leaf_matches[MAX_FAN_OUT];
+                size_t num_matches = 0;
+                for(size_t c = 0; c < fan_out; c++) {
+                    if(overlapping[c] && (exact_bounds() || contained[c] || item_intersects(query, first_child + c))) {
+                        leaf_matches[num_matches++] = item_ids[first_child + c];
+                    }
+                }
+                if(num_matches > 0) {
+                    output(leaf_matches, num_matches);
+                }
+                return;
+            }
+            for(size_t c = 0; c < fan_out; c++) {
+                if(!overlapping[c]) {
+                    continue;
+                }
+                if(contained[c]) {
+                    size_t items_begin = (first_child + c) * level_spans[level-1];
+                    size_t items_end = std::min(items_begin + level_spans[level-1], num_items);
+                    output(item_ids.data() + items_begin, items_end - items_begin);
+                }
+                else {
+                    search(query, level-1, first_child + c, output);
+                }
+            }
+        }
+
+        template <class OutputFunc>
+        void search(const bbox &query, OutputFunc output) const {
+            if(num_items == 0) {
+                return;
+            }
+            search(query, level_sizes.size()-1, 0, output);
+        }
+
+    public:
+
+        //exact double precision comparisons, even with float bounds
+        bool intersections_exact() { return true; }
+
+        TestNativeRtree(size_t num_children = NUM_ELEMS_PER_NODE, PackingOrder packing_order = STR_PACKING) {
+            fan_out = std::max(num_children, size_t(2));
+            if(fan_out > MAX_FAN_OUT) {
+                std::cerr << "error. the native rtree's fan out can be at most " << MAX_FAN_OUT << ". using " << MAX_FAN_OUT << " instead of " << fan_out << std::endl;
+                fan_out = MAX_FAN_OUT;
+            }
+            packing = packing_order;
+        }
+        ~TestNativeRtree() {
+        }
+
+        //points are stored as boxes with no extent
+        void build_tree(const std::vector<point> &pts, const std::vector<size_t> &indices) {
+            build(pts, indices, 1);
+        }
+
+        void build_tree_bbox(const std::vector<point> &pts, const std::vector<size_t> &indices) {
+            if((pts.size() % 2) !=0) {
+                std::cerr << "error. your point list size has to be even to insert bounding boxes" << std::endl;
+                return;
+            }
+            build(pts, indices, 2);
+        }
+
+        void get_intersections(const bbox &my_bbox, std::vector<size_t> &intersections_indices) {
+            search(my_bbox, [&intersections_indices](const size_t *indices, size_t num_indices) {
+                intersections_indices.insert(intersections_indices.end(), indices, indices + num_indices);
+            });
+        }
+
+        bool visits_natively() { return true; }
+
+        void visit_intersections(const bbox &my_bbox, ResultSink &sink) {
+            search(my_bbox, [&sink](const size_t *indices, size_t num_indices) {
+                sink.push_range(indices, num_indices);
+            });
+        }
+
+};
+
+#endif //NATIVE_RTREE_HH
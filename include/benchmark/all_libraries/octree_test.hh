@@ -36,7 +36,7 @@ class TestOctree : public BboxIntersectionTest {
 
     private:
 
-        unibn::Octree<point> *tree;
+        unibn::Octree<point> *tree = nullptr;
 
         void _build_tree(const std::vector<point> &pts, const std::vector<size_t> &indices, size_t bucket_size = NUM_ELEMS_PER_NODE)
         {
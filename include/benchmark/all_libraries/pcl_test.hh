@@ -26,7 +26,7 @@ namespace TestPCL {
 
         class Octree : public BboxIntersectionTest {
             private:
-                pcl::octree::OctreePointCloudSearch<pcl::PointXYZ> *tree;
+                pcl::octree::OctreePointCloudSearch<pcl::PointXYZ> *tree = nullptr;
                 pcl::PointCloud<pcl::PointXYZ>::Ptr cloud;
 
             public: 
@@ -34,8 +34,10 @@ namespace TestPCL {
 
                 Octree() {}
                 ~Octree() {
-                    cloud->points.clear ();
-                    tree->deleteTree();
+                    if(tree != nullptr) {
+                        cloud->points.clear ();
+                        tree->deleteTree();
+                    }
                     delete tree;
                     // delete cloud;
                 }
@@ -49,6 +51,7 @@ namespace TestPCL {
                     //indicates there will be no infinite or NaN values
                     cloud->is_dense = true;
 
+                    cloud->reserve(pts.size() + 1);
                     for(const point &pt : pts) {
                         cloud->push_back(pcl::PointXYZ(pt[0],pt[1],pt[2]));
                     }
@@ -106,7 +109,7 @@ namespace TestPCL {
         //is just a thin wrapper around FLANN. no reason to think it'll be better
         class KDTree : public BboxIntersectionTest {
             private:
-                pcl::KdTreeFLANN<pcl::PointXYZ> *tree;
+                pcl::KdTreeFLANN<pcl::PointXYZ> *tree = nullptr;
 
             public: 
                 bool intersections_exact() { return false ;} //circular radius with tolerance is not exact
@@ -155,12 +158,13 @@ namespace TestPCL {
     #ifdef USE_GPU
         class OctreeGPU : public BboxIntersectionTest {
             private:
-                pcl::octree::OctreePointCloudSearch<pcl::PointXYZ> *tree;
-                pcl::gpu::Octree *octree_device;
+                pcl::octree::OctreePointCloudSearch<pcl::PointXYZ> *tree = nullptr;
+                pcl::gpu::Octree *octree_device = nullptr;
                 size_t tree_size;
 
             public: 
                 bool intersections_exact() { return false ;} //circular radius with tolerance is not exact
+                bool concurrent_queries_safe() { return false; } //queries are uploaded to and run on a single device
 
                 OctreeGPU() {}
                 ~OctreeGPU() {
@@ -280,6 +284,46 @@ namespace TestPCL {
                     get_intersections(my_bbox, intersections_indices, num_sub_queries, x_queries, y_queries, z_queries);
                 }
 
+                //uploads the whole batch (each with its own radius) and runs it as one device search. 
+                //the output buffer is dense (max_answers per query), so large batches are split up
+                void get_intersections_batch(const bbox *queries, size_t num_queries, batch_results &results) {
+                    //every point could conceivably match
+                    const int max_answers = tree_size;
+                    size_t max_queries_per_search = max_dense_batch_size(tree_size);
+
+                    for(size_t first_query = 0; first_query < num_queries; first_query += max_queries_per_search) {
+                        size_t num_sub_queries = std::min(max_queries_per_search, num_queries - first_query);
+                        std::vector<pcl::PointXYZ> query_host(num_sub_queries);
+                        std::vector<float> radius(num_sub_queries);
+                        for(size_t i = 0; i < num_sub_queries; i++) {
+                            point mid_pt;
+                            double radius_search_bound = 0;
+                            //uses radius not squared radius
+                            get_max_radius(queries[first_query+i], mid_pt, radius_search_bound);
+                            query_host[i] = pcl::PointXYZ(mid_pt[0], mid_pt[1], mid_pt[2]);
+                            radius[i] = radius_search_bound + DEFAULT_TOLERANCE;
+                        }
+                        pcl::gpu::Octree::Queries queries_device;
+                        queries_device.upload(query_host);
+                        pcl::gpu::Octree::Radiuses radiuses_device;
+                        radiuses_device.upload(radius);
+
+                        // Output buffer on the device
+                        pcl::gpu::NeighborIndices result_device(queries_device.size(), max_answers);
+                        octree_device->radiusSearch(queries_device, radiuses_device, max_answers, result_device);
+
+                        std::vector<int> sizes, data;
+                        result_device.sizes.download(sizes);
+                        result_device.data.download(data);
+                        for (std::size_t i = 0; i < sizes.size (); ++i) {
+                            for (std::size_t j = 0; j < sizes[i]; ++j) {
+                                results.indices.push_back(data[j+ i * max_answers]);
+                            }
+                            results.offsets.push_back(results.indices.size());
+                        }
+                    }
+                }
+
         };
     #endif
 }
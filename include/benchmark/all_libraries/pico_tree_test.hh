@@ -3,37 +3,44 @@
 
 #include <pico_tree/kd_tree.hpp>
 #include <pico_adaptor.hpp>
+#include <type_traits>
 
 using namespace std;
 
 
 
+template <class T = double>
 class TestPicoTree : public BboxIntersectionTest {
 
     class PicoPoint {
         private:
-            point my_pt;
+            scalar_point<T> my_pt;
         public:
-            using ScalarType = double;
+            using ScalarType = T;
             static constexpr int Dim = NUM_DIMS;
 
-            PicoPoint(const point &pt) {
-                my_pt = pt;
+            //takes double precision data points or already rounded query corners
+            template <class U>
+            PicoPoint(const scalar_point<U> &pt) {
+                for(int i = 0; i < NUM_DIMS; i++) {
+                    my_pt[i] = (T)pt[i];
+                }
             }
 
-            inline double const& operator()(int const i) const { return my_pt[i]; }
-            inline double& operator()(int const i) { return my_pt[i]; }
+            inline T const& operator()(int const i) const { return my_pt[i]; }
+            inline T& operator()(int const i) { return my_pt[i]; }
 
     };
 
-    typedef pico_tree::KdTree<size_t, double, NUM_DIMS, PicoAdaptor<size_t, PicoPoint>> kdtree;
+    typedef pico_tree::KdTree<size_t, T, NUM_DIMS, PicoAdaptor<size_t, PicoPoint>> kdtree;
 
     private:
-        kdtree *tree;
+        kdtree *tree = nullptr;
         //have to keep this in scope
         vector<PicoPoint> pico_pts;
 
         void _build_tree(const std::vector<point> &pts, const std::vector<size_t> &indices, size_t bucket_size) {
+            pico_pts.reserve(pts.size());
             for(int i = 0; i < pts.size(); i++) {
                 pico_pts.push_back(PicoPoint(pts[i]));
             }
@@ -42,7 +49,8 @@ class TestPicoTree : public BboxIntersectionTest {
         }
     public:
 
-        bool intersections_exact() { return true; } //bounding box search
+        //bounding box search, but single precision coordinates only give a superset of the results
+        bool intersections_exact() { return std::is_same<T, double>::value; }
 
         TestPicoTree() {}
         ~TestPicoTree() {
@@ -60,7 +68,8 @@ class TestPicoTree : public BboxIntersectionTest {
 
         //closed region -> includes Points that fall on the boundary
         void get_intersections(const bbox &my_bbox, std::vector<size_t> &intersections_indices) {
-            tree->SearchBox(PicoPoint(my_bbox.first), PicoPoint(my_bbox.second), &intersections_indices);
+            scalar_bbox<T> query = round_bbox_outward<T>(my_bbox);
+            tree->SearchBox(PicoPoint(query.first), PicoPoint(query.second), &intersections_indices);
         }
 
 };
@@ -13,7 +13,7 @@ namespace TestRtreeTemplate {
         //index data type, element data type, num dims, element data type, max nodes, min nodes
         typedef RTree<size_t, double, NUM_DIMS, double, bucket_size, (const int)(bucket_size*.3)> rtree;
         private:
-            rtree *tree;
+            rtree *tree = nullptr;
 
         public:
 
@@ -21,7 +21,7 @@ namespace TestRtreeTemplate {
 
             Points() {}
             ~Points() {
-                free(tree);
+                delete tree;
             }
 
             void build_tree(const std::vector<point> &pts, const std::vector<size_t> &indices) {
@@ -43,7 +43,7 @@ namespace TestRtreeTemplate {
         //index data type, element data type, num dims, element data type, max nodes, min nodes
         typedef RTree<size_t, double, NUM_DIMS, double, bucket_size, (const int)(bucket_size*.3)> rtree;
         private:
-            rtree *tree;
+            rtree *tree = nullptr;
 
         public:
 
@@ -51,7 +51,7 @@ namespace TestRtreeTemplate {
 
             Bboxes() {}
             ~Bboxes() {
-                free(tree);
+                delete tree;
             }
 
             void build_tree(const std::vector<point> &pts, const std::vector<size_t> &indices) {
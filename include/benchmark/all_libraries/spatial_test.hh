@@ -36,6 +36,7 @@ namespace TestSpatial {
 
             void build_tree(const std::vector<point> &pts, const std::vector<size_t> &indices) {
                 vector<point_w_index> pts_w_index;
+                pts_w_index.reserve(pts.size());
                 for(int i = 0; i < pts.size(); i++) {
                     pts_w_index.push_back(point_w_index(pts[i],indices[i]));
                 }
@@ -51,26 +52,40 @@ namespace TestSpatial {
             }
 
             //closed region -> includes points that fall on the boundary
-            void get_intersections(const bbox &my_bbox, std::vector<size_t> &intersections_indices) {
+            template <class OutputFunc>
+            void _get_intersections(const bbox &my_bbox, OutputFunc output) {
                 typedef spatial::closed_region_iterator<kdtree> iterator;
                 typedef spatial::closed_region_iterator<kdtree_self_balancing> iterator_balanced;
 
                 if(self_balancing) {
                     for (iterator_balanced i = spatial::closed_region_begin(*tree_self_balancing, my_bbox.first, my_bbox.second); i != spatial::closed_region_end(*tree_self_balancing, my_bbox.first, my_bbox.second); ++i) {
-                        intersections_indices.push_back((*i).second);
+                        output((*i).second);
                     }
                 }
                 else {
                     for (iterator i = spatial::closed_region_begin(*tree, my_bbox.first, my_bbox.second); i != spatial::closed_region_end(*tree, my_bbox.first, my_bbox.second); ++i) {
-                        intersections_indices.push_back((*i).second);
+                        output((*i).second);
                     }
                 }
             }  
+
+            void get_intersections(const bbox &my_bbox, std::vector<size_t> &intersections_indices) {
+                _get_intersections(my_bbox, [&intersections_indices](size_t index) { intersections_indices.push_back(index); });
+            }
+
+            bool visits_natively() { return true; }
+
+            void visit_intersections(const bbox &my_bbox, ResultSink &sink) {
+                _get_intersections(my_bbox, [&sink](size_t index) { sink.push(index); });
+            }
     };
 
     class Bboxes : public BboxIntersectionTest { 
-        typedef spatial::idle_box_multimap<NUM_DIMS*2, point, size_t> kdtree;
-        typedef spatial::box_multimap<NUM_DIMS*2, point, size_t> kdtree_self_balancing;
+        //a box expressed as a 2*n dimensional point
+        typedef std::array<double, NUM_DIMS*2> flattened_bbox_t;
+        typedef std::pair<flattened_bbox_t, size_t> flattened_bbox_w_index;
+        typedef spatial::idle_box_multimap<NUM_DIMS*2, flattened_bbox_t, size_t> kdtree;
+        typedef spatial::box_multimap<NUM_DIMS*2, flattened_bbox_t, size_t> kdtree_self_balancing;
 
         private:
             kdtree *tree;
@@ -93,14 +108,14 @@ namespace TestSpatial {
                     std::cerr << "error. your point list size has to be even to insert bounding boxes" << std::endl;
                     return;
                 }
-                vector<point_w_index> pts_w_index;
+                vector<flattened_bbox_w_index> pts_w_index;
+                pts_w_index.reserve(pts.size()/2);
                 for(int i = 0; i < pts.size(); i += 2) {
                     //express box as a 2*n dimensional point with all of the lower vertex's coordinates appearing first then all of the uppoer vertex's
-                    point bbox_as_pt;
-                    bbox_as_pt.reserve(2*NUM_DIMS);
-                    bbox_as_pt.insert(bbox_as_pt.end(), pts[i].begin(), pts[i].end());
-                    bbox_as_pt.insert(bbox_as_pt.end(), pts[i+1].begin(), pts[i+1].end());
-                    pts_w_index.push_back(point_w_index(bbox_as_pt, i/2));
+                    flattened_bbox_t bbox_as_pt;
+                    std::copy(pts[i].begin(), pts[i].end(), bbox_as_pt.begin());
+                    std::copy(pts[i+1].begin(), pts[i+1].end(), bbox_as_pt.begin() + NUM_DIMS);
+                    pts_w_index.push_back(flattened_bbox_w_index(bbox_as_pt, i/2));
                 }
 
                 if(self_balancing) {
@@ -115,15 +130,15 @@ namespace TestSpatial {
 
 
             //closed region -> includes points that fall on the boundary
-            void get_intersections(const bbox &my_bbox, std::vector<size_t> &intersections_indices) {
+            template <class OutputFunc>
+            void _get_intersections(const bbox &my_bbox, OutputFunc output) {
                 typedef spatial::overlap_region_iterator<kdtree> iterator;
                 typedef spatial::overlap_region_iterator<kdtree_self_balancing> iterator_balanced;
 
                 //express box as a 2*n dimensional point with all of the lower vertex's coordinates appearing first then all of the uppoer vertex's
-                point flattened_bbox;
-                flattened_bbox.reserve(2*NUM_DIMS);
-                flattened_bbox.insert(flattened_bbox.end(), my_bbox.first.begin(),  my_bbox.first.end());
-                flattened_bbox.insert(flattened_bbox.end(), my_bbox.second.begin(),  my_bbox.second.end());
+                flattened_bbox_t flattened_bbox;
+                std::copy(my_bbox.first.begin(), my_bbox.first.end(), flattened_bbox.begin());
+                std::copy(my_bbox.second.begin(), my_bbox.second.end(), flattened_bbox.begin() + NUM_DIMS);
                 //makes sure we could intersections on the boundary only as intersections
                 for(int i = 0; i < flattened_bbox.size(); i++) {
                     if(i < flattened_bbox.size()/2) {
@@ -136,15 +151,25 @@ namespace TestSpatial {
 
                 if(self_balancing) {
                     for (iterator_balanced i = spatial::overlap_region_begin(*tree_self_balancing, flattened_bbox); i != spatial::overlap_region_end(*tree_self_balancing, flattened_bbox); ++i) {
-                        intersections_indices.push_back((*i).second);
+                        output((*i).second);
                     }
                 }
                 else {
                     for (iterator i = spatial::overlap_region_begin(*tree, flattened_bbox); i != spatial::overlap_region_end(*tree, flattened_bbox); ++i) {
-                        intersections_indices.push_back((*i).second);
+                        output((*i).second);
                     }
                 }
             }  
+
+            void get_intersections(const bbox &my_bbox, std::vector<size_t> &intersections_indices) {
+                _get_intersections(my_bbox, [&intersections_indices](size_t index) { intersections_indices.push_back(index); });
+            }
+
+            bool visits_natively() { return true; }
+
+            void visit_intersections(const bbox &my_bbox, ResultSink &sink) {
+                _get_intersections(my_bbox, [&sink](size_t index) { sink.push(index); });
+            }
         };
 
 };
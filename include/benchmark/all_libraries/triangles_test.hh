@@ -0,0 +1,379 @@
+#ifndef TRIANGLES_TEST_HH
+#define TRIANGLES_TEST_HH
+
+#include <functional>
+#include <memory>
+#include "brute_force_simd_test.hh"
+
+//exact triangle-box overlap with the separating axis theorem (akenine-moller): the triangle and the box only miss each other if
+//one of 13 axes separates them. those are the box's 3 face normals, the triangle's normal, and the 9 cross products of the
+//box's edges with the triangle's edges. boxes are closed, so touching counts as overlapping
+
+//whether the axis separates the triangle (projected to p0, p1, p2) from the box (projected to [-r, r])
+static inline bool triangle_axis_separates(double p0, double p1, double p2, double r) {
+    return std::min(p0, std::min(p1, p2)) > r || std::max(p0, std::max(p1, p2)) < -r;
+}
+
+//verts[j][d] is coordinate d of the triangle's vertex j
+static inline bool triangle_intersects_bbox(const bbox &query, const double verts[3][NUM_DIMS]) {
+    //the box's face normals, tested on the original coordinates so a triangle that only touches the box isn't lost to rounding
+    for(int d = 0; d < NUM_DIMS; d++) {
+        if(std::min(verts[0][d], std::min(verts[1][d], verts[2][d])) > query.second[d] ||
+           std::max(verts[0][d], std::max(verts[1][d], verts[2][d])) < query.first[d]) {
+            return false;
+        }
+    }
+
+    //the other axes are tested relative to the box's center
+    double half[NUM_DIMS];
+    double v[3][NUM_DIMS];
+    for(int d = 0; d < NUM_DIMS; d++) {
+        double center = (query.first[d] + query.second[d]) / 2;
+        half[d] = (query.second[d] - query.first[d]) / 2;
+        for(int j = 0; j < 3; j++) {
+            v[j][d] = verts[j][d] - center;
+        }
+    }
+    double edges[3][NUM_DIMS];
+    for(int d = 0; d < NUM_DIMS; d++) {
+        edges[0][d] = v[1][d] - v[0][d];
+        edges[1][d] = v[2][d] - v[1][d];
+        edges[2][d] = v[0][d] - v[2][d];
+    }
+
+    //the triangle's normal
+    double normal[NUM_DIMS] = {
+        edges[0][1]*edges[1][2] - edges[0][2]*edges[1][1],
+        edges[0][2]*edges[1][0] - edges[0][0]*edges[1][2],
+        edges[0][0]*edges[1][1] - edges[0][1]*edges[1][0]
+    };
+    double r = half[0]*std::fabs(normal[0]) + half[1]*std::fabs(normal[1]) + half[2]*std::fabs(normal[2]);
+    double s = normal[0]*v[0][0] + normal[1]*v[0][1] + normal[2]*v[0][2];
+    if(s > r || s < -r) {
+        return false;
+    }
+
+    //the box's edge k crossed with the triangle's edge i only has components k1 = -e[k2] and k2 = e[k1]
+    for(int i = 0; i < 3; i++) {
+        for(int k = 0; k < NUM_DIMS; k++) {
+            int k1 = (k + 1) % NUM_DIMS;
+            int k2 = (k + 2) % NUM_DIMS;
+            double a1 = -edges[i][k2];
+            double a2 = edges[i][k1];
+            double p0 = a1*v[0][k1] + a2*v[0][k2];
+            double p1 = a1*v[1][k1] + a2*v[1][k2];
+            double p2 = a1*v[2][k1] + a2*v[2][k2];
+            if(triangle_axis_separates(p0, p1, p2, half[k1]*std::fabs(a1) + half[k2]*std::fabs(a2))) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static inline bool triangle_intersects_bbox(const bbox &query, const point &a, const point &b, const point &c) {
+    double verts[3][NUM_DIMS];
+    for(int d = 0; d < NUM_DIMS; d++) {
+        verts[0][d] = a[d];
+        verts[1][d] = b[d];
+        verts[2][d] = c[d];
+    }
+    return triangle_intersects_bbox(query, verts);
+}
+
+//the triangles' vertices as structure-of-arrays (one array per vertex and dimension), so the vector kernel tests 4 triangles at once.
+//the kernels test either a range of the triangles (for brute force) or a list of candidates (for filtering a bbox tree's results)
+class TriangleBoxOverlap {
+    private:
+        BruteForceKernel kernel = SCALAR_KERNEL;
+        size_t num_triangles = 0;
+        std::vector<double> coords[3][NUM_DIMS];
+
+        inline bool scalar_intersects(const bbox &query, size_t i) const {
+            double verts[3][NUM_DIMS];
+            for(int j = 0; j < 3; j++) {
+                for(int d = 0; d < NUM_DIMS; d++) {
+                    verts[j][d] = coords[j][d][i];
+                }
+            }
+            return triangle_intersects_bbox(query, verts);
+        }
+
+        #if BRUTE_FORCE_SIMD_X86
+            //the same tests as triangle_intersects_bbox, on 4 triangles at once. returns a mask with a bit set for each triangle that overlaps
+            __attribute__((target("avx2")))
+            static inline int avx2_overlap_mask(const bbox &query, const __m256d verts[3][NUM_DIMS]) {
+                const __m256d sign_bit = _mm256_set1_pd(-0.0);
+                __m256d separated = _mm256_setzero_pd();
+                __m256d half[NUM_DIMS];
+                __m256d v[3][NUM_DIMS];
+                for(int d = 0; d < NUM_DIMS; d++) {
+                    __m256d vert_min = _mm256_min_pd(verts[0][d], _mm256_min_pd(verts[1][d], verts[2][d]));
+                    __m256d vert_max = _mm256_max_pd(verts[0][d], _mm256_max_pd(verts[1][d], verts[2][d]));
+                    separated = _mm256_or_pd(separated, _mm256_cmp_pd(vert_min, _mm256_set1_pd(query.second[d]), _CMP_GT_OQ));
+                    separated = _mm256_or_pd(separated, _mm256_cmp_pd(vert_max, _mm256_set1_pd(query.first[d]), _CMP_LT_OQ));
+
+                    __m256d center = _mm256_set1_pd((query.first[d] + query.second[d]) / 2);
+                    half[d] = _mm256_set1_pd((query.second[d] - query.first[d]) / 2);
+                    for(int j = 0; j < 3; j++) {
+                        v[j][d] = _mm256_sub_pd(verts[j][d], center);
+                    }
+                }
+                //most triangles are far from the query, so skip the other axes once every lane is separated
+                if(_mm256_movemask_pd(separated) == 0xF) {
+                    return 0;
+                }
+                __m256d edges[3][NUM_DIMS];
+                for(int d = 0; d < NUM_DIMS; d++) {
+                    edges[0][d] = _mm256_sub_pd(v[1][d], v[0][d]);
+                    edges[1][d] = _mm256_sub_pd(v[2][d], v[1][d]);
+                    edges[2][d] = _mm256_sub_pd(v[0][d], v[2][d]);
+                }
+
+                __m256d normal[NUM_DIMS];
+                for(int d = 0; d < NUM_DIMS; d++) {
+                    int d1 = (d + 1) % NUM_DIMS;
+                    int d2 = (d + 2) % NUM_DIMS;
+                    normal[d] = _mm256_sub_pd(_mm256_mul_pd(edges[0][d1], edges[1][d2]), _mm256_mul_pd(edges[0][d2], edges[1][d1]));
+                }
+                __m256d r = _mm256_setzero_pd();
+                __m256d s = _mm256_setzero_pd();
+                for(int d = 0; d < NUM_DIMS; d++) {
+                    r = _mm256_add_pd(r, _mm256_mul_pd(half[d], _mm256_andnot_pd(sign_bit, normal[d])));
+                    s = _mm256_add_pd(s, _mm256_mul_pd(normal[d], v[0][d]));
+                }
+                separated = _mm256_or_pd(separated, _mm256_cmp_pd(s, r, _CMP_GT_OQ));
+                separated = _mm256_or_pd(separated, _mm256_cmp_pd(s, _mm256_xor_pd(r, sign_bit), _CMP_LT_OQ));
+
+                for(int i = 0; i < 3; i++) {
+                    for(int k = 0; k < NUM_DIMS; k++) {
+                        int k1 = (k + 1) % NUM_DIMS;
+                        int k2 = (k + 2) % NUM_DIMS;
+                        __m256d a1 = _mm256_xor_pd(edges[i][k2], sign_bit);
+                        __m256d a2 = edges[i][k1];
+                        __m256d p0 = _mm256_add_pd(_mm256_mul_pd(a1, v[0][k1]), _mm256_mul_pd(a2, v[0][k2]));
+                        __m256d p1 = _mm256_add_pd(_mm256_mul_pd(a1, v[1][k1]), _mm256_mul_pd(a2, v[1][k2]));
+                        __m256d p2 = _mm256_add_pd(_mm256_mul_pd(a1, v[2][k1]), _mm256_mul_pd(a2, v[2][k2]));
+                        __m256d axis_r = _mm256_add_pd(_mm256_mul_pd(half[k1], _mm256_andnot_pd(sign_bit, a1)),
+                                                       _mm256_mul_pd(half[k2], _mm256_andnot_pd(sign_bit, a2)));
+                        __m256d p_min = _mm256_min_pd(p0, _mm256_min_pd(p1, p2));
+                        __m256d p_max = _mm256_max_pd(p0, _mm256_max_pd(p1, p2));
+                        separated = _mm256_or_pd(separated, _mm256_cmp_pd(p_min, axis_r, _CMP_GT_OQ));
+                        separated = _mm256_or_pd(separated, _mm256_cmp_pd(p_max, _mm256_xor_pd(axis_r, sign_bit), _CMP_LT_OQ));
+                    }
+                }
+                return ~_mm256_movemask_pd(separated) & 0xF;
+            }
+
+            __attribute__((target("avx2")))
+            size_t avx2_overlap_range(const bbox &query, size_t begin, size_t end, size_t *out) const {
+                size_t num_matches = 0;
+                size_t i = begin;
+                for(; i + 4 <= end; i += 4) {
+                    __m256d verts[3][NUM_DIMS];
+                    for(int j = 0; j < 3; j++) {
+                        for(int d = 0; d < NUM_DIMS; d++) {
+                            verts[j][d] = _mm256_loadu_pd(coords[j][d].data() + i);
+                        }
+                    }
+                    for(int mask = avx2_overlap_mask(query, verts); mask != 0; mask &= mask - 1) {
+                        out[num_matches++] = i + __builtin_ctz(mask);
+                    }
+                }
+                for(; i < end; i++) {
+                    out[num_matches] = i;
+                    num_matches += scalar_intersects(query, i);
+                }
+                return num_matches;
+            }
+
+            __attribute__((target("avx2")))
+            size_t avx2_overlap_candidates(const bbox &query, const size_t *candidates, size_t num_candidates, size_t *out) const {
+                size_t num_matches = 0;
+                size_t i = 0;
+                for(; i + 4 <= num_candidates; i += 4) {
+                    //read before any of out is written, since out may be candidates
+                    __m256i candidate_indices = _mm256_loadu_si256((const __m256i *)(candidates + i));
+                    __m256d verts[3][NUM_DIMS];
+                    for(int j = 0; j < 3; j++) {
+                        for(int d = 0; d < NUM_DIMS; d++) {
+                            verts[j][d] = _mm256_i64gather_pd(coords[j][d].data(), candidate_indices, sizeof(double));
+                        }
+                    }
+                    size_t lanes[4];
+                    _mm256_storeu_si256((__m256i *)lanes, candidate_indices);
+                    for(int mask = avx2_overlap_mask(query, verts); mask != 0; mask &= mask - 1) {
+                        out[num_matches++] = lanes[__builtin_ctz(mask)];
+                    }
+                }
+                for(; i < num_candidates; i++) {
+                    size_t candidate = candidates[i];
+                    out[num_matches] = candidate;
+                    num_matches += scalar_intersects(query, candidate);
+                }
+                return num_matches;
+            }
+        #endif
+
+    public:
+        //falls back to the scalar kernel if the cpu doesn't support the requested one. there is no avx-512 kernel, so that uses avx2
+        TriangleBoxOverlap(BruteForceKernel requested_kernel = AVX2_KERNEL) {
+            kernel = (requested_kernel == AVX512_KERNEL) ? AVX2_KERNEL : requested_kernel;
+            #if BRUTE_FORCE_SIMD_X86
+                if(kernel == AVX2_KERNEL && !__builtin_cpu_supports("avx2")) {
+                    kernel = SCALAR_KERNEL;
+                }
+            #else
+                kernel = SCALAR_KERNEL;
+            #endif
+        }
+
+        BruteForceKernel get_kernel() const { return kernel; }
+        size_t size() const { return num_triangles; }
+
+        //3 points per triangle
+        void assign(const std::vector<point> &pts) {
+            num_triangles = pts.size() / 3;
+            for(int j = 0; j < 3; j++) {
+                for(int d = 0; d < NUM_DIMS; d++) {
+                    coords[j][d].resize(num_triangles);
+                    for(size_t i = 0; i < num_triangles; i++) {
+                        coords[j][d][i] = pts[3*i + j][d];
+                    }
+                }
+            }
+        }
+
+        //writes the triangles in [begin, end) that overlap the query to out, returning how many there were
+        size_t overlap_range(const bbox &query, size_t begin, size_t end, size_t *out) const {
+            #if BRUTE_FORCE_SIMD_X86
+                if(kernel == AVX2_KERNEL) {
+                    return avx2_overlap_range(query, begin, end, out);
+                }
+            #endif
+            size_t num_matches = 0;
+            for(size_t i = begin; i < end; i++) {
+                out[num_matches] = i;
+                num_matches += scalar_intersects(query, i);
+            }
+            return num_matches;
+        }
+
+        //writes the candidates that overlap the query to out, which may be candidates itself, returning how many there were
+        size_t overlap_candidates(const bbox &query, const size_t *candidates, size_t num_candidates, size_t *out) const {
+            #if BRUTE_FORCE_SIMD_X86
+                if(kernel == AVX2_KERNEL) {
+                    return avx2_overlap_candidates(query, candidates, num_candidates, out);
+                }
+            #endif
+            size_t num_matches = 0;
+            for(size_t i = 0; i < num_candidates; i++) {
+                size_t candidate = candidates[i];
+                out[num_matches] = candidate;
+                num_matches += scalar_intersects(query, candidate);
+            }
+            return num_matches;
+        }
+};
+
+//brute force over every triangle with the overlap kernel
+class TestBruteForceTriangles : public BboxIntersectionTest {
+    private:
+        //number of triangles scanned between appends to the results
+        static const size_t BLOCK_SIZE = 1024;
+        TriangleBoxOverlap triangles;
+
+        //calls output(const size_t *indices, size_t num_indices) once per block of matches
+        template <class OutputFunc>
+        void scan(const bbox &query, OutputFunc output) {
+            size_t block[BLOCK_SIZE];
+            for(size_t begin = 0; begin < triangles.size(); begin += BLOCK_SIZE) {
+                size_t end = std::min(begin + BLOCK_SIZE, triangles.size());
+                size_t num_matches = triangles.overlap_range(query, begin, end, block);
+                if(num_matches > 0) {
+                    output(block, num_matches);
+                }
+            }
+        }
+
+    public:
+        TestBruteForceTriangles(BruteForceKernel requested_kernel = SCALAR_KERNEL) : triangles(requested_kernel) {
+            if(triangles.get_kernel() != requested_kernel) {
+                std::cerr << "error. triangle kernel " << requested_kernel << " isn't available. using kernel " << triangles.get_kernel() << " instead" << std::endl;
+            }
+        }
+
+        bool intersections_exact() { return true; }
+
+        void build_tree(const std::vector<point> &pts, const std::vector<size_t> &indices) {
+            if((pts.size() % 3) != 0) {
+                std::cerr << "error. your point list size has to be divisible by 3 to insert triangles" << std::endl;
+                return;
+            }
+            triangles.assign(pts);
+        }
+
+        void get_intersections(const bbox &my_bbox, std::vector<size_t> &intersections_indices) {
+            scan(my_bbox, [&intersections_indices](const size_t *indices, size_t num_indices) {
+                intersections_indices.insert(intersections_indices.end(), indices, indices + num_indices);
+            });
+        }
+
+        bool visits_natively() { return true; }
+
+        void visit_intersections(const bbox &my_bbox, ResultSink &sink) {
+            scan(my_bbox, [&sink](const size_t *indices, size_t num_indices) {
+                sink.push_range(indices, num_indices);
+            });
+        }
+};
+
+//indexes the triangles' bounding boxes with one of the bbox libraries, then filters its candidates down to the triangles
+//that overlap the query with the overlap kernel. build_bboxes builds the bbox test from the boxes (2 points per triangle)
+template <class BboxTest>
+class TestTriangleBboxes : public BboxIntersectionTest {
+    public:
+        typedef std::function<void(BboxTest *, const std::vector<point> &, const std::vector<size_t> &)> BuildFunc;
+
+    private:
+        //owns the bbox test it is given
+        std::unique_ptr<BboxTest> bbox_test;
+        BuildFunc build_bboxes;
+        TriangleBoxOverlap triangles;
+
+    public:
+        TestTriangleBboxes(BboxTest *bbox_test_, BuildFunc build_bboxes_) : bbox_test(bbox_test_), build_bboxes(build_bboxes_) {}
+        ~TestTriangleBboxes() {
+        }
+
+        //the bbox test may be inexact (e.g., float), but its candidates are always a superset of the overlapping triangles
+        bool intersections_exact() { return true; }
+        bool concurrent_queries_safe() { return bbox_test->concurrent_queries_safe(); }
+
+        void build_tree(const std::vector<point> &pts, const std::vector<size_t> &indices) {
+            if((pts.size() % 3) != 0) {
+                std::cerr << "error. your point list size has to be divisible by 3 to insert triangles" << std::endl;
+                return;
+            }
+            size_t num_triangles = pts.size() / 3;
+            std::vector<point> triangle_bboxes(2*num_triangles);
+            for(size_t i = 0; i < num_triangles; i++) {
+                for(int d = 0; d < NUM_DIMS; d++) {
+                    triangle_bboxes[2*i][d] = std::min(pts[3*i][d], std::min(pts[3*i+1][d], pts[3*i+2][d]));
+                    triangle_bboxes[2*i+1][d] = std::max(pts[3*i][d], std::max(pts[3*i+1][d], pts[3*i+2][d]));
+                }
+            }
+            build_bboxes(bbox_test.get(), triangle_bboxes, indices);
+            triangles.assign(pts);
+        }
+
+        void get_intersections(const bbox &my_bbox, std::vector<size_t> &intersections_indices) {
+            size_t first_result = intersections_indices.size();
+            bbox_test->get_intersections(my_bbox, intersections_indices);
+            size_t *candidates = intersections_indices.data() + first_result;
+            size_t num_matches = triangles.overlap_candidates(my_bbox, candidates, intersections_indices.size() - first_result, candidates);
+            intersections_indices.resize(first_result + num_matches);
+        }
+};
+
+#endif //TRIANGLES_TEST_HH
@@ -0,0 +1,276 @@
+#ifndef UNIFORM_GRID_HH
+#define UNIFORM_GRID_HH
+
+#include <cfloat>
+#include <cmath>
+
+//an in-house dense uniform grid (cell list), for near-uniform meshes. the cell size is picked from the domain's bounds and the number of
+//items, so a cell averages items_per_cell items. the build is a counting sort: the items are bucketed by cell into one structure-of-arrays
+//array, so a cell's items are contiguous, and so is a run of cells along z. an item belongs to the cell of its lower corner, which is exact
+//for points and keeps each bbox in a single cell. a query looks at the cells its lower corner could be in (for bboxes, widened by the
+//largest item extent) and takes the cells strictly between the query corners' cells without testing their items: the cell of a
+//coordinate only grows with it, so their items' lower corners are strictly inside the query. the other cells are scanned with the
+//brute force kernels. bboxes more than a couple of cells wide go in an overflow list that every query scans instead, so a few large
+//elements don't widen every query by their extent
+class TestUniformGrid : public BboxIntersectionTest {
+
+    private:
+        static const size_t DEFAULT_ITEMS_PER_CELL = 8;
+        //keeps the cell indices (and the cell list) in check for degenerate domains
+        static const size_t MAX_CELLS_PER_DIM = size_t(1) << 20;
+        //the cell list holds at most this many cells per cell the items need
+        static const size_t MAX_CELLS_PER_TARGET_CELL = 8;
+        static const size_t SCAN_BLOCK_SIZE = 256;
+        //bboxes wider than this many cells in any dimension go in the overflow list
+        static constexpr double MAX_BUCKETED_EXTENT_IN_CELLS = 2;
+
+        size_t items_per_cell;
+        BruteForceKernel kernel;
+        bool uses_boxes = false;
+        size_t num_items = 0;
+        double lows[NUM_DIMS];
+        double inverse_cell_sizes[NUM_DIMS];
+        size_t num_cells[NUM_DIMS];
+        //the largest extent of any bucketed bbox in each dimension (0 for points)
+        double max_extents[NUM_DIMS];
+        //cell c's items are cell_starts[c] to cell_starts[c+1]-1. cells are ordered with z fastest. the overflow list comes after the
+        //last cell, as if it were one more cell
+        std::vector<size_t> cell_starts;
+        std::vector<size_t> item_ids;
+        //points: mins holds x, y, z. boxes: mins holds the lower corners' x, y, z, and maxs holds the upper corners'
+        std::vector<double> mins[NUM_DIMS];
+        std::vector<double> maxs[NUM_DIMS];
+
+        //nondecreasing in value, which is what lets the query skip its interior cells' tests
+        inline size_t get_cell(double value, int dim) const {
+            double cell = std::floor((value - lows[dim]) * inverse_cell_sizes[dim]);
+            if(!(cell > 0)) {
+                return 0;
+            }
+            if(cell >= double(num_cells[dim] - 1)) {
+                return num_cells[dim] - 1;
+            }
+            return static_cast<size_t>(cell);
+        }
+
+        //the dimensions with an extent split the cells between them, in proportion to their extents. a dimension narrower than a cell
+        //gets a single cell and the others split the cells again, so near-planar data doesn't make the cells tiny in every dimension
+        void size_cells(const double highs[NUM_DIMS]) {
+            double target_num_cells = std::max(double(num_items) / items_per_cell, 1.0);
+            bool split_dims[NUM_DIMS];
+            for(int d = 0; d < NUM_DIMS; d++) {
+                split_dims[d] = highs[d] > lows[d];
+            }
+            double cell_size = 0;
+            for(bool resized = true; resized; ) {
+                double volume = 1;
+                int num_split_dims = 0;
+                for(int d = 0; d < NUM_DIMS; d++) {
+                    if(split_dims[d]) {
+                        volume *= highs[d] - lows[d];
+                        num_split_dims++;
+                    }
+                }
+                cell_size = (num_split_dims > 0) ? std::pow(volume / target_num_cells, 1.0 / num_split_dims) : 0;
+                resized = false;
+                for(int d = 0; d < NUM_DIMS; d++) {
+                    if(split_dims[d] && !(highs[d] - lows[d] >= cell_size)) {
+                        split_dims[d] = false;
+                        resized = true;
+                    }
+                }
+            }
+            //rounding the cells per dimension up can't more than double each one, but this keeps the cell list bounded regardless
+            double max_total_num_cells = MAX_CELLS_PER_TARGET_CELL * target_num_cells;
+            while(true) {
+                double total_num_cells = 1;
+                for(int d = 0; d < NUM_DIMS; d++) {
+                    num_cells[d] = 1;
+                    inverse_cell_sizes[d] = 0;
+                    if(split_dims[d] && cell_size > 0) {
+                        double cells = std::ceil((highs[d] - lows[d]) / cell_size);
+                        num_cells[d] = static_cast<size_t>(std::min(std::max(cells, 1.0), double(MAX_CELLS_PER_DIM)));
+                        inverse_cell_sizes[d] = num_cells[d] / (highs[d] - lows[d]);
+                    }
+                    total_num_cells *= num_cells[d];
+                }
+                if(total_num_cells <= max_total_num_cells) {
+                    break;
+                }
+                cell_size *= 2;
+            }
+        }
+
+        void build(const std::vector<point> &pts, const std::vector<size_t> &indices) {
+            size_t pts_per_item = uses_boxes ? 2 : 1;
+            num_items = pts.size() / pts_per_item;
+            double highs[NUM_DIMS];
+            for(int d = 0; d < NUM_DIMS; d++) {
+                lows[d] = DBL_MAX;
+                highs[d] = -DBL_MAX;
+                max_extents[d] = 0;
+            }
+            for(size_t i = 0; i < num_items; i++) {
+                for(int d = 0; d < NUM_DIMS; d++) {
+                    lows[d] = std::min(lows[d], pts[pts_per_item*i][d]);
+                    highs[d] = std::max(highs[d], pts[pts_per_item*i][d]);
+                }
+            }
+            if(num_items == 0) {
+                for(int d = 0; d < NUM_DIMS; d++) {
+                    lows[d] = highs[d] = 0;
+                }
+            }
+            size_cells(highs);
+
+            //counting sort: count each cell's items, turn the counts into starts, then scatter the items
+            size_t total_num_cells = num_cells[0] * num_cells[1] * num_cells[2];
+            std::vector<size_t> item_cells(num_items);
+            cell_starts.assign(total_num_cells + 2, 0);
+            for(size_t i = 0; i < num_items; i++) {
+                const point &lower_corner = pts[pts_per_item*i];
+                const point &upper_corner = pts[pts_per_item*i + pts_per_item-1];
+                bool oversized = false;
+                for(int d = 0; d < NUM_DIMS; d++) {
+                    oversized |= (upper_corner[d] - lower_corner[d]) * inverse_cell_sizes[d] > MAX_BUCKETED_EXTENT_IN_CELLS;
+                }
+                if(oversized) {
+                    item_cells[i] = total_num_cells;
+                }
+                else {
+                    item_cells[i] = (get_cell(lower_corner[0], 0) * num_cells[1] + get_cell(lower_corner[1], 1)) * num_cells[2] + get_cell(lower_corner[2], 2);
+                    for(int d = 0; d < NUM_DIMS; d++) {
+                        max_extents[d] = std::max(max_extents[d], upper_corner[d] - lower_corner[d]);
+                    }
+                }
+                cell_starts[item_cells[i] + 1]++;
+            }
+            for(size_t c = 0; c <= total_num_cells; c++) {
+                cell_starts[c+1] += cell_starts[c];
+            }
+            std::vector<size_t> next_positions(cell_starts.begin(), cell_starts.end() - 1);
+            item_ids.resize(num_items);
+            for(int d = 0; d < NUM_DIMS; d++) {
+                mins[d].resize(num_items);
+                maxs[d].resize(uses_boxes ? num_items : 0);
+            }
+            for(size_t i = 0; i < num_items; i++) {
+                size_t position = next_positions[item_cells[i]]++;
+                item_ids[position] = indices[i];
+                for(int d = 0; d < NUM_DIMS; d++) {
+                    mins[d][position] = pts[pts_per_item*i][d];
+                    if(uses_boxes) {
+                        maxs[d][position] = pts[pts_per_item*i+1][d];
+                    }
+                }
+            }
+        }
+
+        //calls output(const size_t *indices, size_t num_indices) once per run of interior cells or block of scanned matches
+        template <class OutputFunc>
+        void search(const bbox &query, OutputFunc output) const {
+            if(num_items == 0) {
+                return;
+            }
+            const double *item_mins[NUM_DIMS];
+            const double *item_maxs[NUM_DIMS];
+            //the first and last cells to visit, and the cells of the query's corners. cells strictly between the corners' cells are interior
+            size_t first_cells[NUM_DIMS], last_cells[NUM_DIMS], low_cells[NUM_DIMS];
+            for(int d = 0; d < NUM_DIMS; d++) {
+                item_mins[d] = mins[d].data();
+                item_maxs[d] = uses_boxes ? maxs[d].data() : mins[d].data();
+                low_cells[d] = get_cell(query.first[d], d);
+                last_cells[d] = get_cell(query.second[d], d);
+                first_cells[d] = low_cells[d];
+                if(max_extents[d] > 0) {
+                    //one more cell covers the rounding of the subtraction
+                    first_cells[d] = get_cell(query.first[d] - max_extents[d], d);
+                    first_cells[d] -= (first_cells[d] > 0) ? 1 : 0;
+                }
+            }
+            size_t block[SCAN_BLOCK_SIZE + TestBruteForceSIMD::BLOCK_PADDING];
+            auto scan = [&](size_t begin, size_t end) {
+                for(; begin < end; begin += SCAN_BLOCK_SIZE) {
+                    size_t block_end = std::min(begin + SCAN_BLOCK_SIZE, end);
+                    size_t num_matches = TestBruteForceSIMD::run_kernel(kernel, query, item_mins, item_maxs, begin, block_end, block);
+                    for(size_t i = 0; i < num_matches; i++) {
+                        block[i] = item_ids[block[i]];
+                    }
+                    if(num_matches > 0) {
+                        output(block, num_matches);
+                    }
+                }
+            };
+
+            for(size_t x = first_cells[0]; x <= last_cells[0]; x++) {
+                for(size_t y = first_cells[1]; y <= last_cells[1]; y++) {
+                    //a run of cells along z is contiguous
+                    size_t row = (x * num_cells[1] + y) * num_cells[2];
+                    size_t row_begin = cell_starts[row + first_cells[2]];
+                    size_t row_end = cell_starts[row + last_cells[2] + 1];
+                    bool interior_row = x > low_cells[0] && x < last_cells[0] && y > low_cells[1] && y < last_cells[1];
+                    if(!interior_row || last_cells[2] < low_cells[2] + 2) {
+                        scan(row_begin, row_end);
+                        continue;
+                    }
+                    size_t interior_begin = cell_starts[row + low_cells[2] + 1];
+                    size_t interior_end = cell_starts[row + last_cells[2]];
+                    scan(row_begin, interior_begin);
+                    if(interior_end > interior_begin) {
+                        output(item_ids.data() + interior_begin, interior_end - interior_begin);
+                    }
+                    scan(interior_end, row_end);
+                }
+            }
+            size_t total_num_cells = cell_starts.size() - 2;
+            scan(cell_starts[total_num_cells], cell_starts[total_num_cells + 1]);
+        }
+
+    public:
+
+        //exact double precision comparisons
+        bool intersections_exact() { return true; }
+
+        //falls back to the scalar kernel if the cpu doesn't support the requested one
+        TestUniformGrid(size_t target_items_per_cell = DEFAULT_ITEMS_PER_CELL, BruteForceKernel requested_kernel = AVX2_KERNEL) {
+            items_per_cell = std::max(target_items_per_cell, size_t(1));
+            kernel = requested_kernel;
+            if(!TestBruteForceSIMD::kernel_supported(kernel)) {
+                std::cerr << "error. this cpu doesn't support brute force kernel " << kernel << ". using the scalar kernel for the cells instead" << std::endl;
+                kernel = SCALAR_KERNEL;
+            }
+        }
+        ~TestUniformGrid() {
+        }
+
+        void build_tree(const std::vector<point> &pts, const std::vector<size_t> &indices) {
+            uses_boxes = false;
+            build(pts, indices);
+        }
+
+        void build_tree_bbox(const std::vector<point> &pts, const std::vector<size_t> &indices) {
+            if((pts.size() % 2) !=0) {
+                std::cerr << "error. your point list size has to be even to insert bounding boxes" << std::endl;
+                return;
+            }
+            uses_boxes = true;
+            build(pts, indices);
+        }
+
+        void get_intersections(const bbox &my_bbox, std::vector<size_t> &intersections_indices) {
+            search(my_bbox, [&intersections_indices](const size_t *indices, size_t num_indices) {
+                intersections_indices.insert(intersections_indices.end(), indices, indices + num_indices);
+            });
+        }
+
+        bool visits_natively() { return true; }
+
+        void visit_intersections(const bbox &my_bbox, ResultSink &sink) {
+            search(my_bbox, [&sink](const size_t *indices, size_t num_indices) {
+                sink.push_range(indices, num_indices);
+            });
+        }
+
+};
+
+#endif //UNIFORM_GRID_HH
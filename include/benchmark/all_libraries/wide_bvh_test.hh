@@ -0,0 +1,351 @@
+#ifndef WIDE_BVH_HH
+#define WIDE_BVH_HH
+
+#include <atomic>
+#include <cfloat>
+#include <numeric>
+
+//an in-house bounding volume hierarchy with WIDTH (4 or 8) children per node, for element bboxes, which overlap too much for kd-style
+//splits. each node holds its children's bounds as structure-of-arrays, so the brute force kernels test all of a node's children at once
+//(one avx2 register of 4 doubles per bound, or one avx-512 register for 8). it is built top down with a binned surface area heuristic:
+//a node's range of items is split (with sah) into up to WIDTH clusters, largest area first, and the clusters that are still too big for
+//a leaf become child nodes. every subtree's items are a contiguous range, so a child that the query contains is returned without
+//being visited. the nodes visited by the queries are counted, to compare the traversal with binary trees like cgal's aabb tree
+template <size_t WIDTH = 4>
+class TestWideBvh : public BboxIntersectionTest {
+
+    private:
+        static const size_t NUM_BINS = 16;
+        //bounds the leaf scans' buffer on the stack
+        static const size_t MAX_LEAF_SIZE = 64;
+        static const uint32_t LEAF_CHILD = UINT32_MAX;
+        //a split leaves at least 1/MAX_SPLIT_IMBALANCE of the range on each side, so skewed centers can't make the recursion o(n) deep
+        static const size_t MAX_SPLIT_IMBALANCE = 16;
+
+        struct wide_node {
+            //the children's min x, y, z, then max x, y, z. empty children have inverted bounds, so no query overlaps them
+            double bounds[2*NUM_DIMS][WIDTH];
+            //the child node, or LEAF_CHILD if the child is a leaf
+            uint32_t children[WIDTH];
+            //the range of items under each child
+            size_t item_begins[WIDTH];
+            size_t item_ends[WIDTH];
+        };
+
+        struct range_bounds {
+            double mins[NUM_DIMS];
+            double maxs[NUM_DIMS];
+
+            range_bounds() {
+                for(int d = 0; d < NUM_DIMS; d++) {
+                    mins[d] = DBL_MAX;
+                    maxs[d] = -DBL_MAX;
+                }
+            }
+
+            void extend(const range_bounds &other) {
+                for(int d = 0; d < NUM_DIMS; d++) {
+                    mins[d] = std::min(mins[d], other.mins[d]);
+                    maxs[d] = std::max(maxs[d], other.maxs[d]);
+                }
+            }
+
+            double surface_area() const {
+                double extents[NUM_DIMS];
+                for(int d = 0; d < NUM_DIMS; d++) {
+                    extents[d] = std::max(maxs[d] - mins[d], 0.0);
+                }
+                return 2 * (extents[0]*extents[1] + extents[1]*extents[2] + extents[2]*extents[0]);
+            }
+        };
+
+        size_t leaf_size;
+        BruteForceKernel kernel;
+        size_t num_items = 0;
+        std::vector<wide_node> nodes;
+        //the index of each item (in tree order) that is returned for it
+        std::vector<size_t> item_ids;
+        std::vector<double> item_mins[NUM_DIMS];
+        std::vector<double> item_maxs[NUM_DIMS];
+        std::atomic<uint64_t> num_nodes_visited;
+
+        //used only during the build: each item's bounds and doubled center, by its position in the input
+        std::vector<range_bounds> build_bounds;
+        std::vector<double> build_centers[NUM_DIMS];
+
+        range_bounds get_range_bounds(const std::vector<size_t> &order, size_t begin, size_t end) const {
+            range_bounds bounds;
+            for(size_t i = begin; i < end; i++) {
+                bounds.extend(build_bounds[order[i]]);
+            }
+            return bounds;
+        }
+
+        //splits [begin, end) along the widest dimension of its centers, at the binned split with the lowest surface area cost.
+        //falls back to the median if the centers can't be told apart by the bins, or if every binned split is too unbalanced
+        size_t split_range(std::vector<size_t> &order, size_t begin, size_t end) const {
+            double center_mins[NUM_DIMS], center_maxs[NUM_DIMS];
+            for(int d = 0; d < NUM_DIMS; d++) {
+                center_mins[d] = DBL_MAX;
+                center_maxs[d] = -DBL_MAX;
+            }
+            for(size_t i = begin; i < end; i++) {
+                for(int d = 0; d < NUM_DIMS; d++) {
+                    center_mins[d] = std::min(center_mins[d], build_centers[d][order[i]]);
+                    center_maxs[d] = std::max(center_maxs[d], build_centers[d][order[i]]);
+                }
+            }
+            int dim = 0;
+            for(int d = 1; d < NUM_DIMS; d++) {
+                if(center_maxs[d] - center_mins[d] > center_maxs[dim] - center_mins[dim]) {
+                    dim = d;
+                }
+            }
+            size_t mid = begin + (end - begin)/2;
+            double extent = center_maxs[dim] - center_mins[dim];
+            if(extent > 0) {
+                auto get_bin = [&](size_t item) {
+                    size_t bin = static_cast<size_t>((build_centers[dim][item] - center_mins[dim]) * (NUM_BINS / extent));
+                    return std::min(bin, NUM_BINS - 1);
+                };
+                range_bounds bin_bounds[NUM_BINS];
+                size_t bin_counts[NUM_BINS] = {0};
+                for(size_t i = begin; i < end; i++) {
+                    size_t bin = get_bin(order[i]);
+                    bin_bounds[bin].extend(build_bounds[order[i]]);
+                    bin_counts[bin]++;
+                }
+                //the cost of the split before bin s is the area times the count of each side
+                double right_costs[NUM_BINS];
+                range_bounds right_bounds;
+                size_t right_count = 0;
+                for(size_t s = NUM_BINS - 1; s > 0; s--) {
+                    right_bounds.extend(bin_bounds[s]);
+                    right_count += bin_counts[s];
+                    right_costs[s] = right_bounds.surface_area() * right_count;
+                }
+                size_t min_side = std::max((end - begin) / MAX_SPLIT_IMBALANCE, size_t(1));
+                range_bounds left_bounds;
+                size_t left_count = 0;
+                size_t best_split = 0;
+                double best_cost = DBL_MAX;
+                for(size_t s = 1; s < NUM_BINS; s++) {
+                    left_bounds.extend(bin_bounds[s-1]);
+                    left_count += bin_counts[s-1];
+                    if(left_count < min_side || end - begin - left_count < min_side) {
+                        continue;
+                    }
+                    double cost = left_bounds.surface_area() * left_count + right_costs[s];
+                    if(cost < best_cost) {
+                        best_cost = cost;
+                        best_split = s;
+                    }
+                }
+                if(best_split > 0) {
+                    return std::partition(order.begin() + begin, order.begin() + end, [&](size_t item) { return get_bin(item) < best_split; }) - order.begin();
+                }
+            }
+            std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end, [&](size_t a, size_t b) {
+                return build_centers[dim][a] < build_centers[dim][b];
+            });
+            return mid;
+        }
+
+        //returns the index of the node built over [begin, end)
+        uint32_t build_node(std::vector<size_t> &order, size_t begin, size_t end) {
+            //the clusters become the node's children. the largest one (by area) that is too big for a leaf is split until there are WIDTH
+            std::vector<std::pair<size_t, size_t>> clusters(1, std::make_pair(begin, end));
+            std::vector<range_bounds> cluster_bounds(1, get_range_bounds(order, begin, end));
+            while(clusters.size() < WIDTH) {
+                size_t largest = clusters.size();
+                for(size_t c = 0; c < clusters.size(); c++) {
+                    if(clusters[c].second - clusters[c].first > leaf_size &&
+                        (largest == clusters.size() || cluster_bounds[c].surface_area() > cluster_bounds[largest].surface_area()))
+                    {
+                        largest = c;
+                    }
+                }
+                if(largest == clusters.size()) {
+                    break;
+                }
+                size_t cluster_begin = clusters[largest].first;
+                size_t cluster_end = clusters[largest].second;
+                size_t mid = split_range(order, cluster_begin, cluster_end);
+                clusters[largest] = std::make_pair(cluster_begin, mid);
+                cluster_bounds[largest] = get_range_bounds(order, cluster_begin, mid);
+                clusters.push_back(std::make_pair(mid, cluster_end));
+                cluster_bounds.push_back(get_range_bounds(order, mid, cluster_end));
+            }
+
+            uint32_t node_index = nodes.size();
+            nodes.emplace_back();
+            for(size_t c = 0; c < WIDTH; c++) {
+                //the recursion grows nodes, so the node is looked up again each time
+                uint32_t child = LEAF_CHILD;
+                range_bounds bounds;
+                size_t child_begin = 0, child_end = 0;
+                if(c < clusters.size()) {
+                    bounds = cluster_bounds[c];
+                    child_begin = clusters[c].first;
+                    child_end = clusters[c].second;
+                    if(child_end - child_begin > leaf_size) {
+                        child = build_node(order, child_begin, child_end);
+                    }
+                }
+                wide_node &node = nodes[node_index];
+                for(int d = 0; d < NUM_DIMS; d++) {
+                    node.bounds[d][c] = bounds.mins[d];
+                    node.bounds[NUM_DIMS + d][c] = bounds.maxs[d];
+                }
+                node.children[c] = child;
+                node.item_begins[c] = child_begin;
+                node.item_ends[c] = child_end;
+            }
+            return node_index;
+        }
+
+        void build(const std::vector<point> &pts, const std::vector<size_t> &indices, size_t pts_per_item) {
+            num_items = pts.size() / pts_per_item;
+            build_bounds.resize(num_items);
+            for(int d = 0; d < NUM_DIMS; d++) {
+                build_centers[d].resize(num_items);
+            }
+            for(size_t i = 0; i < num_items; i++) {
+                for(int d = 0; d < NUM_DIMS; d++) {
+                    build_bounds[i].mins[d] = pts[pts_per_item*i][d];
+                    build_bounds[i].maxs[d] = pts[pts_per_item*i + pts_per_item-1][d];
+                    build_centers[d][i] = build_bounds[i].mins[d] + build_bounds[i].maxs[d];
+                }
+            }
+            std::vector<size_t> order(num_items);
+            std::iota(order.begin(), order.end(), 0);
+            nodes.clear();
+            if(num_items > 0) {
+                build_node(order, 0, num_items);
+            }
+
+            item_ids.resize(num_items);
+            for(int d = 0; d < NUM_DIMS; d++) {
+                item_mins[d].resize(num_items);
+                item_maxs[d].resize(num_items);
+            }
+            for(size_t i = 0; i < num_items; i++) {
+                item_ids[i] = indices[order[i]];
+                for(int d = 0; d < NUM_DIMS; d++) {
+                    item_mins[d][i] = build_bounds[order[i]].mins[d];
+                    item_maxs[d][i] = build_bounds[order[i]].maxs[d];
+                }
+            }
+            build_bounds = std::vector<range_bounds>();
+            for(int d = 0; d < NUM_DIMS; d++) {
+                build_centers[d] = std::vector<double>();
+            }
+        }
+
+        static inline bool child_contained(const bbox &query, const wide_node &node, size_t c) {
+            return(
+                   query.first[0] <= node.bounds[0][c] && node.bounds[NUM_DIMS+0][c] <= query.second[0]
+                && query.first[1] <= node.bounds[1][c] && node.bounds[NUM_DIMS+1][c] <= query.second[1]
+                && query.first[2] <= node.bounds[2][c] && node.bounds[NUM_DIMS+2][c] <= query.second[2]
+            );
+        }
+
+        //calls output(const size_t *indices, size_t num_indices) once per contained child or leaf's matches
+        template <class OutputFunc>
+        void search_node(const bbox &query, uint32_t node_index, OutputFunc &output, uint64_t &num_visited) const {
+            num_visited++;
+            const wide_node &node = nodes[node_index];
+            const double *child_mins[NUM_DIMS] = {node.bounds[0], node.bounds[1], node.bounds[2]};
+            const double *child_maxs[NUM_DIMS] = {node.bounds[NUM_DIMS], node.bounds[NUM_DIMS+1], node.bounds[NUM_DIMS+2]};
+            size_t overlapping[WIDTH + TestBruteForceSIMD::BLOCK_PADDING];
+            size_t num_overlapping = TestBruteForceSIMD::run_kernel(kernel, query, child_mins, child_maxs, 0, WIDTH, overlapping);
+
+            for(size_t i = 0; i < num_overlapping; i++) {
+                size_t c = overlapping[i];
+                if(child_contained(query, node, c)) {
+                    output(item_ids.data() + node.item_begins[c], node.item_ends[c] - node.item_begins[c]);
+                }
+                else if(node.children[c] == LEAF_CHILD) {
+                    const double *leaf_mins[NUM_DIMS] = {item_mins[0].data(), item_mins[1].data(), item_mins[2].data()};
+                    const double *leaf_maxs[NUM_DIMS] = {item_maxs[0].data(), item_maxs[1].data(), item_maxs[2].data()};
+                    size_t leaf_matches[MAX_LEAF_SIZE + TestBruteForceSIMD::BLOCK_PADDING];
+                    size_t num_matches = TestBruteForceSIMD::run_kernel(kernel, query, leaf_mins, leaf_maxs, node.item_begins[c], node.item_ends[c], leaf_matches);
+                    for(size_t j = 0; j < num_matches; j++) {
+                        leaf_matches[j] = item_ids[leaf_matches[j]];
+                    }
+                    if(num_matches > 0) {
+                        output(leaf_matches, num_matches);
+                    }
+                }
+                else {
+                    search_node(query, node.children[c], output, num_visited);
+                }
+            }
+        }
+
+        template <class OutputFunc>
+        void search(const bbox &query, OutputFunc output) {
+            if(num_items == 0) {
+                return;
+            }
+            uint64_t num_visited = 0;
+            search_node(query, 0, output, num_visited);
+            num_nodes_visited.fetch_add(num_visited, std::memory_order_relaxed);
+        }
+
+    public:
+
+        //exact double precision comparisons
+        bool intersections_exact() { return true; }
+
+        //falls back to avx2, then to the scalar kernel, if the cpu doesn't support the requested one
+        TestWideBvh(size_t leaf_sz = WIDTH, BruteForceKernel requested_kernel = (WIDTH >= 8) ? AVX512_KERNEL : AVX2_KERNEL) : num_nodes_visited(0) {
+            leaf_size = std::min(std::max(leaf_sz, size_t(1)), MAX_LEAF_SIZE);
+            if(leaf_size != leaf_sz) {
+                std::cerr << "error. the wide bvh's leaf size has to be between 1 and " << MAX_LEAF_SIZE << ". using " << leaf_size << std::endl;
+            }
+            kernel = requested_kernel;
+            if(kernel == AVX512_KERNEL && !TestBruteForceSIMD::kernel_supported(kernel)) {
+                kernel = AVX2_KERNEL;
+            }
+            if(!TestBruteForceSIMD::kernel_supported(kernel)) {
+                std::cerr << "error. this cpu doesn't support brute force kernel " << kernel << ". using the scalar kernel for the nodes instead" << std::endl;
+                kernel = SCALAR_KERNEL;
+            }
+        }
+        ~TestWideBvh() {
+        }
+
+        //points are stored as boxes with no extent
+        void build_tree(const std::vector<point> &pts, const std::vector<size_t> &indices) {
+            build(pts, indices, 1);
+        }
+
+        void build_tree_bbox(const std::vector<point> &pts, const std::vector<size_t> &indices) {
+            if((pts.size() % 2) !=0) {
+                std::cerr << "error. your point list size has to be even to insert bounding boxes" << std::endl;
+                return;
+            }
+            build(pts, indices, 2);
+        }
+
+        void get_intersections(const bbox &my_bbox, std::vector<size_t> &intersections_indices) {
+            search(my_bbox, [&intersections_indices](const size_t *indices, size_t num_indices) {
+                intersections_indices.insert(intersections_indices.end(), indices, indices + num_indices);
+            });
+        }
+
+        bool visits_natively() { return true; }
+
+        void visit_intersections(const bbox &my_bbox, ResultSink &sink) {
+            search(my_bbox, [&sink](const size_t *indices, size_t num_indices) {
+                sink.push_range(indices, num_indices);
+            });
+        }
+
+        bool counts_nodes_visited() { return true; }
+        uint64_t get_num_nodes_visited() { return num_nodes_visited.load(std::memory_order_relaxed); }
+
+};
+
+#endif //WIDE_BVH_HH
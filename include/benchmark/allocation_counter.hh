@@ -0,0 +1,12 @@
+#ifndef ALLOCATION_COUNTER_HH
+#define ALLOCATION_COUNTER_HH
+
+#include <cstdint>
+
+//number of heap allocations (malloc, calloc, realloc, the aligned allocators memalign, aligned_alloc, posix_memalign, valloc and pvalloc,
+//and everything built on top of them, like operator new) the process has made so far. without glibc only operator new is counted.
+//the counting interposer lives in allocation_counter.cpp, which is linked into the benchmark. each thread counts separately and a read
+//sums every thread's count, so take the difference between two reads around a region of interest
+uint64_t get_num_allocations();
+
+#endif //ALLOCATION_COUNTER_HH
@@ -6,21 +6,32 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //// 3d_bboxes /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void test_brute_force_bboxes(const std::vector<point> &pts_bbox, const std::vector<size_t> &indices_bbox, testing_config config, const std::vector<std::vector<size_t>> &element_node_ids) ;
-void test_boost_bboxes(const std::vector<point> &pts_bbox, const std::vector<size_t> &indices_bbox, testing_config config, const std::vector<std::vector<size_t>> &element_node_ids);
-void test_cgal_bboxes(const std::vector<point> &pts_bbox, const std::vector<size_t> &indices_bbox, testing_config config, const std::vector<std::vector<size_t>> &element_node_ids);
-void test_libspatialindex_bboxes(const std::vector<point> &pts_bbox, const std::vector<size_t> &indices_bbox, testing_config config, const std::vector<std::vector<size_t>> &element_node_ids);
-void test_rtree_template_bboxes(const std::vector<point> &pts_bbox, const std::vector<size_t> &indices_bbox, testing_config config, const std::vector<std::vector<size_t>> &element_node_ids);
-void test_spatial_bboxes(const std::vector<point> &pts_bbox, const std::vector<size_t> &indices_bbox, testing_config config, const std::vector<std::vector<size_t>> &element_node_ids);
+void test_brute_force_bboxes(const std::vector<point> &pts_bbox, const std::vector<size_t> &indices_bbox, testing_config config, const element_connectivity &element_node_ids) ;
+void test_native_kdtree_bboxes(const std::vector<point> &pts_bbox, const std::vector<size_t> &indices_bbox, testing_config config, const element_connectivity &element_node_ids) ;
+void test_native_rtree_bboxes(const std::vector<point> &pts_bbox, const std::vector<size_t> &indices_bbox, testing_config config, const element_connectivity &element_node_ids) ;
+void test_uniform_grid_bboxes(const std::vector<point> &pts_bbox, const std::vector<size_t> &indices_bbox, testing_config config, const element_connectivity &element_node_ids) ;
+void test_wide_bvh_bboxes(const std::vector<point> &pts_bbox, const std::vector<size_t> &indices_bbox, testing_config config, const element_connectivity &element_node_ids) ;
+void test_boost_bboxes(const std::vector<point> &pts_bbox, const std::vector<size_t> &indices_bbox, testing_config config, const element_connectivity &element_node_ids);
+void test_cgal_bboxes(const std::vector<point> &pts_bbox, const std::vector<size_t> &indices_bbox, testing_config config, const element_connectivity &element_node_ids);
+void test_libspatialindex_bboxes(const std::vector<point> &pts_bbox, const std::vector<size_t> &indices_bbox, testing_config config, const element_connectivity &element_node_ids);
+void test_rtree_template_bboxes(const std::vector<point> &pts_bbox, const std::vector<size_t> &indices_bbox, testing_config config, const element_connectivity &element_node_ids);
+void test_spatial_bboxes(const std::vector<point> &pts_bbox, const std::vector<size_t> &indices_bbox, testing_config config, const element_connectivity &element_node_ids);
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //// 3d_faces //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+void test_brute_force_faces(const std::vector<point> &pts_triangle, const std::vector<size_t> &indices_triangle, testing_config config);
+void test_boost_faces(const std::vector<point> &pts_triangle, const std::vector<size_t> &indices_triangle, testing_config config);
 void test_cgal_faces(const std::vector<point> &pts_triangle, const std::vector<size_t> &indices_triangle, testing_config config);
+void test_libspatialindex_faces(const std::vector<point> &pts_triangle, const std::vector<size_t> &indices_triangle, testing_config config);
+void test_rtree_template_faces(const std::vector<point> &pts_triangle, const std::vector<size_t> &indices_triangle, testing_config config);
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //// 3d_points /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 void test_brute_force_points(const std::vector<point> &pts, const std::vector<size_t> &indices, testing_config config);
+void test_native_kdtree_points(const std::vector<point> &pts, const std::vector<size_t> &indices, testing_config config);
+void test_uniform_grid_points(const std::vector<point> &pts, const std::vector<size_t> &indices, testing_config config);
+void test_linear_octree_points(const std::vector<point> &pts, const std::vector<size_t> &indices, testing_config config);
 void test_3dtk_points(const std::vector<point> &pts, const std::vector<size_t> &indices, testing_config config);
 void test_alglib_points(const std::vector<point> &pts, const std::vector<size_t> &indices, testing_config config);    
 void test_ann_points(const std::vector<point> &pts, const std::vector<size_t> &indices, testing_config config);
@@ -75,6 +86,6 @@ string get_full_path_for_mesh(const string &mesh_file_path, const string &mesh_f
 }
 
 void perform_test(const std::vector<point> &mesh_coordinates, const std::vector<size_t> &indices, const testing_config &config,
-    const std::vector<std::vector<size_t>> &element_node_ids);
+    const element_connectivity &element_node_ids);
 
 #endif //BENCHMARK_HH
\ No newline at end of file
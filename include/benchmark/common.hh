@@ -3,16 +3,22 @@
 
 #include <stdlib.h>
 #include <vector>
+#include <array>
+#include <algorithm>
 #include <iostream>
 #include <chrono> /* high resolution clock */
 #include <math.h>       /* pow */
+#include <cmath>        /* nextafter */
+#include <limits>
 #include "testing_configurations.hh"
+#include "perf_counters.hh"
 #include <mpi.h>
 
 #include <sstream>
 #include <boost/archive/text_iarchive.hpp>
 #include <boost/archive/text_oarchive.hpp>
 #include <boost/serialization/vector.hpp>
+#include <boost/serialization/string.hpp>
 
 
 #define NUM_DIMS 3
@@ -21,7 +27,6 @@
 #define DOMAIN_LENGTH 5
 #define DEFAULT_TOLERANCE .00001
 #define DEFAULT_LARGE_TOLERANCE .0001
-#define RETRIEVE_NODES_FOR_BBOXES false
 
 #ifndef DEBUG
     #define DEBUG false
@@ -29,30 +34,58 @@
 
 extern bool USE_MPI;
 
-typedef std::vector<double> point;
+//fixed-size points, so a std::vector<point> is one contiguous (x,y,z,x,y,z,...) coordinate buffer with no per-point heap allocation
+template <class T> using scalar_point = std::array<T, NUM_DIMS>;
+template <class T> using scalar_bbox = std::pair<scalar_point<T>, scalar_point<T>>;
+
+typedef scalar_point<double> point;
 typedef std::pair<point, size_t> point_w_index;
-typedef std::pair<point, point> bbox;
+typedef scalar_bbox<double> bbox;
 typedef std::pair<bbox, size_t> bbox_w_index;
 
-typedef std::vector<float> point_f; // flann with CUDA only supports floats
+typedef scalar_point<float> point_f; // flann with CUDA only supports floats
 typedef std::pair<point_f, size_t> point_w_index_f;
 typedef std::pair<point_f, point_f> bbox_f;
 typedef std::pair<bbox_f, point_f> bbox_w_index_f;
 
 
-inline void print_results_header() {
-    std::cout << "category, library option name, time elapsed (ns), avg perc data pts intersected, library, library option, num data pts written, num queries, x min, x max, y min, y max, z min, z max" << std::endl;
+inline void print_results_header(bool use_perf_counters = false) {
+    std::cout << "category, library option name, time elapsed (ns), avg perc data pts intersected, library, library option, num data pts written, num queries, x min, x max, y min, y max, z min, z max";
+    if(use_perf_counters) {
+        for(int i = 0; i < NUM_PERF_COUNTERS; i++) {
+            std::cout << ", " << PERF_COUNTER_NAMES[i];
+        }
+    }
+    std::cout << std::endl;
 }
 
-inline void print_config(const testing_config &config) {
+//if the config uses perf counters, every row gets the counter columns. rows that weren't measured (or counters that couldn't be opened) are NA
+inline void print_config(const testing_config &config, const perf_counter_values &counters = perf_counter_values()) {
     std::cout << ", " << config.library << ", " << config.library_option;
     std::cout << ", " << config.num_data_pts << ", " << config.num_queries;
     for(size_t i = 0; i < config.domain_lower_bounds.size(); i++) {
         std::cout <<  ", " << config.domain_lower_bounds[i] << ", " << config.domain_upper_bounds[i];
     }
+    if(config.use_perf_counters) {
+        for(int i = 0; i < NUM_PERF_COUNTERS; i++) {
+            if(counters.values[i] == PERF_COUNTER_UNAVAILABLE) {
+                std::cout << ", NA";
+            }
+            else {
+                std::cout << ", " << counters.values[i];
+            }
+        }
+    }
     std::cout << std::endl << std::flush;
 }
 
+//assumes the rank is 0. all_counters holds NUM_PERF_COUNTERS values for each rank
+inline perf_counter_values get_rank_perf_counters(const std::vector<uint64_t> &all_counters, int rank) {
+    perf_counter_values counters;
+    std::copy(all_counters.begin() + rank*NUM_PERF_COUNTERS, all_counters.begin() + (rank+1)*NUM_PERF_COUNTERS, counters.values);
+    return counters;
+}
+
 
 
 //asssumes the rank is 0
@@ -136,9 +169,59 @@ void gatherv_ser_and_combine(const T &value, uint32_t num_procs, int rank, MPI_C
 }
 
 
+inline const char *get_data_source_name(DataSource data_source) {
+    switch(data_source) {
+        case EXODUS_MESH: return "Exodus";
+        case UNIFORM_DATA: return "Synthetic Uniform";
+        case GAUSSIAN_CLUSTERS: return "Synthetic Gaussian Clusters";
+        case POWER_LAW_DENSITY: return "Synthetic Power Law";
+        case THIN_SHELLS: return "Synthetic Thin Shells";
+        case ANISOTROPIC_SLABS: return "Synthetic Anisotropic Slabs";
+        case DUPLICATE_COORDINATES: return "Synthetic Duplicate Coordinates";
+        default: return "Unknown";
+    }
+}
+
+//source name: Snapshot if this rank's mesh was loaded from its snapshot, otherwise the data source's name (e.g., Exodus)
+inline void print_load_time(DataSource data_source, bool loaded_from_snapshot, uint64_t load_time_ns, const testing_config &config) {
+    int num_procs, rank;
+
+    if(USE_MPI) {
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);    
+        MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
+        std::vector<testing_config> all_configs;
+        uint64_t all_load_times[num_procs];
+        int from_snapshot = loaded_from_snapshot;
+        int all_from_snapshot[num_procs];
+
+        MPI_Gather(&load_time_ns, 1, MPI_UINT64_T, all_load_times, 1, MPI_UINT64_T, 0, MPI_COMM_WORLD);
+        MPI_Gather(&from_snapshot, 1, MPI_INT, all_from_snapshot, 1, MPI_INT, 0, MPI_COMM_WORLD);
+
+        gatherv_ser_and_combine(config, num_procs, rank, MPI_COMM_WORLD, all_configs);
+        if(rank == 0) {
+            for(int i = 0; i < all_configs.size(); i++) {
+                std::cout << "load time, " << (all_from_snapshot[i] ? "Snapshot" : get_data_source_name(data_source)) << ", " << all_load_times[i] << ", 0";
+                print_config(all_configs[i]);    
+            }
+        }          
+    }
+    else {
+        std::cout << "load time, " << (loaded_from_snapshot ? "Snapshot" : get_data_source_name(data_source)) << ", " << load_time_ns << ", 0";
+        print_config(config);           
+    }
+}
+
+//keeps a time for the complexity exponents of a dataset size sweep. does nothing unless a sweep is recording (see scaling_sweep.hh)
+void record_sweep_sample(const std::string &category, const std::string &test_name, size_t num_data_pts, uint64_t value);
+
+//the build's perf counters are started by perform_test, before the tree is constructed
 inline void print_build_time(std::string test_name, std::chrono::high_resolution_clock::time_point build_start_time, testing_config config) {
     std::chrono::high_resolution_clock::time_point build_stop_time = std::chrono::high_resolution_clock::now();
     uint64_t build_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(build_stop_time - build_start_time).count();
+    perf_counter_values counters;
+    if(config.use_perf_counters) {
+        counters = phase_perf_counters().stop();
+    }
     int num_procs, rank;
 
     if(USE_MPI) {
@@ -146,57 +229,75 @@ inline void print_build_time(std::string test_name, std::chrono::high_resolution
         MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
         std::vector<testing_config> all_configs;
         uint64_t all_build_times[num_procs];
+        std::vector<uint64_t> all_counters(num_procs * NUM_PERF_COUNTERS);
 
         MPI_Gather(&build_time_ns, 1, MPI_UINT64_T, all_build_times, 1, MPI_UINT64_T, 0, MPI_COMM_WORLD);
+        MPI_Gather(counters.values, NUM_PERF_COUNTERS, MPI_UINT64_T, all_counters.data(), NUM_PERF_COUNTERS, MPI_UINT64_T, 0, MPI_COMM_WORLD);
 
         gatherv_ser_and_combine(config, num_procs, rank, MPI_COMM_WORLD, all_configs);
         if(rank == 0) {
             for(int i = 0; i < all_configs.size(); i++) {
                 //cateogry: build time, library option name: test_name, time elapsed: all_build_times[i], avg num query points returned: 0 
                 std::cout << "build time, " << test_name << ", " << all_build_times[i] << ", 0";
-                print_config(all_configs[i]);    
+                print_config(all_configs[i], get_rank_perf_counters(all_counters, i));    
             }
         }          
     }
     else {
         std::cout << "build time, " << test_name << ", " << build_time_ns << ", 0";
-        print_config(config);           
+        print_config(config, counters);           
     }
+    record_sweep_sample("build time", test_name, config.num_data_pts, build_time_ns);
 
 }
 
-inline void print_query_time(double query_percent_data_covered, std::string test_name, 
-        std::chrono::high_resolution_clock::time_point query_start_time, double avg_perc_features_intersected, testing_config config) {
+//category: e.g., "query time " or "threaded query time " followed by the % of the data covered by the queries.
+//value is normally the elapsed time in ns, but is the number of queries per second for the "query throughput " category
+inline void print_query_result(const std::string &category, double query_percent_data_covered, const std::string &test_name, 
+        uint64_t value, double avg_perc_features_intersected, const testing_config &config, 
+        const perf_counter_values &counters = perf_counter_values()) {
 
-    std::chrono::high_resolution_clock::time_point query_stop_time = std::chrono::high_resolution_clock::now();
-    uint64_t query_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(query_stop_time - query_start_time).count();
     int num_procs, rank;
 
     if(USE_MPI) {
         MPI_Comm_rank(MPI_COMM_WORLD, &rank);    
         MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
         std::vector<testing_config> all_configs;
-        uint64_t all_query_times[num_procs];
+        uint64_t all_values[num_procs];
         double all_avg_perc_features_intersected[num_procs];
+        std::vector<uint64_t> all_counters(num_procs * NUM_PERF_COUNTERS);
 
-        MPI_Gather(&query_time_ns, 1, MPI_UINT64_T, all_query_times, 1, MPI_UINT64_T, 0, MPI_COMM_WORLD);
+        MPI_Gather(&value, 1, MPI_UINT64_T, all_values, 1, MPI_UINT64_T, 0, MPI_COMM_WORLD);
         MPI_Gather(&avg_perc_features_intersected, 1, MPI_DOUBLE, all_avg_perc_features_intersected, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+        MPI_Gather(counters.values, NUM_PERF_COUNTERS, MPI_UINT64_T, all_counters.data(), NUM_PERF_COUNTERS, MPI_UINT64_T, 0, MPI_COMM_WORLD);
 
         gatherv_ser_and_combine(config, num_procs, rank, MPI_COMM_WORLD, all_configs);
         if(rank == 0) {
             for(int i = 0; i < all_configs.size(); i++) {
                 //cateogry: query time + %data covered, library option name: test_name, time elapsed: query_time_ns, avg num query points returned: avg_num_intersected_data_pts
-                std::cout << "query time " << std::to_string(query_percent_data_covered) << ", " << test_name << ", " << all_query_times[i];
+                std::cout << category << std::to_string(query_percent_data_covered) << ", " << test_name << ", " << all_values[i];
                 std::cout << ", " << all_avg_perc_features_intersected[i];  
-                print_config(all_configs[i]);    
+                print_config(all_configs[i], get_rank_perf_counters(all_counters, i));    
             }
         }        
     }
     else {
-        std::cout << "query time " << std::to_string(query_percent_data_covered) << ", " << test_name << ", " << query_time_ns;
+        std::cout << category << std::to_string(query_percent_data_covered) << ", " << test_name << ", " << value;
         std::cout << ", " << avg_perc_features_intersected;
-        print_config(config);         
+        print_config(config, counters);         
     }
+    if(category.find("query time") != std::string::npos) {
+        record_sweep_sample(category + std::to_string(query_percent_data_covered), test_name, config.num_data_pts, value);
+    }
+}
+
+inline void print_query_time(double query_percent_data_covered, std::string test_name, 
+        std::chrono::high_resolution_clock::time_point query_start_time, double avg_perc_features_intersected, testing_config config,
+        const perf_counter_values &counters = perf_counter_values()) {
+
+    std::chrono::high_resolution_clock::time_point query_stop_time = std::chrono::high_resolution_clock::now();
+    uint64_t query_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(query_stop_time - query_start_time).count();
+    print_query_result("query time ", query_percent_data_covered, test_name, query_time_ns, avg_perc_features_intersected, config, counters);
 }
 
 
@@ -216,8 +317,16 @@ void print_point(const std::vector<T> &pt, bool suppress_newline = false) {
     }
 }
 
+template <class T, size_t N>
+void print_point(const std::array<T, N> &pt, bool suppress_newline = false) {
+    std::cout << "pt: (" << pt[0] << ", " << pt[1] << ", " << pt[2] << ")";
+    if(!suppress_newline) {
+        std::cout << std::endl; 
+    }
+}
+
 template <class T>
-void print_bbox(const std::pair<std::vector<T>,std::vector<T>> &box, bool suppress_newline = false) {
+void print_bbox(const std::pair<T,T> &box, bool suppress_newline = false) {
     std::cout << "bbox: (" << box.first[0] << ", " << box.first[1] << ", " << box.first[2] << ")-(" << 
                          box.second[0] << ", " << box.second[1] << ", " << box.second[2] << ")";
 
@@ -243,30 +352,103 @@ static void print_data(const std::vector<point> &pts, size_t index, DataType dat
     }
 }
 
+//how many points make up one item: a point, a bbox's two corners, or a triangle's three vertices
+inline size_t get_pts_per_item(DataType data_type) {
+    return (data_type == TRIANGLES) ? 3 : ((data_type == BBOXES) ? 2 : 1);
+}
 
+//the bounding box of the item. degenerate for points
+inline bbox get_item_bbox(DataType data_type, const std::vector<point> &pts, size_t index) {
+    size_t pts_per_item = get_pts_per_item(data_type);
+    bbox item_bbox(pts[pts_per_item*index], pts[pts_per_item*index + pts_per_item - 1]);
+    if(data_type == TRIANGLES) {
+        for(size_t k = 0; k < pts_per_item; k++) {
+            for(int d = 0; d < NUM_DIMS; d++) {
+                item_bbox.first[d] = std::min(item_bbox.first[d], pts[pts_per_item*index + k][d]);
+                item_bbox.second[d] = std::max(item_bbox.second[d], pts[pts_per_item*index + k][d]);
+            }
+        }
+    }
+    return item_bbox;
+}
+
+
+
+//the closest T that is <= (or >= for round_up) the double value. the identity when T is double
+template <class T>
+T round_down(double value) {
+    T rounded = (T)value;
+    if(rounded > value) {
+        rounded = std::nextafter(rounded, -std::numeric_limits<T>::infinity());
+    }
+    return rounded;
+}
+
+template <class T>
+T round_up(double value) {
+    T rounded = (T)value;
+    if(rounded < value) {
+        rounded = std::nextafter(rounded, std::numeric_limits<T>::infinity());
+    }
+    return rounded;
+}
+
+//rounds the box outward so it contains the original box. since rounding the data to nearest is monotonic, 
+//searching reduced precision data with this box returns a superset of the exact (double precision) results
+template <class T>
+scalar_bbox<T> round_bbox_outward(const bbox &my_bbox) {
+    scalar_bbox<T> rounded_bbox;
+    for(int i = 0; i < NUM_DIMS; i++) {
+        rounded_bbox.first[i] = round_down<T>(my_bbox.first[i]);
+        rounded_bbox.second[i] = round_up<T>(my_bbox.second[i]);
+    }
+    return rounded_bbox;
+}
+
+template <class T>
+void convert_points(const std::vector<point> &pts, std::vector<scalar_point<T>> &converted_pts) {
+    converted_pts.resize(pts.size());
+    for(size_t i = 0; i < pts.size(); i++) {
+        for(int j = 0; j < NUM_DIMS; j++) {
+            converted_pts[i][j] = (T)pts[i][j];
+        }
+    }
+}
+
+//lets adapters that can reference the caller's data skip the copy in double precision runs
+inline const std::vector<point> &as_scalar_points(const std::vector<point> &pts, std::vector<point> &converted_pts) {
+    return pts;
+}
 
 template <class T>
-void get_max_squared_radius(const bbox &my_bbox, std::vector<T> &mid_pt, T &squared_radius_search_bound) {
+const std::vector<scalar_point<T>> &as_scalar_points(const std::vector<point> &pts, std::vector<scalar_point<T>> &converted_pts) {
+    convert_points(pts, converted_pts);
+    return converted_pts;
+}
+
+//mid_pt must already hold NUM_DIMS values (e.g., a point, point_f, or a std::vector sized to NUM_DIMS)
+template <class PointT, class T>
+void get_max_squared_radius(const bbox &my_bbox, PointT &mid_pt, T &squared_radius_search_bound) {
     squared_radius_search_bound = 0;
     for(int i = 0; i < my_bbox.first.size(); i++) {
-        mid_pt.push_back((my_bbox.first[i] + my_bbox.second[i]) / 2);
-        squared_radius_search_bound += ( pow((mid_pt.back()-my_bbox.first[i]),2));
+        mid_pt[i] = (my_bbox.first[i] + my_bbox.second[i]) / 2;
+        squared_radius_search_bound += ( pow((mid_pt[i]-my_bbox.first[i]),2));
     }
 
 }
 
-template <class T>
-void get_max_radius(const bbox &my_bbox, std::vector<T> &mid_pt, T &squared_radius_search_bound) {
+template <class PointT, class T>
+void get_max_radius(const bbox &my_bbox, PointT &mid_pt, T &squared_radius_search_bound) {
     get_max_squared_radius(my_bbox, mid_pt, squared_radius_search_bound);
     squared_radius_search_bound = sqrt(squared_radius_search_bound);
 }
 
-template <class T>
-void get_manhattan_radius(const bbox &my_bbox, std::vector<T> &mid_pt, T &radius_search_bound) {
+template <class PointT, class T>
+void get_manhattan_radius(const bbox &my_bbox, PointT &mid_pt, T &radius_search_bound) {
     radius_search_bound = 0;
     for(int i = 0; i < my_bbox.first.size(); i++) {
-        mid_pt.push_back((my_bbox.first[i] + my_bbox.second[i]) / 2);
-        double diff = (my_bbox.second[i]-mid_pt.back());
+        mid_pt[i] = (my_bbox.first[i] + my_bbox.second[i]) / 2;
+        double diff = (my_bbox.second[i]-mid_pt[i]);
         if( diff > radius_search_bound) {
             radius_search_bound = diff;
         }
@@ -274,13 +456,128 @@ void get_manhattan_radius(const bbox &my_bbox, std::vector<T> &mid_pt, T &radius
 }
 
 
+//results for a batch of queries in compressed sparse row form. the results for query i are 
+//indices[offsets[i]] up to (but not including) indices[offsets[i+1]]
+struct batch_results {
+    std::vector<size_t> offsets;
+    std::vector<size_t> indices;
+
+    void clear() {
+        offsets.assign(1, 0);
+        indices.clear();
+    }
+
+    size_t num_queries() const { return offsets.empty() ? 0 : offsets.size()-1; }
+    size_t num_results(size_t query_index) const { return offsets[query_index+1] - offsets[query_index]; }
+    const size_t *results(size_t query_index) const { return indices.data() + offsets[query_index]; }
+};
+
+//each element's node ids in compressed sparse row form. the nodes of element i are
+//node_ids[offsets[i]] up to (but not including) node_ids[offsets[i+1]]. node ids start at 0
+struct element_connectivity {
+    std::vector<uint64_t> offsets = std::vector<uint64_t>(1, 0);
+    std::vector<uint32_t> node_ids;
+    //one more than the largest node id, so it can size arrays indexed by node id
+    uint32_t num_nodes = 0;
+    //the nodes' coordinates, indexed by node id. only kept for probe queries, which test the elements' exact shapes
+    std::vector<point> node_coords;
+
+    void clear() {
+        offsets.assign(1, 0);
+        node_ids.clear();
+        num_nodes = 0;
+        node_coords.clear();
+    }
+
+    size_t num_elements() const { return offsets.empty() ? 0 : offsets.size()-1; }
+    bool empty() const { return num_elements() == 0; }
+    const uint32_t *nodes_begin(size_t element_index) const { return node_ids.data() + offsets[element_index]; }
+    const uint32_t *nodes_end(size_t element_index) const { return node_ids.data() + offsets[element_index+1]; }
+};
+
+//libraries that return results in a dense (num queries x num data points) buffer have to split large batches up
+//so the buffer stays under this many entries
+#define MAX_DENSE_BATCH_RESULTS (size_t(1) << 26)
+
+inline size_t max_dense_batch_size(size_t num_data_pts) {
+    return std::max(size_t(1), MAX_DENSE_BATCH_RESULTS / std::max(size_t(1), num_data_pts));
+}
+
+//receives a query's results one at a time, so libraries that hand back results as they find them 
+//don't have to materialize them into a vector first
+class ResultSink {
+    public:
+        virtual ~ResultSink() {}
+        virtual void push(size_t index) = 0;
+        //a run of results at once, for libraries that find whole ranges (or blocks) of results together
+        virtual void push_range(const size_t *indices, size_t num_indices) {
+            for(size_t i = 0; i < num_indices; i++) {
+                push(indices[i]);
+            }
+        }
+};
+
+//appends every result to a vector, like get_intersections
+class VectorSink : public ResultSink {
+    private:
+        std::vector<size_t> &intersections_indices;
+    public:
+        VectorSink(std::vector<size_t> &indices) : intersections_indices(indices) {}
+        void push(size_t index) { intersections_indices.push_back(index); }
+        void push_range(const size_t *indices, size_t num_indices) { intersections_indices.insert(intersections_indices.end(), indices, indices + num_indices); }
+};
+
+//only counts the results and never allocates. used to separate the cost of traversing the tree from the cost of storing the results
+class CountSink : public ResultSink {
+    public:
+        size_t count = 0;
+        void push(size_t index) { count++; }
+        void push_range(const size_t *indices, size_t num_indices) { count += num_indices; }
+};
+
 class BboxIntersectionTest {
     public:
+        //the tests are deleted through this interface, so the libraries' destructors have to run from here
+        virtual ~BboxIntersectionTest() {}
+
         virtual bool intersections_exact() = 0;
 
         //can't templatize pure virtual functions
         virtual void build_tree(const std::vector<point> &pts, const std::vector<size_t> &indices) = 0;
         virtual void get_intersections(const bbox &my_bbox, std::vector<size_t> &intersections_indices) = 0;
+
+        //whether get_intersections can be called from several threads at once on the same tree. 
+        //libraries that keep per-query state inside the tree have to override this
+        virtual bool concurrent_queries_safe() { return true; }
+
+        //pushes each result into sink. by default the results are materialized by get_intersections first, 
+        //so only libraries that override this give a true picture of their traversal cost in count only mode
+        virtual void visit_intersections(const bbox &my_bbox, ResultSink &sink) {
+            std::vector<size_t> intersections_indices;
+            get_intersections(my_bbox, intersections_indices);
+            for(size_t index : intersections_indices) {
+                sink.push(index);
+            }
+        }
+
+        //whether visit_intersections hands results to the sink without materializing them first
+        virtual bool visits_natively() { return false; }
+
+        //the total number of tree nodes the queries have visited so far, for libraries that count them
+        virtual bool counts_nodes_visited() { return false; }
+        virtual uint64_t get_num_nodes_visited() { return 0; }
+
+        //issues num_queries queries at once and appends their results to results, which must start out cleared.
+        //by default this just loops over get_intersections. libraries that can search for many queries in one call override it
+        virtual void get_intersections_batch(const bbox *queries, size_t num_queries, batch_results &results) {
+            std::vector<size_t> query_result_indices;
+            for(size_t i = 0; i < num_queries; i++) {
+                query_result_indices.clear();
+                get_intersections(queries[i], query_result_indices);
+                results.indices.insert(results.indices.end(), query_result_indices.begin(), query_result_indices.end());
+                results.offsets.push_back(results.indices.size());
+            }
+        }
 };
 
 
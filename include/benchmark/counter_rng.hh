@@ -0,0 +1,31 @@
+#ifndef COUNTER_RNG_HH
+#define COUNTER_RNG_HH
+
+#include <cstdint>
+#include <cmath>
+
+//counter-based random numbers: the value for (seed, counter) is a hash of the two, so there is no generator state to share.
+//item i of a data set can draw from its own counters (e.g., i*draws_per_item + k), which makes parallel generation
+//reproducible no matter how the items are split across threads or ranks.
+//the hash is splitmix64's finalizer, which passes BigCrush when fed a counter
+inline uint64_t counter_rng(uint64_t seed, uint64_t counter) {
+    uint64_t z = seed + (counter + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+//uniform in [0, 1), using the top 53 bits
+inline double counter_rng_uniform(uint64_t seed, uint64_t counter) {
+    return (counter_rng(seed, counter) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+//standard normal via box-muller. uses counter and counter+1
+inline double counter_rng_normal(uint64_t seed, uint64_t counter) {
+    //1 - u keeps the log's argument in (0, 1]
+    double u1 = 1.0 - counter_rng_uniform(seed, counter);
+    double u2 = counter_rng_uniform(seed, counter + 1);
+    return std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * M_PI * u2);
+}
+
+#endif //COUNTER_RNG_HH
@@ -4,12 +4,25 @@
 #include "common.hh"
 
 void get_queries_specific_feature_sizes(testing_config config, std::vector<std::vector<bbox>> &all_queries, std::vector<double> &queries_percent_data_covered);
+//num_selectivities percentages of the data, log spaced from min_percent to max_percent
+std::vector<double> get_log_spaced_selectivities(double min_percent, double max_percent, size_t num_selectivities);
+//parses "min_percent:max_percent:num_selectivities" into log spaced selectivities. returns false if it is malformed
+bool parse_selectivity_range(const std::string &range, std::vector<double> &selectivities);
+//a category of queries for each of config.query_selectivities (a % of the data). each query is centred on a random data item and 
+//sized so it intersects that % of a sample of the data. the selectivity actually achieved on the full data is reported by perform_queries
+void get_queries_calibrated_selectivity(testing_config config, const std::vector<point> &pts, 
+    std::vector<std::vector<bbox>> &all_queries, std::vector<double> &queries_percent_data_covered);
+//moves each category's queries (keeping their sizes) to the placement of config.query_set. does nothing for UNIFORM_QUERIES
+void apply_query_set(testing_config config, std::vector<std::vector<bbox>> &all_queries);
 void get_queries_random_feature_sizes(testing_config config, std::vector<bbox> &queries);
 void get_small_queries(std::vector<bbox> &queries);
-void get_random_data(testing_config config, std::vector<point> &pts, std::vector<size_t> &indices);
+template <class T>
+void get_random_data(testing_config config, std::vector<scalar_point<T>> &pts, std::vector<size_t> &indices);
 void get_regular_mesh_data(testing_config config);
+//the elements' bboxes, or for TRIANGLES the triangles of the mesh's skin (its boundary faces, with quads split in two).
+//keep_element_geometry also keeps the elements' connectivity (even if the nodes aren't retrieved) and the node coordinates, for probe queries
 void get_data_from_exodus_file(DataType data_type, const std::string &full_file_path, std::vector<point> &mesh_coords, bbox &domain_bounds, 
-    uint32_t &num_data_pts, std::vector<std::vector<size_t>> &node_ids_per_elem);
+    uint32_t &num_data_pts, bool retrieve_nodes, element_connectivity &connectivity, bool keep_element_geometry = false);
 void get_data_from_exodus_file(DataType data_type, const std::string &full_file_path, std::vector<point> &mesh_coords, bbox &domain_bounds, 
     uint32_t &num_data_pts);
 #endif //DATA_AND_QUERY_GENERATION_HH
\ No newline at end of file
@@ -0,0 +1,46 @@
+#ifndef ELEMENT_CONTAINMENT_HH
+#define ELEMENT_CONTAINMENT_HH
+
+#include "common.hh"
+
+//exact point in element tests for probe queries. hex8 elements are inverted through their trilinear map (with newton's method) and
+//tet4 elements through their barycentric coordinates. each element's coefficients are precomputed as structure-of-arrays, so the avx2
+//kernel tests 4 candidates at once. elements of any other type (by their number of nodes), or degenerate tets, never contain a probe
+class ElementContainment {
+    public:
+        //needs the connectivity's node coordinates. uses the avx2 kernel unless use_avx2 is false or the cpu doesn't support it
+        ElementContainment(const element_connectivity &connectivity, bool use_avx2 = true);
+
+        bool uses_avx2() const { return avx2; }
+        size_t num_unsupported_elements() const { return num_unsupported; }
+
+        //writes the candidates (element indices) that contain the probe to out, which may be candidates, and returns how many there are.
+        //they aren't necessarily in the candidates' order. not thread safe, since it reuses scratch space
+        size_t contains(const point &probe, const size_t *candidates, size_t num_candidates, size_t *out);
+
+    private:
+        enum ElementShape : uint8_t {
+            UNSUPPORTED_ELEMENT,
+            HEX8_ELEMENT,
+            TET4_ELEMENT
+        };
+
+        bool avx2 = false;
+        size_t num_unsupported = 0;
+        std::vector<uint8_t> shapes;
+        //each element's index into its shape's coefficient arrays
+        std::vector<uint32_t> shape_indices;
+        //x(u, v, w) = c0 + c1 u + c2 v + c3 w + c4 uv + c5 vw + c6 uw + c7 uvw, for (u, v, w) in [0, 1]^3
+        std::vector<double> hex_coeffs[8][NUM_DIMS];
+        //the first node, then the rows of the inverse of the edge matrix, which map (x - first node) to 3 of the barycentric coordinates
+        std::vector<double> tet_coeffs[4][NUM_DIMS];
+        //the candidates split by shape. they keep their capacity, so contains doesn't allocate once they have grown
+        std::vector<size_t> hex_candidates;
+        std::vector<size_t> tet_candidates;
+};
+
+//num_probes points, each inside a random element of the connectivity (hex8 and tet4 elements are sampled uniformly in their 
+//parametric/barycentric coordinates, other elements give the average of their nodes). needs the connectivity's node coordinates
+void get_probe_points(size_t num_probes, const element_connectivity &connectivity, std::vector<point> &probes);
+
+#endif //ELEMENT_CONTAINMENT_HH
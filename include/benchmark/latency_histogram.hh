@@ -0,0 +1,76 @@
+#ifndef LATENCY_HISTOGRAM_HH
+#define LATENCY_HISTOGRAM_HH
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "testing_configurations.hh"
+
+//HDR-style histogram of per-query latencies (in ns). values below SUB_BUCKET_COUNT are recorded exactly. above that, each power of two
+//is split into SUB_BUCKET_COUNT/2 linear sub buckets, so a reported value is never more than 1/64 (~1.6%) above the recorded one.
+//the bucket layout is fixed, so histograms from different ranks can be merged by summing their counts
+class LatencyHistogram {
+    public:
+        static const int SUB_BUCKET_BITS = 7;
+        static const uint64_t SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+        static const uint64_t HALF_SUB_BUCKET_COUNT = SUB_BUCKET_COUNT / 2;
+        //enough buckets to hold any uint64_t
+        static const size_t NUM_BUCKETS = SUB_BUCKET_COUNT + (64 - SUB_BUCKET_BITS) * HALF_SUB_BUCKET_COUNT;
+
+        LatencyHistogram() : counts(NUM_BUCKETS, 0) {}
+
+        void record(uint64_t value_ns);
+        void clear();
+
+        uint64_t total_count() const { return num_values; }
+        uint64_t max() const { return max_value; }
+
+        //the smallest recorded value (up to the bucket resolution) that at least percentile % of the values are less than or equal to
+        uint64_t value_at_percentile(double percentile) const;
+
+        //sums the counts of every rank's histogram onto rank 0's. every rank must call this
+        void merge_onto_rank_0();
+
+    private:
+        std::vector<uint64_t> counts;
+        uint64_t num_values = 0;
+        uint64_t max_value = 0;
+
+        static size_t bucket_index(uint64_t value);
+        static uint64_t highest_equivalent_value(size_t index);
+};
+
+//measures each query's latency with a steady_clock read at its start and one at its end, so whatever the harness does between
+//queries (counting allocations, recording a trace, replay waits) is in neither the latency nor the category's time. the cost of
+//reading the clock is calibrated once at startup and subtracted from every latency
+class QueryTimer {
+    public:
+        //takes the minimum over many back to back clock reads, so call it before any of the tests run
+        static void calibrate();
+        static uint64_t overhead_ns();
+
+        void start() { start_time = std::chrono::steady_clock::now(); }
+
+        //returns the latency of the query since start
+        uint64_t stop() {
+            stop_time = std::chrono::steady_clock::now();
+            uint64_t elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(stop_time - start_time).count();
+            uint64_t overhead = overhead_ns();
+            return (elapsed_ns > overhead) ? elapsed_ns - overhead : 0;
+        }
+
+        std::chrono::steady_clock::time_point get_start_time() const { return start_time; }
+        std::chrono::steady_clock::time_point get_stop_time() const { return stop_time; }
+
+    private:
+        std::chrono::steady_clock::time_point start_time;
+        std::chrono::steady_clock::time_point stop_time;
+};
+
+//prints p50, p90, p99, p99.9 and max rows for one category of queries. if using MPI, the histograms are first merged across all ranks
+//and rank 0 prints one set of rows for the whole job (with rank 0's config and the average of every rank's avg perc intersected)
+void print_query_latencies(double query_percent_data_covered, const std::string &test_name, LatencyHistogram &histogram,
+    double avg_perc_features_intersected, const testing_config &config);
+
+#endif //LATENCY_HISTOGRAM_HH
@@ -0,0 +1,24 @@
+#ifndef MESH_SNAPSHOT_HH
+#define MESH_SNAPSHOT_HH
+
+#include "common.hh"
+
+//binary cache of the data decoded from an exodus file (the points or element bboxes, the domain bounds, the number of data points
+//and the element connectivity), so later runs on the same partition skip ex_get_coord/ex_get_conn and the bbox construction.
+//bump the version whenever the layout changes. snapshots with another version, or whose exodus file has since changed, are ignored
+const uint32_t MESH_SNAPSHOT_VERSION = 2;
+
+//the snapshot lives next to the exodus file, one per data type
+std::string get_mesh_snapshot_path(const std::string &mesh_file_path, DataType data_type);
+
+//maps the snapshot and copies its contents out. returns false (without printing anything) if there is no usable snapshot.
+//a snapshot is only used by runs with the same retrieve_nodes setting, since it changes num_data_pts.
+//connectivity can be nullptr if it isn't needed
+bool read_mesh_snapshot(const std::string &snapshot_path, const std::string &mesh_file_path, DataType data_type,
+    bool retrieve_nodes, std::vector<point> &mesh_coords, bbox &domain_bounds, uint32_t &num_data_pts, element_connectivity *connectivity);
+
+//writes to a temporary file and renames it into place, so a concurrent reader never sees a partial snapshot. returns false on failure
+bool write_mesh_snapshot(const std::string &snapshot_path, const std::string &mesh_file_path, DataType data_type,
+    bool retrieve_nodes, const std::vector<point> &mesh_coords, const bbox &domain_bounds, uint32_t num_data_pts, const element_connectivity *connectivity);
+
+#endif //MESH_SNAPSHOT_HH
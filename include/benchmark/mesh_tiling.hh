@@ -0,0 +1,20 @@
+#ifndef MESH_TILING_HH
+#define MESH_TILING_HH
+
+#include "common.hh"
+
+//the tiling spec is either "kxlxm" (e.g., "2x2x4") for that many copies along x, y and z, or a number of data points, in which case
+//the copies are added one dimension at a time (x, then y, then z, ...) until there are at least that many data points.
+//num_base_data_pts is the number of data points in the untiled mesh. returns false if the spec is malformed, if the number
+//of tiles overflows, or if a mesh without data points would have to be tiled to reach a number of data points
+bool parse_mesh_tiling(const std::string &spec, size_t num_base_data_pts, size_t tiles[NUM_DIMS]);
+
+//replaces the mesh with tiles[0] x tiles[1] x tiles[2] copies of itself, each offset by a multiple of the domain's extent,
+//so the data grows while keeping the mesh's local structure. the connectivity's node ids are offset to each copy's nodes.
+//if jitter > 0, every point (or bbox, as a whole) is then moved by a uniformly random offset of up to jitter times
+//the mean spacing between data points in each dimension, so the copies aren't exact duplicates of each other.
+//num_data_pts and domain_bounds are updated to match
+void tile_mesh(DataType data_type, const size_t tiles[NUM_DIMS], double jitter, std::vector<point> &pts, bbox &domain_bounds,
+    uint32_t &num_data_pts, element_connectivity &connectivity);
+
+#endif //MESH_TILING_HH
@@ -0,0 +1,59 @@
+#ifndef PERF_COUNTERS_HH
+#define PERF_COUNTERS_HH
+
+#include <cstdint>
+#include <limits>
+
+enum PerfCounterType : unsigned short {
+    CYCLES,
+    INSTRUCTIONS,
+    L1D_MISSES,
+    LLC_MISSES,
+    DTLB_MISSES,
+    BRANCH_MISSES,
+    PAGE_FAULTS,
+    NUM_PERF_COUNTERS
+};
+
+//column names for the header, in PerfCounterType order
+extern const char *PERF_COUNTER_NAMES[NUM_PERF_COUNTERS];
+
+//stored in place of a value when the counter couldn't be opened (e.g., no PMU access in a VM, or a restrictive perf_event_paranoid)
+const uint64_t PERF_COUNTER_UNAVAILABLE = std::numeric_limits<uint64_t>::max();
+
+struct perf_counter_values {
+    uint64_t values[NUM_PERF_COUNTERS];
+
+    perf_counter_values() {
+        for(int i = 0; i < NUM_PERF_COUNTERS; i++) {
+            values[i] = PERF_COUNTER_UNAVAILABLE;
+        }
+    }
+};
+
+//hardware and software counters for the calling thread (via perf_event_open), so they only cover serial work.
+//each counter is opened separately, so if some of them are unavailable the rest are still reported
+class PerfCounters {
+    public:
+        PerfCounters();
+        ~PerfCounters();
+
+        //resets every counter that could be opened to 0 and starts counting. the counters are opened on the first call
+        void start();
+        //stops counting and returns what was counted since start, scaled up if the kernel had to multiplex the counters
+        perf_counter_values stop();
+        //stop and restart counting without resetting the counts, to leave work between start and stop out of them
+        void pause();
+        void resume();
+
+    private:
+        int fds[NUM_PERF_COUNTERS];
+        bool opened = false;
+
+        void open_counters();
+};
+
+//the counters put around tree building and each category of queries
+PerfCounters &phase_perf_counters();
+
+#endif //PERF_COUNTERS_HH
@@ -5,6 +5,6 @@
 
 void perform_queries(BboxIntersectionTest *test, const std::string &test_name,
     const std::vector<point> &pts, const std::vector<size_t> &indices, testing_config config, QueryType query_type=STANDARD,
-    const std::vector<std::vector<size_t>> &element_node_ids = std::vector<std::vector<size_t>>());
+    const element_connectivity &element_node_ids = element_connectivity());
 
 #endif //PERFORM_QUERIES
\ No newline at end of file
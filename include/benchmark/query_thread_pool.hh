@@ -0,0 +1,55 @@
+#ifndef QUERY_THREAD_POOL_HH
+#define QUERY_THREAD_POOL_HH
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//runs a batch of queries across a fixed set of threads that share one tree. each thread starts with a contiguous
+//block of the query indices and, once its own block is empty, steals queries from the back of the other threads' blocks.
+//this keeps every thread busy even when a few queries in a category are far more expensive than the rest
+class QueryThreadPool {
+    public:
+        //func(thread_id, query_index), where thread_id is in [0, num_threads)
+        typedef std::function<void(size_t, size_t)> query_func;
+
+        //the calling thread acts as thread 0, so only num_threads-1 threads are spawned
+        explicit QueryThreadPool(size_t num_threads);
+        ~QueryThreadPool();
+
+        size_t size() const { return num_threads; }
+
+        //blocks until func has been called exactly once for every query index in [0, num_queries)
+        void run(size_t num_queries, const query_func &func);
+
+    private:
+        //padded so the threads don't falsely share each other's locks
+        struct WorkQueue {
+            std::mutex lock;
+            std::deque<size_t> query_indices;
+            char padding[64];
+        };
+
+        size_t num_threads;
+        std::vector<std::thread> workers;
+        std::vector<std::unique_ptr<WorkQueue>> queues;
+
+        std::mutex job_lock;
+        std::condition_variable job_ready;
+        std::condition_variable job_done;
+        const query_func *job = nullptr;
+        size_t job_generation = 0;
+        size_t num_workers_done = 0;
+        bool shutting_down = false;
+
+        void worker_loop(size_t thread_id);
+        void process_queries(size_t thread_id, const query_func &func);
+        bool pop_own(size_t thread_id, size_t &query_index);
+        bool steal(size_t thread_id, size_t &query_index);
+};
+
+#endif //QUERY_THREAD_POOL_HH
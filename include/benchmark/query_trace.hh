@@ -0,0 +1,41 @@
+#ifndef QUERY_TRACE_HH
+#define QUERY_TRACE_HH
+
+#include "common.hh"
+
+//binary trace of a query stream: a small header followed by fixed size records, in the order the queries were issued.
+//bump the version whenever the layout changes
+const uint32_t QUERY_TRACE_VERSION = 1;
+
+struct query_trace_record {
+    //when the query was issued, relative to the start of the trace
+    uint64_t timestamp_ns;
+    //how long the client paused after the query returned before issuing its next one (used by closed loop replay).
+    //always 0 in the traces the benchmark records, since it doesn't model think time
+    uint64_t think_time_ns;
+    //the category the query is grouped into when it is replayed (e.g., the % of the data it was meant to cover)
+    double category;
+    double lower_corner[NUM_DIMS];
+    double upper_corner[NUM_DIMS];
+};
+
+//the trace for a rank: the path itself for a single rank, or the path with ".<rank>" appended
+std::string get_query_trace_path(const std::string &path, int rank, int comm_size);
+//the trace for one step of a subsample sweep, so each step records (or replays) its own trace
+std::string get_subsample_query_trace_path(const std::string &path, double subsample_percent);
+
+//returns false on failure
+bool write_query_trace(const std::string &path, const std::vector<query_trace_record> &records);
+//returns false (after printing why) if the trace can't be read or is from another version
+bool read_query_trace(const std::string &path, std::vector<query_trace_record> &records);
+
+//groups the records into one category of queries per distinct category value, in the order each category first appears.
+//each query keeps its record's index, so its timestamp and think time can be looked up while it is replayed
+void get_queries_from_trace(const std::vector<query_trace_record> &records, std::vector<std::vector<bbox>> &all_queries,
+    std::vector<double> &categories, std::vector<std::vector<size_t>> &record_indices);
+
+//every rank has to replay the same categories, with as many queries in each, or the per category collectives that print the results
+//won't line up (or will hang). trace_read is whether this rank read its trace. every rank must call this, and gets the same answer
+bool query_traces_match_across_ranks(bool trace_read, const std::vector<std::vector<bbox>> &all_queries, const std::vector<double> &categories);
+
+#endif //QUERY_TRACE_HH
@@ -4,6 +4,13 @@
 #include "common.hh"
 
 #include "all_libraries/brute_force_test.hh"
+#include "all_libraries/brute_force_simd_test.hh"
+#include "all_libraries/native_kdtree_test.hh"
+#include "all_libraries/native_rtree_test.hh"
+#include "all_libraries/uniform_grid_test.hh"
+#include "all_libraries/linear_octree_test.hh"
+#include "all_libraries/wide_bvh_test.hh"
+#include "all_libraries/triangles_test.hh"
 
 #ifdef TEST_3DTK
     #include "all_libraries/3dtk_test.hh"
@@ -0,0 +1,28 @@
+#ifndef SCALING_SWEEP_HH
+#define SCALING_SWEEP_HH
+
+#include "common.hh"
+
+//the sweep percents are a comma separated list of the percentages of the loaded data to test at (e.g., "1,2,5,10,20,50,100").
+//they are returned in increasing order. returns false if the list is malformed or a percentage isn't in (0, 100]
+bool parse_sweep_percents(const std::string &spec, std::vector<double> &percents);
+
+//an order of the items (points, or bboxes) such that every prefix of it is a subsample of the data, so the smaller
+//subsamples of a sweep are nested in the larger ones
+std::vector<size_t> get_subsample_order(SubsampleMode subsample_mode, DataType data_type, const std::vector<point> &pts, const bbox &domain_bounds);
+
+//copies the first num_items items of the order, kept in the order they were loaded in. if the nodes are retrieved for bboxes,
+//the subsample's connectivity keeps the original node ids and num_data_pts is the number of distinct nodes the subsample uses.
+//otherwise, num_data_pts is the number of items. the connectivity is also kept (with the node coordinates) for probe queries
+void get_subsample(DataType data_type, const std::vector<point> &pts, const std::vector<size_t> &order, size_t num_items,
+    bool retrieve_nodes, const element_connectivity &connectivity, std::vector<point> &subsample_pts, bbox &subsample_bounds,
+    uint32_t &num_data_pts, element_connectivity &subsample_connectivity);
+
+//while recording, every build time and query time row is also kept (see record_sweep_sample in common.hh)
+void start_sweep_recording();
+
+//for each library and timed category that was recorded, prints the least squares slope of log(time) against log(num data pts),
+//i.e., time ~ num_data_pts^exponent, then stops recording. the rows use the full data set's config
+void print_complexity_exponents(const testing_config &config);
+
+#endif //SCALING_SWEEP_HH
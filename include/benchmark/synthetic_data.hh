@@ -0,0 +1,22 @@
+#ifndef SYNTHETIC_DATA_HH
+#define SYNTHETIC_DATA_HH
+
+#include "common.hh"
+
+//seed for every synthetic data set, so runs are reproducible
+#define SYNTHETIC_DATA_SEED 100
+
+//generates num_data_pts points (or bboxes, as pairs of corner points) in [0, DOMAIN_LENGTH]^3 from the data source's distribution:
+//  UNIFORM_DATA: uniform over the domain
+//  GAUSSIAN_CLUSTERS: normally distributed around a handful of random centres
+//  POWER_LAW_DENSITY: density falling off as a power law away from one corner, like a graded mesh
+//  THIN_SHELLS: a thin spherical shell, like a surface mesh
+//  ANISOTROPIC_SLABS: a few thin, flat slabs
+//  DUPLICATE_COORDINATES: snapped to a coarse lattice, so most points share their coordinates with many others.
+//item i is drawn from counter_rng counters that only depend on first_item+i, so ranks generate disjoint parts of the same
+//global data set by passing their offset as first_item, and the result doesn't depend on the number of threads.
+//domain_bounds is set to the bounds of what was generated
+void get_synthetic_data(DataSource data_source, DataType data_type, size_t num_data_pts, uint64_t first_item,
+    std::vector<point> &pts, bbox &domain_bounds);
+
+#endif //SYNTHETIC_DATA_HH
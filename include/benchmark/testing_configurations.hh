@@ -2,6 +2,7 @@
 #define TEST_CONFIGURATIONS_HH
 
 #include <vector>
+#include <string>
 
 enum Library : unsigned short {
     ALGLIB = 0,
@@ -24,7 +25,12 @@ enum Library : unsigned short {
     PCL = 17,
     PICO_TREE = 18,
     RTREE_TEMPLATE = 19,
-    SPATIAL = 20 
+    SPATIAL = 20,
+    NATIVE_KDTREE = 21,
+    NATIVE_RTREE = 22,
+    UNIFORM_GRID = 23,
+    LINEAR_OCTREE = 24,
+    WIDE_BVH = 25
 };
 
 enum DataType : unsigned short {
@@ -33,6 +39,46 @@ enum DataType : unsigned short {
     TRIANGLES   
 };
 
+//where the benchmark's data comes from: the rank's exodus partition, or one of the synthetic generators
+enum DataSource : unsigned short {
+    EXODUS_MESH,
+    UNIFORM_DATA,
+    GAUSSIAN_CLUSTERS,
+    POWER_LAW_DENSITY,
+    THIN_SHELLS,
+    ANISOTROPIC_SLABS,
+    DUPLICATE_COORDINATES,
+    NUM_DATA_SOURCES
+};
+
+//record the queries that are issued to a trace, or replay a trace instead of generating queries.
+//closed loop replay issues each query as soon as the previous one (plus its think time) is done. timed replay issues each query at its timestamp
+enum QueryTraceMode : unsigned short {
+    NO_QUERY_TRACE,
+    RECORD_QUERY_TRACE,
+    REPLAY_QUERY_TRACE_CLOSED_LOOP,
+    REPLAY_QUERY_TRACE_TIMED
+};
+
+//where the queries of each category are placed. the categories' box sizes are the same either way
+enum QuerySet : unsigned short {
+    //independent, uniformly placed boxes
+    UNIFORM_QUERIES,
+    //boxes around a few hotspots, picked with a zipf distribution and shifted slightly each time
+    HOTSPOT_QUERIES,
+    //each box is the previous one panned by a small random step
+    RANDOM_WALK_QUERIES
+};
+
+//how a dataset size sweep picks its nested subsamples of the loaded data
+enum SubsampleMode : unsigned short {
+    NO_SUBSAMPLE_SWEEP,
+    //a random subset of the items
+    RANDOM_SUBSAMPLES,
+    //a prefix of the items in morton order, so each subsample is a compact region that grows with the size
+    SPATIAL_SUBSAMPLES
+};
+
 enum QueryType : unsigned short {
     STANDARD,
     GPU_DOMAIN_DECOMP
@@ -46,9 +92,32 @@ struct testing_config {
     Library library;
     DataType data_type;
     short unsigned library_option;
+    //number of threads sharing the tree when issuing queries. 1 means queries are only issued serially
+    size_t num_threads = 1;
+    //largest batch size to sweep up to when issuing queries through get_intersections_batch. 0 means no batched queries are issued
+    size_t max_batch_size = 0;
+    //additionally issue each category through visit_intersections with a sink that only counts the results
+    bool count_only_queries = false;
+    //adds hardware/software performance counter columns for tree building and the serial run of each query category
+    bool use_perf_counters = false;
+    //for bboxes, count the distinct nodes of the intersected elements instead of the elements themselves (for node-based computation).
+    //num_data_pts is then the number of nodes
+    bool retrieve_nodes_for_bboxes = false;
+    //if not empty, the query categories are sized to cover these percentages of the data instead of the fixed feature sizes
+    std::vector<double> query_selectivities;
+    QueryTraceMode query_trace_mode = NO_QUERY_TRACE;
+    //this rank's trace file
+    std::string query_trace_path;
+    QuerySet query_set = UNIFORM_QUERIES;
+    //for random walk queries, the fraction of each box's volume that overlaps the previous box
+    double query_overlap = .9;
+    //for bboxes from an exodus mesh, the number of probe points to locate in the elements (bbox candidates, then exact containment). 
+    //0 means no probe queries are issued
+    size_t num_probe_queries = 0;
 
     testing_config(const std::vector<double> &domain_lower_bnds, const std::vector<double> &domain_upper_bnds, 
-        size_t n_data_pts, size_t n_queries, Library lib, DataType d_type, short unsigned lib_option
+        size_t n_data_pts, size_t n_queries, Library lib, DataType d_type, short unsigned lib_option, size_t n_threads = 1,
+        size_t max_batch_sz = 0, bool count_only = false, bool perf_counters = false, bool retrieve_nodes = false
         ) 
     {
         domain_lower_bounds = domain_lower_bnds;
@@ -58,6 +127,11 @@ struct testing_config {
         library = lib;
         data_type = d_type;
         library_option = lib_option;
+        num_threads = n_threads;
+        max_batch_size = max_batch_sz;
+        count_only_queries = count_only;
+        use_perf_counters = perf_counters;
+        retrieve_nodes_for_bboxes = retrieve_nodes;
     }
 
     testing_config() { 
@@ -74,6 +148,17 @@ struct testing_config {
         ar & library;
         ar & data_type;
         ar & library_option;
+        ar & num_threads;
+        ar & max_batch_size;
+        ar & count_only_queries;
+        ar & use_perf_counters;
+        ar & retrieve_nodes_for_bboxes;
+        ar & query_selectivities;
+        ar & query_trace_mode;
+        ar & query_trace_path;
+        ar & query_set;
+        ar & query_overlap;
+        ar & num_probe_queries;
     }
 };
 
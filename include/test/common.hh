@@ -3,9 +3,13 @@
 #define COMMON_HH
 
 #include <vector>
+#include <array>
+#include <algorithm>
 #include <iostream>
 #include <chrono> /* high resolution clock */
 #include <math.h>       /* pow */
+#include <cmath>        /* nextafter */
+#include <limits>
 
 #define NUM_DIMS 3
 #define NUM_ELEMS_PER_NODE 20
@@ -13,12 +17,16 @@
 #define DEFAULT_TOLERANCE .00001
 #define DEFAULT_LARGE_TOLERANCE .0001
 
-typedef std::vector<double> point;
+//fixed-size points, so a std::vector<point> is one contiguous (x,y,z,x,y,z,...) coordinate buffer with no per-point heap allocation
+template <class T> using scalar_point = std::array<T, NUM_DIMS>;
+template <class T> using scalar_bbox = std::pair<scalar_point<T>, scalar_point<T>>;
+
+typedef scalar_point<double> point;
 typedef std::pair<point, size_t> point_w_index;
-typedef std::pair<point, point> bbox;
+typedef scalar_bbox<double> bbox;
 typedef std::pair<bbox, size_t> bbox_w_index;
 
-typedef std::vector<float> point_f; // flann with CUDA only supports floats
+typedef scalar_point<float> point_f; // flann with CUDA only supports floats
 typedef std::pair<point_f, size_t> point_w_index_f;
 typedef std::pair<point_f, point_f> bbox_f;
 typedef std::pair<bbox_f, point_f> bbox_w_index_f;
@@ -40,8 +48,16 @@ void print_point(const std::vector<T> &pt, bool suppress_newline = false) {
     }
 }
 
+template <class T, size_t N>
+void print_point(const std::array<T, N> &pt, bool suppress_newline = false) {
+    std::cout << "pt: (" << pt[0] << ", " << pt[1] << ", " << pt[2] << ")";
+    if(!suppress_newline) {
+        std::cout << std::endl; 
+    }
+}
+
 template <class T>
-void print_bbox(const std::pair<std::vector<T>,std::vector<T>> &box, bool suppress_newline = false) {
+void print_bbox(const std::pair<T,T> &box, bool suppress_newline = false) {
     std::cout << "bbox: (" << box.first[0] << ", " << box.first[1] << ", " << box.first[2] << ")-(" << 
                          box.second[0] << ", " << box.second[1] << ", " << box.second[2] << ")";
 
@@ -50,28 +66,81 @@ void print_bbox(const std::pair<std::vector<T>,std::vector<T>> &box, bool suppre
     }
 }
 
+//the closest T that is <= (or >= for round_up) the double value. the identity when T is double
+template <class T>
+T round_down(double value) {
+    T rounded = (T)value;
+    if(rounded > value) {
+        rounded = std::nextafter(rounded, -std::numeric_limits<T>::infinity());
+    }
+    return rounded;
+}
+
+template <class T>
+T round_up(double value) {
+    T rounded = (T)value;
+    if(rounded < value) {
+        rounded = std::nextafter(rounded, std::numeric_limits<T>::infinity());
+    }
+    return rounded;
+}
+
+//rounds the box outward so it contains the original box. since rounding the data to nearest is monotonic, 
+//searching reduced precision data with this box returns a superset of the exact (double precision) results
 template <class T>
-void get_max_squared_radius(const bbox &my_bbox, std::vector<T> &mid_pt, T &squared_radius_search_bound) {
+scalar_bbox<T> round_bbox_outward(const bbox &my_bbox) {
+    scalar_bbox<T> rounded_bbox;
+    for(int i = 0; i < NUM_DIMS; i++) {
+        rounded_bbox.first[i] = round_down<T>(my_bbox.first[i]);
+        rounded_bbox.second[i] = round_up<T>(my_bbox.second[i]);
+    }
+    return rounded_bbox;
+}
+
+template <class T>
+void convert_points(const std::vector<point> &pts, std::vector<scalar_point<T>> &converted_pts) {
+    converted_pts.resize(pts.size());
+    for(size_t i = 0; i < pts.size(); i++) {
+        for(int j = 0; j < NUM_DIMS; j++) {
+            converted_pts[i][j] = (T)pts[i][j];
+        }
+    }
+}
+
+//lets adapters that can reference the caller's data skip the copy in double precision runs
+inline const std::vector<point> &as_scalar_points(const std::vector<point> &pts, std::vector<point> &converted_pts) {
+    return pts;
+}
+
+template <class T>
+const std::vector<scalar_point<T>> &as_scalar_points(const std::vector<point> &pts, std::vector<scalar_point<T>> &converted_pts) {
+    convert_points(pts, converted_pts);
+    return converted_pts;
+}
+
+//mid_pt must already hold NUM_DIMS values (e.g., a point, point_f, or a std::vector sized to NUM_DIMS)
+template <class PointT, class T>
+void get_max_squared_radius(const bbox &my_bbox, PointT &mid_pt, T &squared_radius_search_bound) {
     squared_radius_search_bound = 0;
     for(int i = 0; i < my_bbox.first.size(); i++) {
-        mid_pt.push_back((my_bbox.first[i] + my_bbox.second[i]) / 2);
-        squared_radius_search_bound += ( pow((mid_pt.back()-my_bbox.first[i]),2));
+        mid_pt[i] = (my_bbox.first[i] + my_bbox.second[i]) / 2;
+        squared_radius_search_bound += ( pow((mid_pt[i]-my_bbox.first[i]),2));
     }
 
 }
 
-template <class T>
-void get_max_radius(const bbox &my_bbox, std::vector<T> &mid_pt, T &squared_radius_search_bound) {
+template <class PointT, class T>
+void get_max_radius(const bbox &my_bbox, PointT &mid_pt, T &squared_radius_search_bound) {
     get_max_squared_radius(my_bbox, mid_pt, squared_radius_search_bound);
     squared_radius_search_bound = sqrt(squared_radius_search_bound);
 }
 
-template <class T>
-void get_manhattan_radius(const bbox &my_bbox, std::vector<T> &mid_pt, T &radius_search_bound) {
+template <class PointT, class T>
+void get_manhattan_radius(const bbox &my_bbox, PointT &mid_pt, T &radius_search_bound) {
     radius_search_bound = 0;
     for(int i = 0; i < my_bbox.first.size(); i++) {
-        mid_pt.push_back((my_bbox.first[i] + my_bbox.second[i]) / 2);
-        double diff = (my_bbox.second[i]-mid_pt.back());
+        mid_pt[i] = (my_bbox.first[i] + my_bbox.second[i]) / 2;
+        double diff = (my_bbox.second[i]-mid_pt[i]);
         if( diff > radius_search_bound) {
             radius_search_bound = diff;
         }
@@ -79,11 +148,125 @@ void get_manhattan_radius(const bbox &my_bbox, std::vector<T> &mid_pt, T &radius
 }
 
 
+//results for a batch of queries in compressed sparse row form. the results for query i are 
+//indices[offsets[i]] up to (but not including) indices[offsets[i+1]]
+struct batch_results {
+    std::vector<size_t> offsets;
+    std::vector<size_t> indices;
+
+    void clear() {
+        offsets.assign(1, 0);
+        indices.clear();
+    }
+
+    size_t num_queries() const { return offsets.empty() ? 0 : offsets.size()-1; }
+    size_t num_results(size_t query_index) const { return offsets[query_index+1] - offsets[query_index]; }
+    const size_t *results(size_t query_index) const { return indices.data() + offsets[query_index]; }
+};
+
+//each element's node ids in compressed sparse row form. the nodes of element i are
+//node_ids[offsets[i]] up to (but not including) node_ids[offsets[i+1]]. node ids start at 0
+struct element_connectivity {
+    std::vector<uint64_t> offsets = std::vector<uint64_t>(1, 0);
+    std::vector<uint32_t> node_ids;
+    //one more than the largest node id, so it can size arrays indexed by node id
+    uint32_t num_nodes = 0;
+    //the nodes' coordinates, indexed by node id. only kept for probe queries, which test the elements' exact shapes
+    std::vector<point> node_coords;
+
+    void clear() {
+        offsets.assign(1, 0);
+        node_ids.clear();
+        num_nodes = 0;
+        node_coords.clear();
+    }
+
+    size_t num_elements() const { return offsets.empty() ? 0 : offsets.size()-1; }
+    bool empty() const { return num_elements() == 0; }
+    const uint32_t *nodes_begin(size_t element_index) const { return node_ids.data() + offsets[element_index]; }
+    const uint32_t *nodes_end(size_t element_index) const { return node_ids.data() + offsets[element_index+1]; }
+};
+
+//libraries that return results in a dense (num queries x num data points) buffer have to split large batches up
+//so the buffer stays under this many entries
+#define MAX_DENSE_BATCH_RESULTS (size_t(1) << 26)
+
+inline size_t max_dense_batch_size(size_t num_data_pts) {
+    return std::max(size_t(1), MAX_DENSE_BATCH_RESULTS / std::max(size_t(1), num_data_pts));
+}
+
+//receives a query's results one at a time, so libraries that hand back results as they find them 
+//don't have to materialize them into a vector first
+class ResultSink {
+    public:
+        virtual ~ResultSink() {}
+        virtual void push(size_t index) = 0;
+        //a run of results at once, for libraries that find whole ranges (or blocks) of results together
+        virtual void push_range(const size_t *indices, size_t num_indices) {
+            for(size_t i = 0; i < num_indices; i++) {
+                push(indices[i]);
+            }
+        }
+};
+
+//appends every result to a vector, like get_intersections
+class VectorSink : public ResultSink {
+    private:
+        std::vector<size_t> &intersections_indices;
+    public:
+        VectorSink(std::vector<size_t> &indices) : intersections_indices(indices) {}
+        void push(size_t index) { intersections_indices.push_back(index); }
+        void push_range(const size_t *indices, size_t num_indices) { intersections_indices.insert(intersections_indices.end(), indices, indices + num_indices); }
+};
+
+//only counts the results and never allocates. used to separate the cost of traversing the tree from the cost of storing the results
+class CountSink : public ResultSink {
+    public:
+        size_t count = 0;
+        void push(size_t index) { count++; }
+        void push_range(const size_t *indices, size_t num_indices) { count += num_indices; }
+};
+
 class BboxIntersectionTest {
     public:
+        virtual ~BboxIntersectionTest() {}
+
         virtual bool intersections_exact() = 0;
         virtual void build_tree(const std::vector<point> &pts, const std::vector<size_t> &indices) = 0;
         virtual void get_intersections(const bbox &my_bbox, std::vector<size_t> &intersections_indices) = 0;
+
+        //whether get_intersections can be called from several threads at once on the same tree. 
+        //libraries that keep per-query state inside the tree have to override this
+        virtual bool concurrent_queries_safe() { return true; }
+
+        //pushes each result into sink. by default the results are materialized by get_intersections first, 
+        //so only libraries that override this give a true picture of their traversal cost in count only mode
+        virtual void visit_intersections(const bbox &my_bbox, ResultSink &sink) {
+            std::vector<size_t> intersections_indices;
+            get_intersections(my_bbox, intersections_indices);
+            for(size_t index : intersections_indices) {
+                sink.push(index);
+            }
+        }
+
+        //whether visit_intersections hands results to the sink without materializing them first
+        virtual bool visits_natively() { return false; }
+
+        //the total number of tree nodes the queries have visited so far, for libraries that count them
+        virtual bool counts_nodes_visited() { return false; }
+        virtual uint64_t get_num_nodes_visited() { return 0; }
+
+        //issues num_queries queries at once and appends their results to results, which must start out cleared.
+        //by default this just loops over get_intersections. libraries that can search for many queries in one call override it
+        virtual void get_intersections_batch(const bbox *queries, size_t num_queries, batch_results &results) {
+            std::vector<size_t> query_result_indices;
+            for(size_t i = 0; i < num_queries; i++) {
+                query_result_indices.clear();
+                get_intersections(queries[i], query_result_indices);
+                results.indices.insert(results.indices.end(), query_result_indices.begin(), query_result_indices.end());
+                results.offsets.push_back(results.indices.size());
+            }
+        }
 };
 
 
@@ -3,6 +3,13 @@
 
 #include "common.hh"
 #include "../benchmark/all_libraries/brute_force_test.hh"
+#include "../benchmark/all_libraries/brute_force_simd_test.hh"
+#include "../benchmark/all_libraries/native_kdtree_test.hh"
+#include "../benchmark/all_libraries/native_rtree_test.hh"
+#include "../benchmark/all_libraries/uniform_grid_test.hh"
+#include "../benchmark/all_libraries/linear_octree_test.hh"
+#include "../benchmark/all_libraries/wide_bvh_test.hh"
+#include "../benchmark/all_libraries/triangles_test.hh"
 
 #ifdef TEST_3DTK
     #include "../benchmark/all_libraries/3dtk_test.hh"
@@ -11,14 +11,50 @@
 
 
 void test_brute_force_bboxes(const std::vector<point> &pts_bbox, const std::vector<size_t> &indices_bbox, testing_config config, 
-    const std::vector<std::vector<size_t>> &element_node_ids) 
+    const element_connectivity &element_node_ids) 
 {
     switch(config.library_option) {
         case 0: {
             string test_name = "Brute Force Bboxes";
-            TestBruteForce *test_brute_force_bboxes = new TestBruteForce();
+            TestBruteForce<> *test_brute_force_bboxes = new TestBruteForce<>();
             std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
-            test_brute_force_bboxes->build_tree(pts_bbox, indices_bbox);
+            test_brute_force_bboxes->build_tree_bbox(pts_bbox, indices_bbox);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_brute_force_bboxes, test_name, pts_bbox, indices_bbox, config, STANDARD, element_node_ids);
+            break;
+        }
+        case 1: {
+            string test_name = "Brute Force Bboxes Float";
+            TestBruteForce<float> *test_brute_force_bboxes = new TestBruteForce<float>();
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_brute_force_bboxes->build_tree_bbox(pts_bbox, indices_bbox);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_brute_force_bboxes, test_name, pts_bbox, indices_bbox, config, STANDARD, element_node_ids);
+            break;
+        }
+        case 2: {
+            string test_name = "Brute Force Bboxes SoA Scalar";
+            TestBruteForceSIMD *test_brute_force_bboxes = new TestBruteForceSIMD(SCALAR_KERNEL);
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_brute_force_bboxes->build_tree_bbox(pts_bbox, indices_bbox);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_brute_force_bboxes, test_name, pts_bbox, indices_bbox, config, STANDARD, element_node_ids);
+            break;
+        }
+        case 3: {
+            string test_name = "Brute Force Bboxes SoA AVX2";
+            TestBruteForceSIMD *test_brute_force_bboxes = new TestBruteForceSIMD(AVX2_KERNEL);
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_brute_force_bboxes->build_tree_bbox(pts_bbox, indices_bbox);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_brute_force_bboxes, test_name, pts_bbox, indices_bbox, config, STANDARD, element_node_ids);
+            break;
+        }
+        case 4: {
+            string test_name = "Brute Force Bboxes SoA AVX-512";
+            TestBruteForceSIMD *test_brute_force_bboxes = new TestBruteForceSIMD(AVX512_KERNEL);
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_brute_force_bboxes->build_tree_bbox(pts_bbox, indices_bbox);
             print_build_time(test_name, build_start_time, config);
             perform_queries(test_brute_force_bboxes, test_name, pts_bbox, indices_bbox, config, STANDARD, element_node_ids);
             break;
@@ -29,9 +65,205 @@ void test_brute_force_bboxes(const std::vector<point> &pts_bbox, const std::vect
     }
 }
 
+void test_native_kdtree_bboxes(const std::vector<point> &pts_bbox, const std::vector<size_t> &indices_bbox, testing_config config, 
+    const element_connectivity &element_node_ids) 
+{
+    switch(config.library_option) {
+        case 0: {
+            string test_name = "Native Kdtree Bboxes";
+            TestNativeKdtree *test_native_kdtree_bboxes = new TestNativeKdtree(NUM_ELEMS_PER_NODE);
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_native_kdtree_bboxes->build_tree_bbox(pts_bbox, indices_bbox);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_native_kdtree_bboxes, test_name, pts_bbox, indices_bbox, config, STANDARD, element_node_ids);
+            break;
+        }
+        case 1: {
+            string test_name = "Native Kdtree Bboxes Bucket Size = 200";
+            TestNativeKdtree *test_native_kdtree_bboxes = new TestNativeKdtree(LARGE_NUM_ELEMS_PER_NODE);
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_native_kdtree_bboxes->build_tree_bbox(pts_bbox, indices_bbox);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_native_kdtree_bboxes, test_name, pts_bbox, indices_bbox, config, STANDARD, element_node_ids);
+            break;
+        }
+        case 2: {
+            string test_name = "Native Kdtree Bboxes Scalar Leaves";
+            TestNativeKdtree *test_native_kdtree_bboxes = new TestNativeKdtree(NUM_ELEMS_PER_NODE, SCALAR_KERNEL);
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_native_kdtree_bboxes->build_tree_bbox(pts_bbox, indices_bbox);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_native_kdtree_bboxes, test_name, pts_bbox, indices_bbox, config, STANDARD, element_node_ids);
+            break;
+        }
+        case 3: {
+            string test_name = "Native Kdtree Bboxes Serial Build";
+            TestNativeKdtree *test_native_kdtree_bboxes = new TestNativeKdtree(NUM_ELEMS_PER_NODE, AVX2_KERNEL, 1);
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_native_kdtree_bboxes->build_tree_bbox(pts_bbox, indices_bbox);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_native_kdtree_bboxes, test_name, pts_bbox, indices_bbox, config, STANDARD, element_node_ids);
+            break;
+        }
+        default : {
+            cout << "error. test_native_kdtree_bboxes was run with option: " << config.library_option << ", which exceeds the maximum expected value" << endl;            
+        }
+    }
+}
+
+//fan outs of 8 doubles or 16 floats put each of a node's 6 bound arrays in one 64 byte cache line
+void test_native_rtree_bboxes(const std::vector<point> &pts_bbox, const std::vector<size_t> &indices_bbox, testing_config config, 
+    const element_connectivity &element_node_ids) 
+{
+    switch(config.library_option) {
+        case 0: {
+            string test_name = "Native Rtree Bboxes STR";
+            TestNativeRtree<> *test_native_rtree_bboxes = new TestNativeRtree<>(8, STR_PACKING);
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_native_rtree_bboxes->build_tree_bbox(pts_bbox, indices_bbox);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_native_rtree_bboxes, test_name, pts_bbox, indices_bbox, config, STANDARD, element_node_ids);
+            break;
+        }
+        case 1: {
+            string test_name = "Native Rtree Bboxes Hilbert";
+            TestNativeRtree<> *test_native_rtree_bboxes = new TestNativeRtree<>(8, HILBERT_PACKING);
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_native_rtree_bboxes->build_tree_bbox(pts_bbox, indices_bbox);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_native_rtree_bboxes, test_name, pts_bbox, indices_bbox, config, STANDARD, element_node_ids);
+            break;
+        }
+        case 2: {
+            string test_name = "Native Rtree Bboxes STR Float";
+            TestNativeRtree<float> *test_native_rtree_bboxes = new TestNativeRtree<float>(16, STR_PACKING);
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_native_rtree_bboxes->build_tree_bbox(pts_bbox, indices_bbox);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_native_rtree_bboxes, test_name, pts_bbox, indices_bbox, config, STANDARD, element_node_ids);
+            break;
+        }
+        case 3: {
+            string test_name = "Native Rtree Bboxes Hilbert Float";
+            TestNativeRtree<float> *test_native_rtree_bboxes = new TestNativeRtree<float>(16, HILBERT_PACKING);
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_native_rtree_bboxes->build_tree_bbox(pts_bbox, indices_bbox);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_native_rtree_bboxes, test_name, pts_bbox, indices_bbox, config, STANDARD, element_node_ids);
+            break;
+        }
+        case 4: {
+            string test_name = "Native Rtree Bboxes STR Fan Out = 20";
+            TestNativeRtree<> *test_native_rtree_bboxes = new TestNativeRtree<>(NUM_ELEMS_PER_NODE, STR_PACKING);
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_native_rtree_bboxes->build_tree_bbox(pts_bbox, indices_bbox);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_native_rtree_bboxes, test_name, pts_bbox, indices_bbox, config, STANDARD, element_node_ids);
+            break;
+        }
+        default : {
+            cout << "error. test_native_rtree_bboxes was run with option: " << config.library_option << ", which exceeds the maximum expected value" << endl;            
+        }
+    }
+}
+
+void test_uniform_grid_bboxes(const std::vector<point> &pts_bbox, const std::vector<size_t> &indices_bbox, testing_config config, 
+    const element_connectivity &element_node_ids) 
+{
+    switch(config.library_option) {
+        case 0: {
+            string test_name = "Uniform Grid Bboxes";
+            TestUniformGrid *test_uniform_grid_bboxes = new TestUniformGrid();
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_uniform_grid_bboxes->build_tree_bbox(pts_bbox, indices_bbox);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_uniform_grid_bboxes, test_name, pts_bbox, indices_bbox, config, STANDARD, element_node_ids);
+            break;
+        }
+        case 1: {
+            string test_name = "Uniform Grid Bboxes Items Per Cell = 2";
+            TestUniformGrid *test_uniform_grid_bboxes = new TestUniformGrid(2);
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_uniform_grid_bboxes->build_tree_bbox(pts_bbox, indices_bbox);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_uniform_grid_bboxes, test_name, pts_bbox, indices_bbox, config, STANDARD, element_node_ids);
+            break;
+        }
+        case 2: {
+            string test_name = "Uniform Grid Bboxes Items Per Cell = 20";
+            TestUniformGrid *test_uniform_grid_bboxes = new TestUniformGrid(NUM_ELEMS_PER_NODE);
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_uniform_grid_bboxes->build_tree_bbox(pts_bbox, indices_bbox);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_uniform_grid_bboxes, test_name, pts_bbox, indices_bbox, config, STANDARD, element_node_ids);
+            break;
+        }
+        case 3: {
+            string test_name = "Uniform Grid Bboxes Scalar Cells";
+            TestUniformGrid *test_uniform_grid_bboxes = new TestUniformGrid(8, SCALAR_KERNEL);
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_uniform_grid_bboxes->build_tree_bbox(pts_bbox, indices_bbox);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_uniform_grid_bboxes, test_name, pts_bbox, indices_bbox, config, STANDARD, element_node_ids);
+            break;
+        }
+        default : {
+            cout << "error. test_uniform_grid_bboxes was run with option: " << config.library_option << ", which exceeds the maximum expected value" << endl;            
+        }
+    }
+}
+
+//meant to be compared with the "CGAL AABBTree Bboxes" option of test_cgal_bboxes, a binary bvh. both report their query times per 
+//category, and the wide bvh also reports the nodes it visits per query
+void test_wide_bvh_bboxes(const std::vector<point> &pts_bbox, const std::vector<size_t> &indices_bbox, testing_config config, 
+    const element_connectivity &element_node_ids) 
+{
+    switch(config.library_option) {
+        case 0: {
+            string test_name = "Wide BVH 4 Bboxes";
+            TestWideBvh<4> *test_wide_bvh_bboxes = new TestWideBvh<4>(4);
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_wide_bvh_bboxes->build_tree_bbox(pts_bbox, indices_bbox);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_wide_bvh_bboxes, test_name, pts_bbox, indices_bbox, config, STANDARD, element_node_ids);
+            break;
+        }
+        case 1: {
+            string test_name = "Wide BVH 8 Bboxes";
+            TestWideBvh<8> *test_wide_bvh_bboxes = new TestWideBvh<8>(8);
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_wide_bvh_bboxes->build_tree_bbox(pts_bbox, indices_bbox);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_wide_bvh_bboxes, test_name, pts_bbox, indices_bbox, config, STANDARD, element_node_ids);
+            break;
+        }
+        case 2: {
+            string test_name = "Wide BVH 4 Bboxes Scalar Nodes";
+            TestWideBvh<4> *test_wide_bvh_bboxes = new TestWideBvh<4>(4, SCALAR_KERNEL);
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_wide_bvh_bboxes->build_tree_bbox(pts_bbox, indices_bbox);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_wide_bvh_bboxes, test_name, pts_bbox, indices_bbox, config, STANDARD, element_node_ids);
+            break;
+        }
+        case 3: {
+            string test_name = "Wide BVH 8 Bboxes AVX2 Nodes";
+            TestWideBvh<8> *test_wide_bvh_bboxes = new TestWideBvh<8>(8, AVX2_KERNEL);
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_wide_bvh_bboxes->build_tree_bbox(pts_bbox, indices_bbox);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_wide_bvh_bboxes, test_name, pts_bbox, indices_bbox, config, STANDARD, element_node_ids);
+            break;
+        }
+        default : {
+            cout << "error. test_wide_bvh_bboxes was run with option: " << config.library_option << ", which exceeds the maximum expected value" << endl;            
+        }
+    }
+}
+
 #ifdef TEST_BOOST
 void test_boost_bboxes(const std::vector<point> &pts_bbox, const std::vector<size_t> &indices_bbox, testing_config config, 
-    const std::vector<std::vector<size_t>> &element_node_ids) 
+    const element_connectivity &element_node_ids) 
 {
     switch(config.library_option) {
         case 0: {
@@ -52,6 +284,15 @@ void test_boost_bboxes(const std::vector<point> &pts_bbox, const std::vector<siz
             perform_queries(test_boost4, test_name, pts_bbox, indices_bbox, config, STANDARD, element_node_ids);
             break;
         }
+        case 2: {
+            string test_name = "Boost Bboxes Float";
+            auto test_boost4 = new TestBoost<boost::geometry::index::linear<NUM_ELEMS_PER_NODE>, float>();
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_boost4->build_tree_bbox(pts_bbox, indices_bbox);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_boost4, test_name, pts_bbox, indices_bbox, config, STANDARD, element_node_ids);
+            break;
+        }
         default : {
             cout << "error. test_boost_bboxes was run with option: " << config.library_option << ", which exceeds the maximum expected value" << endl;            
         }
@@ -61,7 +302,7 @@ void test_boost_bboxes(const std::vector<point> &pts_bbox, const std::vector<siz
 
 #ifdef TEST_CGAL
 void test_cgal_bboxes(const std::vector<point> &pts_bbox, const std::vector<size_t> &indices_bbox, testing_config config, 
-    const std::vector<std::vector<size_t>> &element_node_ids) 
+    const element_connectivity &element_node_ids) 
 {
     switch(config.library_option) {
         case 0 : {
@@ -91,7 +332,7 @@ void test_cgal_bboxes(const std::vector<point> &pts_bbox, const std::vector<size
 
 #ifdef TEST_LIBSPATIALINDEX
 void test_libspatialindex_bboxes(const std::vector<point> &pts_bbox, const std::vector<size_t> &indices_bbox, testing_config config, 
-    const std::vector<std::vector<size_t>> &element_node_ids) 
+    const element_connectivity &element_node_ids) 
 {
     switch(config.library_option) {
         case 0 : {
@@ -139,7 +380,7 @@ void test_libspatialindex_bboxes(const std::vector<point> &pts_bbox, const std::
 
 #ifdef TEST_RTREE_TEMPLATE
 void test_rtree_template_bboxes(const std::vector<point> &pts_bbox, const std::vector<size_t> &indices_bbox, testing_config config, 
-    const std::vector<std::vector<size_t>> &element_node_ids) 
+    const element_connectivity &element_node_ids) 
 {
     switch(config.library_option) {
         case 0 : {
@@ -171,7 +412,7 @@ void test_rtree_template_bboxes(const std::vector<point> &pts_bbox, const std::v
 
 #ifdef TEST_SPATIAL
 void test_spatial_bboxes(const std::vector<point> &pts_bbox, const std::vector<size_t> &indices_bbox, testing_config config, 
-    const std::vector<std::vector<size_t>> &element_node_ids) 
+    const element_connectivity &element_node_ids) 
 {
     switch(config.library_option) {
         case 0: {
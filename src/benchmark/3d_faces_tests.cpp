@@ -0,0 +1,152 @@
+#include "range_tree_libraries.hh"
+#include "perform_queries.hh"
+
+#ifndef NUM_ELEMS_PER_NODE
+    #error Your need to define NUM_ELEMS_PER_NODE in a common header file
+#endif
+
+#ifndef LARGE_NUM_ELEMS_PER_NODE
+    #error Your need to define LARGE_NUM_ELEMS_PER_NODE in a common header file
+#endif
+
+//the "Triangle Bboxes" tests index the triangles' bboxes with a bbox library and filter its results with the exact triangle-box overlap kernel
+
+void test_brute_force_faces(const std::vector<point> &pts_triangle, const std::vector<size_t> &indices_triangle, testing_config config) {
+    switch(config.library_option) {
+        case 0: {
+            string test_name = "Brute Force Triangles Scalar";
+            TestBruteForceTriangles *test_brute_force_triangles = new TestBruteForceTriangles(SCALAR_KERNEL);
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_brute_force_triangles->build_tree(pts_triangle, indices_triangle);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_brute_force_triangles, test_name, pts_triangle, indices_triangle, config);
+            break;
+        }
+        case 1: {
+            string test_name = "Brute Force Triangles AVX2";
+            TestBruteForceTriangles *test_brute_force_triangles = new TestBruteForceTriangles(AVX2_KERNEL);
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_brute_force_triangles->build_tree(pts_triangle, indices_triangle);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_brute_force_triangles, test_name, pts_triangle, indices_triangle, config);
+            break;
+        }
+        default : {
+            cout << "error. test_brute_force_faces was run with option: " << config.library_option << ", which exceeds the maximum expected value" << endl;
+        }
+    }
+}
+
+#ifdef TEST_BOOST
+void test_boost_faces(const std::vector<point> &pts_triangle, const std::vector<size_t> &indices_triangle, testing_config config) {
+    switch(config.library_option) {
+        case 0: {
+            string test_name = "Boost Triangle Bboxes";
+            typedef TestBoost<boost::geometry::index::linear<NUM_ELEMS_PER_NODE>> BboxTest;
+            auto test_boost_triangles = new TestTriangleBboxes<BboxTest>(new BboxTest(),
+                [](BboxTest *test, const std::vector<point> &pts_bbox, const std::vector<size_t> &indices_bbox) { test->build_tree_bbox(pts_bbox, indices_bbox); });
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_boost_triangles->build_tree(pts_triangle, indices_triangle);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_boost_triangles, test_name, pts_triangle, indices_triangle, config);
+            break;
+        }
+        case 1: {
+            string test_name = "Boost Triangle Bboxes Bucket Size = " + std::to_string(LARGE_NUM_ELEMS_PER_NODE);
+            typedef TestBoost<boost::geometry::index::linear<LARGE_NUM_ELEMS_PER_NODE>> BboxTest;
+            auto test_boost_triangles = new TestTriangleBboxes<BboxTest>(new BboxTest(),
+                [](BboxTest *test, const std::vector<point> &pts_bbox, const std::vector<size_t> &indices_bbox) { test->build_tree_bbox(pts_bbox, indices_bbox); });
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_boost_triangles->build_tree(pts_triangle, indices_triangle);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_boost_triangles, test_name, pts_triangle, indices_triangle, config);
+            break;
+        }
+        case 2: {
+            string test_name = "Boost Triangle Bboxes Float";
+            typedef TestBoost<boost::geometry::index::linear<NUM_ELEMS_PER_NODE>, float> BboxTest;
+            auto test_boost_triangles = new TestTriangleBboxes<BboxTest>(new BboxTest(),
+                [](BboxTest *test, const std::vector<point> &pts_bbox, const std::vector<size_t> &indices_bbox) { test->build_tree_bbox(pts_bbox, indices_bbox); });
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_boost_triangles->build_tree(pts_triangle, indices_triangle);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_boost_triangles, test_name, pts_triangle, indices_triangle, config);
+            break;
+        }
+        default : {
+            cout << "error. test_boost_faces was run with option: " << config.library_option << ", which exceeds the maximum expected value" << endl;
+        }
+    }
+}
+#endif
+
+#ifdef TEST_CGAL
+void test_cgal_faces(const std::vector<point> &pts_triangle, const std::vector<size_t> &indices_triangle, testing_config config) {
+    switch(config.library_option) {
+        case 0 : {
+            string test_name = "CGAL AABBTree Triangles";
+            TestCGAL::AABBTree::Triangles *test_cgal_aabb_tree_triangles = new TestCGAL::AABBTree::Triangles();
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_cgal_aabb_tree_triangles->build_tree(pts_triangle, indices_triangle);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_cgal_aabb_tree_triangles, test_name, pts_triangle, indices_triangle, config);
+            break;
+        }
+        case 1 : {
+            string test_name = "CGAL AABBTree Triangle Bboxes";
+            typedef TestCGAL::AABBTree::Bboxes BboxTest;
+            auto test_cgal_aabb_tree_triangles = new TestTriangleBboxes<BboxTest>(new BboxTest(),
+                [](BboxTest *test, const std::vector<point> &pts_bbox, const std::vector<size_t> &indices_bbox) { test->build_tree(pts_bbox, indices_bbox); });
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_cgal_aabb_tree_triangles->build_tree(pts_triangle, indices_triangle);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_cgal_aabb_tree_triangles, test_name, pts_triangle, indices_triangle, config);
+            break;
+        }
+        default : {
+            cout << "error. test_cgal_faces was run with option: " << config.library_option << ", which exceeds the maximum expected value" << endl;
+        }
+    }
+}
+#endif
+
+#ifdef TEST_LIBSPATIALINDEX
+void test_libspatialindex_faces(const std::vector<point> &pts_triangle, const std::vector<size_t> &indices_triangle, testing_config config) {
+    switch(config.library_option) {
+        case 0 : {
+            string test_name = "Libspatialindex Triangle Bboxes";
+            auto test_libspatialindex_triangles = new TestTriangleBboxes<TestLibspatialindex>(new TestLibspatialindex(),
+                [](TestLibspatialindex *test, const std::vector<point> &pts_bbox, const std::vector<size_t> &indices_bbox) { test->build_tree_bbox(pts_bbox, indices_bbox); });
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_libspatialindex_triangles->build_tree(pts_triangle, indices_triangle);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_libspatialindex_triangles, test_name, pts_triangle, indices_triangle, config);
+            break;
+        }
+        default : {
+            cout << "error. test_libspatialindex_faces was run with option: " << config.library_option << ", which exceeds the maximum expected value" << endl;
+        }
+    }
+}
+#endif
+
+#ifdef TEST_RTREE_TEMPLATE
+void test_rtree_template_faces(const std::vector<point> &pts_triangle, const std::vector<size_t> &indices_triangle, testing_config config) {
+    switch(config.library_option) {
+        case 0 : {
+            string test_name = "Rtree Template Triangle Bboxes";
+            typedef TestRtreeTemplate::Bboxes<NUM_ELEMS_PER_NODE> BboxTest;
+            auto test_rtree_template_triangles = new TestTriangleBboxes<BboxTest>(new BboxTest(),
+                [](BboxTest *test, const std::vector<point> &pts_bbox, const std::vector<size_t> &indices_bbox) { test->build_tree(pts_bbox, indices_bbox); });
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_rtree_template_triangles->build_tree(pts_triangle, indices_triangle);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_rtree_template_triangles, test_name, pts_triangle, indices_triangle, config);
+            break;
+        }
+        default : {
+            cout << "error. test_rtree_template_faces was run with option: " << config.library_option << ", which exceeds the maximum expected value" << endl;
+        }
+    }
+}
+#endif
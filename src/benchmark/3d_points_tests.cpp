@@ -13,7 +13,43 @@ void test_brute_force_points(const std::vector<point> &pts, const std::vector<si
     switch(config.library_option) {
         case 0: {
             string test_name = "Brute Force";
-            TestBruteForce *test_brute_force = new TestBruteForce();
+            TestBruteForce<> *test_brute_force = new TestBruteForce<>();
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_brute_force->build_tree(pts, indices);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_brute_force, test_name, pts, indices, config);
+            break;
+        }
+        case 1: {
+            string test_name = "Brute Force Float";
+            TestBruteForce<float> *test_brute_force = new TestBruteForce<float>();
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_brute_force->build_tree(pts, indices);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_brute_force, test_name, pts, indices, config);
+            break;
+        }
+        case 2: {
+            string test_name = "Brute Force SoA Scalar";
+            TestBruteForceSIMD *test_brute_force = new TestBruteForceSIMD(SCALAR_KERNEL);
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_brute_force->build_tree(pts, indices);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_brute_force, test_name, pts, indices, config);
+            break;
+        }
+        case 3: {
+            string test_name = "Brute Force SoA AVX2";
+            TestBruteForceSIMD *test_brute_force = new TestBruteForceSIMD(AVX2_KERNEL);
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_brute_force->build_tree(pts, indices);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_brute_force, test_name, pts, indices, config);
+            break;
+        }
+        case 4: {
+            string test_name = "Brute Force SoA AVX-512";
+            TestBruteForceSIMD *test_brute_force = new TestBruteForceSIMD(AVX512_KERNEL);
             std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
             test_brute_force->build_tree(pts, indices);
             print_build_time(test_name, build_start_time, config);
@@ -25,6 +61,139 @@ void test_brute_force_points(const std::vector<point> &pts, const std::vector<si
         }
     }
 }   
+
+void test_native_kdtree_points(const std::vector<point> &pts, const std::vector<size_t> &indices, testing_config config) {
+    switch(config.library_option) {
+        case 0: {
+            string test_name = "Native Kdtree";
+            TestNativeKdtree *test_native_kdtree = new TestNativeKdtree(NUM_ELEMS_PER_NODE);
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_native_kdtree->build_tree(pts, indices);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_native_kdtree, test_name, pts, indices, config);
+            break;
+        }
+        case 1: {
+            string test_name = "Native Kdtree Bucket Size = 200";
+            TestNativeKdtree *test_native_kdtree = new TestNativeKdtree(LARGE_NUM_ELEMS_PER_NODE);
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_native_kdtree->build_tree(pts, indices);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_native_kdtree, test_name, pts, indices, config);
+            break;
+        }
+        case 2: {
+            string test_name = "Native Kdtree Scalar Leaves";
+            TestNativeKdtree *test_native_kdtree = new TestNativeKdtree(NUM_ELEMS_PER_NODE, SCALAR_KERNEL);
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_native_kdtree->build_tree(pts, indices);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_native_kdtree, test_name, pts, indices, config);
+            break;
+        }
+        case 3: {
+            string test_name = "Native Kdtree Serial Build";
+            TestNativeKdtree *test_native_kdtree = new TestNativeKdtree(NUM_ELEMS_PER_NODE, AVX2_KERNEL, 1);
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_native_kdtree->build_tree(pts, indices);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_native_kdtree, test_name, pts, indices, config);
+            break;
+        }
+        default : {
+            cout << "error. test_native_kdtree_points was run with option: " << config.library_option << ", which exceeds the maximum expected value" << endl;            
+        }
+    }
+}
+
+void test_uniform_grid_points(const std::vector<point> &pts, const std::vector<size_t> &indices, testing_config config) {
+    switch(config.library_option) {
+        case 0: {
+            string test_name = "Uniform Grid";
+            TestUniformGrid *test_uniform_grid = new TestUniformGrid();
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_uniform_grid->build_tree(pts, indices);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_uniform_grid, test_name, pts, indices, config);
+            break;
+        }
+        case 1: {
+            string test_name = "Uniform Grid Items Per Cell = 2";
+            TestUniformGrid *test_uniform_grid = new TestUniformGrid(2);
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_uniform_grid->build_tree(pts, indices);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_uniform_grid, test_name, pts, indices, config);
+            break;
+        }
+        case 2: {
+            string test_name = "Uniform Grid Items Per Cell = 20";
+            TestUniformGrid *test_uniform_grid = new TestUniformGrid(NUM_ELEMS_PER_NODE);
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_uniform_grid->build_tree(pts, indices);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_uniform_grid, test_name, pts, indices, config);
+            break;
+        }
+        case 3: {
+            string test_name = "Uniform Grid Scalar Cells";
+            TestUniformGrid *test_uniform_grid = new TestUniformGrid(8, SCALAR_KERNEL);
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_uniform_grid->build_tree(pts, indices);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_uniform_grid, test_name, pts, indices, config);
+            break;
+        }
+        default : {
+            cout << "error. test_uniform_grid_points was run with option: " << config.library_option << ", which exceeds the maximum expected value" << endl;            
+        }
+    }
+}
+
+void test_linear_octree_points(const std::vector<point> &pts, const std::vector<size_t> &indices, testing_config config) {
+    switch(config.library_option) {
+        case 0: {
+            string test_name = "Linear Octree";
+            TestLinearOctree *test_linear_octree = new TestLinearOctree();
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_linear_octree->build_tree(pts, indices);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_linear_octree, test_name, pts, indices, config);
+            break;
+        }
+        case 1: {
+            string test_name = "Linear Octree Bucket Size = 200";
+            TestLinearOctree *test_linear_octree = new TestLinearOctree(LARGE_NUM_ELEMS_PER_NODE);
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_linear_octree->build_tree(pts, indices);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_linear_octree, test_name, pts, indices, config);
+            break;
+        }
+        case 2: {
+            string test_name = "Linear Octree Bucket Size = 1";
+            TestLinearOctree *test_linear_octree = new TestLinearOctree(1);
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_linear_octree->build_tree(pts, indices);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_linear_octree, test_name, pts, indices, config);
+            break;
+        }
+        case 3: {
+            string test_name = "Linear Octree Binary Search";
+            TestLinearOctree *test_linear_octree = new TestLinearOctree(NUM_ELEMS_PER_NODE, false);
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_linear_octree->build_tree(pts, indices);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_linear_octree, test_name, pts, indices, config);
+            break;
+        }
+        default : {
+            cout << "error. test_linear_octree_points was run with option: " << config.library_option << ", which exceeds the maximum expected value" << endl;            
+        }
+    }
+}
+
 #ifdef TEST_3DTK
 void test_3dtk_points(const std::vector<point> &pts, const std::vector<size_t> &indices, testing_config config) {
     switch(config.library_option) {
@@ -157,6 +326,15 @@ void test_boost_points(const std::vector<point> &pts, const std::vector<size_t>
             perform_queries(test_boost3, test_name, pts, indices, config);
             break;
         }
+        case 4: {
+            string test_name = "Boost Float";
+            auto test_boost4 = new TestBoost<boost::geometry::index::linear<NUM_ELEMS_PER_NODE>, float>();
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_boost4->build_tree(pts, indices);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_boost4, test_name, pts, indices, config);
+            break;
+        }
         default : {
             cout << "error. test_boost_points was run with option: " << config.library_option << ", which exceeds the maximum expected value" << endl;            
         }
@@ -169,7 +347,7 @@ void test_cgal_points(const std::vector<point> &pts, const std::vector<size_t> &
     switch(config.library_option) {
         case 0: {
             string test_name = "CGAL Kdtree";
-            TestCGAL::KDTree *test_cgal_kdtree = new TestCGAL::KDTree();
+            TestCGAL::KDTree<> *test_cgal_kdtree = new TestCGAL::KDTree<>();
             std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
             test_cgal_kdtree->build_tree(pts, indices);
             print_build_time(test_name, build_start_time, config);
@@ -178,7 +356,7 @@ void test_cgal_points(const std::vector<point> &pts, const std::vector<size_t> &
         }
         case 1: {
             string test_name = "CGAL Kdtree Bucket Size =  " + std::to_string(LARGE_NUM_ELEMS_PER_NODE);
-            TestCGAL::KDTree *test_cgal_kdtree2 = new TestCGAL::KDTree();
+            TestCGAL::KDTree<> *test_cgal_kdtree2 = new TestCGAL::KDTree<>();
             std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
             test_cgal_kdtree2->build_tree(pts, indices, LARGE_NUM_ELEMS_PER_NODE);
             print_build_time(test_name, build_start_time, config);
@@ -194,6 +372,15 @@ void test_cgal_points(const std::vector<point> &pts, const std::vector<size_t> &
             perform_queries(test_cgal_range_tree, test_name, pts, indices, config);
             break;
         }
+        case 3: {
+            string test_name = "CGAL Kdtree Float";
+            TestCGAL::KDTree<float> *test_cgal_kdtree = new TestCGAL::KDTree<float>();
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_cgal_kdtree->build_tree(pts, indices);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_cgal_kdtree, test_name, pts, indices, config);
+            break;
+        }
         default : {
             cout << "error. test_cgal_points was run with option: " << config.library_option << ", which exceeds the maximum expected value" << endl;            
         }
@@ -501,7 +688,7 @@ void test_nanoflann_points(const std::vector<point> &pts, const std::vector<size
     switch(config.library_option) {
         case 0: {
             string test_name = "Nanoflann";
-            TestNanoflann *test_nanoflann = new TestNanoflann();
+            TestNanoflann<> *test_nanoflann = new TestNanoflann<>();
             std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
             test_nanoflann->build_tree(pts, indices);
             print_build_time(test_name, build_start_time, config);
@@ -510,7 +697,7 @@ void test_nanoflann_points(const std::vector<point> &pts, const std::vector<size
         }
         case 1: {
             string test_name = "Nanoflann Bucket Size =  " + std::to_string(LARGE_NUM_ELEMS_PER_NODE);
-            TestNanoflann *test_nanoflann = new TestNanoflann();
+            TestNanoflann<> *test_nanoflann = new TestNanoflann<>();
             std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
             test_nanoflann->build_tree(pts, indices, LARGE_NUM_ELEMS_PER_NODE);
             print_build_time(test_name, build_start_time, config);
@@ -519,7 +706,7 @@ void test_nanoflann_points(const std::vector<point> &pts, const std::vector<size
         }
         case 2: {
             string test_name = "Nanoflann Duplicated Storage";
-            TestNanoflann *test_nanoflann = new TestNanoflann();
+            TestNanoflann<> *test_nanoflann = new TestNanoflann<>();
             std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
             test_nanoflann->build_tree(pts, indices, NUM_ELEMS_PER_NODE, true);
             print_build_time(test_name, build_start_time, config);
@@ -528,13 +715,22 @@ void test_nanoflann_points(const std::vector<point> &pts, const std::vector<size
         }
         case 3: {
             string test_name = "Nanoflann Duplicated Storage Bucket Size =  " + std::to_string(LARGE_NUM_ELEMS_PER_NODE);
-            TestNanoflann *test_nanoflann = new TestNanoflann();
+            TestNanoflann<> *test_nanoflann = new TestNanoflann<>();
             std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
             test_nanoflann->build_tree(pts, indices, LARGE_NUM_ELEMS_PER_NODE, true);
             print_build_time(test_name, build_start_time, config);
             perform_queries(test_nanoflann, test_name, pts, indices, config);
             break;
         }
+        case 4: {
+            string test_name = "Nanoflann Float";
+            TestNanoflann<float> *test_nanoflann = new TestNanoflann<float>();
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_nanoflann->build_tree(pts, indices);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_nanoflann, test_name, pts, indices, config);
+            break;
+        }
         default : {
             cout << "error. test_nanoflann_points was run with option: " << config.library_option << ", which exceeds the maximum expected value" << endl;            
         }
@@ -651,8 +847,8 @@ void test_pico_tree_points(const std::vector<point> &pts, const std::vector<size
     switch(config.library_option) {
         case 0: {
             string test_name = "Pico tree";
-            TestPicoTree *test_pico_tree;
-            test_pico_tree = new TestPicoTree();
+            TestPicoTree<> *test_pico_tree;
+            test_pico_tree = new TestPicoTree<>();
             std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
             test_pico_tree->build_tree(pts, indices);
             print_build_time(test_name, build_start_time, config);
@@ -661,13 +857,22 @@ void test_pico_tree_points(const std::vector<point> &pts, const std::vector<size
         }
         case 1: {
             string test_name = "Pico tree Bucket Size =  " + std::to_string(LARGE_NUM_ELEMS_PER_NODE);
-            TestPicoTree *test_pico_tree = new TestPicoTree();
+            TestPicoTree<> *test_pico_tree = new TestPicoTree<>();
             std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
             test_pico_tree->build_tree(pts, indices, LARGE_NUM_ELEMS_PER_NODE);
             print_build_time(test_name, build_start_time, config);
             perform_queries(test_pico_tree, test_name, pts, indices, config);
             break;
         }
+        case 2: {
+            string test_name = "Pico tree Float";
+            TestPicoTree<float> *test_pico_tree = new TestPicoTree<float>();
+            std::chrono::high_resolution_clock::time_point build_start_time = std::chrono::high_resolution_clock::now();
+            test_pico_tree->build_tree(pts, indices);
+            print_build_time(test_name, build_start_time, config);
+            perform_queries(test_pico_tree, test_name, pts, indices, config);
+            break;
+        }
         default : {
             cout << "error. test_pico_tree_points was run with option: " << config.library_option << ", which exceeds the maximum expected value" << endl;            
         }
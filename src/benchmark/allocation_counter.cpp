@@ -0,0 +1,134 @@
+#include "allocation_counter.hh"
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <new>
+
+//each thread counts into its own cache line, so threads allocating at the same time don't contend on one counter.
+//threads past the last slot share slots, which is why the slots are still atomic
+#define NUM_ALLOCATION_COUNTER_SLOTS 256
+
+struct alignas(64) allocation_counter_slot {
+    std::atomic<uint64_t> count;
+};
+
+static allocation_counter_slot allocation_counter_slots[NUM_ALLOCATION_COUNTER_SLOTS];
+static std::atomic<uint32_t> num_assigned_slots(0);
+//1 + the thread's slot, or 0 if it hasn't allocated yet. constant initialized, so reading it never allocates (which malloc can't afford)
+static thread_local uint32_t thread_slot = 0;
+
+static inline void count_allocation() {
+    if(thread_slot == 0) {
+        thread_slot = 1 + num_assigned_slots.fetch_add(1, std::memory_order_relaxed) % NUM_ALLOCATION_COUNTER_SLOTS;
+    }
+    allocation_counter_slots[thread_slot - 1].count.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t get_num_allocations() {
+    uint64_t num_allocations = 0;
+    for(int i = 0; i < NUM_ALLOCATION_COUNTER_SLOTS; i++) {
+        num_allocations += allocation_counter_slots[i].count.load(std::memory_order_relaxed);
+    }
+    return num_allocations;
+}
+
+#ifdef __GLIBC__
+    //glibc lets the executable interpose its own malloc. forwarding to the __libc_ versions keeps glibc's allocator (so its free still works)
+    //and catches the C libraries that call malloc directly as well as operator new, which calls malloc
+    extern "C" {
+        void *__libc_malloc(size_t size);
+        void *__libc_calloc(size_t num, size_t size);
+        void *__libc_realloc(void *ptr, size_t size);
+        void *__libc_memalign(size_t alignment, size_t size);
+        void *__libc_valloc(size_t size);
+        void *__libc_pvalloc(size_t size);
+
+        void *malloc(size_t size) {
+            count_allocation();
+            return __libc_malloc(size);
+        }
+
+        void *calloc(size_t num, size_t size) {
+            count_allocation();
+            return __libc_calloc(num, size);
+        }
+
+        void *realloc(void *ptr, size_t size) {
+            count_allocation();
+            return __libc_realloc(ptr, size);
+        }
+
+        //the aligned allocators (which aligned operator new is built on) all go through glibc's memalign
+        void *memalign(size_t alignment, size_t size) {
+            count_allocation();
+            return __libc_memalign(alignment, size);
+        }
+
+        void *aligned_alloc(size_t alignment, size_t size) {
+            count_allocation();
+            return __libc_memalign(alignment, size);
+        }
+
+        int posix_memalign(void **ptr, size_t alignment, size_t size) {
+            if(alignment % sizeof(void *) != 0 || (alignment & (alignment - 1)) != 0 || alignment == 0) {
+                return EINVAL;
+            }
+            count_allocation();
+            void *aligned_ptr = __libc_memalign(alignment, size);
+            if(aligned_ptr == nullptr) {
+                return ENOMEM;
+            }
+            *ptr = aligned_ptr;
+            return 0;
+        }
+
+        void *valloc(size_t size) {
+            count_allocation();
+            return __libc_valloc(size);
+        }
+
+        void *pvalloc(size_t size) {
+            count_allocation();
+            return __libc_pvalloc(size);
+        }
+    }
+#else
+    //can't interpose malloc portably, so only count allocations made through operator new
+    void *operator new(size_t size) {
+        count_allocation();
+        void *ptr = std::malloc(size == 0 ? 1 : size);
+        if(ptr == nullptr) {
+            throw std::bad_alloc();
+        }
+        return ptr;
+    }
+
+    void *operator new[](size_t size) {
+        return operator new(size);
+    }
+
+    void *operator new(size_t size, const std::nothrow_t &) noexcept {
+        count_allocation();
+        return std::malloc(size == 0 ? 1 : size);
+    }
+
+    void *operator new[](size_t size, const std::nothrow_t &tag) noexcept {
+        return operator new(size, tag);
+    }
+
+    void operator delete(void *ptr) noexcept {
+        std::free(ptr);
+    }
+
+    void operator delete[](void *ptr) noexcept {
+        std::free(ptr);
+    }
+
+    void operator delete(void *ptr, size_t) noexcept {
+        std::free(ptr);
+    }
+
+    void operator delete[](void *ptr, size_t) noexcept {
+        std::free(ptr);
+    }
+#endif
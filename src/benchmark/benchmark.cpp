@@ -1,6 +1,12 @@
 #include <numeric>
 #include "range_tree_libraries.hh"
 #include "benchmark.hh"
+#include "latency_histogram.hh"
+#include "mesh_snapshot.hh"
+#include "synthetic_data.hh"
+#include "query_trace.hh"
+#include "mesh_tiling.hh"
+#include "scaling_sweep.hh"
 
 using namespace std;
 
@@ -12,6 +18,20 @@ int main(int argc, char **argv) {
         cerr << "Error. " << argv[0] << " expects 6 arguments: the base mesh file path (to be adjusted by the number of folders the files are spread across), the mesh file name";
         cerr << ", the tree library, the type of data to write (point, bbox, triangle)";
         cerr << ", which of the library's options to use, and the number of queries to issue" << endl;
+        cerr << "optional arguments: USE_MPI, num_procs_to_test (comm_size if using MPI), comm_size, rank, valgrind";
+        cerr << ", the number of threads to issue queries with, and the largest query batch size to sweep up to, whether to also issue count only queries";
+        cerr << ", whether to report performance counters, whether to load (and cache) the mesh through a binary snapshot";
+        cerr << ", whether to count the distinct nodes of the intersected elements (bboxes only)";
+        cerr << ", the data source (0 for the exodus mesh, otherwise a synthetic distribution, in which case the mesh file path and name are ignored)";
+        cerr << ", the number of synthetic data points per rank";
+        cerr << ", min_percent:max_percent:count to calibrate count log spaced query categories to those percentages of the data (0 for the fixed feature sizes)";
+        cerr << ", the query trace mode (0 for none, 1 to record, 2 to replay closed loop, 3 to replay at the trace's timestamps), the query trace path";
+        cerr << ", the query set (0 for uniform, 1 for zipf hotspots, 2 for random walks), the overlap between consecutive random walk queries";
+        cerr << ", how to tile the mesh (0 for no tiling, kxlxm for that many copies along x, y and z, or the number of data points per rank to tile up to)";
+        cerr << ", how much to jitter the (tiled) mesh by, as a fraction of the mean spacing between data points";
+        cerr << ", the dataset size sweep (0 for none, 1 for nested random subsamples, 2 for nested spatially coherent subsamples)";
+        cerr << ", the comma separated percentages of the data to sweep over";
+        cerr << ", and the number of probe points to locate in the mesh's elements (bboxes from an exodus mesh only, 0 for none)" << endl;
         return -1;
     }
     string mesh_file_path = argv[1];
@@ -24,6 +44,24 @@ int main(int argc, char **argv) {
     int comm_size;
     int rank = 0;
     bool valgrind = false;
+    size_t num_threads = 1;
+    size_t max_batch_size = 0;
+    bool count_only_queries = false;
+    bool use_perf_counters = false;
+    bool use_mesh_snapshot = false;
+    bool retrieve_nodes_for_bboxes = false;
+    DataSource data_source = EXODUS_MESH;
+    size_t num_synthetic_data_pts = 1000000;
+    std::vector<double> query_selectivities;
+    QueryTraceMode query_trace_mode = NO_QUERY_TRACE;
+    string query_trace_path = "query_trace.bin";
+    QuerySet query_set = UNIFORM_QUERIES;
+    double query_overlap = .9;
+    string mesh_tiling = "0";
+    double mesh_jitter = 0;
+    SubsampleMode subsample_mode = NO_SUBSAMPLE_SWEEP;
+    std::vector<double> sweep_percents = {1, 2, 5, 10, 20, 50, 100};
+    size_t num_probe_queries = 0;
 
 
     if(argc >= 8) {
@@ -58,14 +96,97 @@ int main(int argc, char **argv) {
         }
     }
 
+    //comes after all of the other optional arguments so existing job scripts are unaffected
+    if(argc >= 13) {
+        num_threads = stoull(argv[12],nullptr,0);
+        if(argc >= 14) {
+            max_batch_size = stoull(argv[13],nullptr,0);
+            if(argc >= 15) {
+                count_only_queries = stoi(argv[14]);
+                if(argc >= 16) {
+                    use_perf_counters = stoi(argv[15]);
+                    if(argc >= 17) {
+                        use_mesh_snapshot = stoi(argv[16]);
+                        if(argc >= 18) {
+                            retrieve_nodes_for_bboxes = stoi(argv[17]);
+                            if(argc >= 19) {
+                                data_source = (DataSource)stoul(argv[18],nullptr,0);
+                                if(argc >= 20) {
+                                    num_synthetic_data_pts = stoull(argv[19],nullptr,0);
+                                    if(argc >= 21 && string(argv[20]) != "0") {
+                                        if(!parse_selectivity_range(argv[20], query_selectivities)) {
+                                            cerr << "error. the query selectivities should be min_percent:max_percent:count, not " << argv[20] << endl;
+                                            return -1;
+                                        }
+                                    }
+                                    if(argc >= 22) {
+                                        query_trace_mode = (QueryTraceMode)stoul(argv[21],nullptr,0);
+                                        if(argc >= 23) {
+                                            query_trace_path = argv[22];
+                                            if(argc >= 24) {
+                                                query_set = (QuerySet)stoul(argv[23],nullptr,0);
+                                                if(argc >= 25) {
+                                                    query_overlap = stod(argv[24]);
+                                                    if(argc >= 26) {
+                                                        mesh_tiling = argv[25];
+                                                        if(argc >= 27) {
+                                                            mesh_jitter = stod(argv[26]);
+                                                            if(argc >= 28) {
+                                                                subsample_mode = (SubsampleMode)stoul(argv[27],nullptr,0);
+                                                                //like the selectivities, 0 keeps the default percentages. they're only checked if there is a sweep
+                                                                if(argc >= 29 && string(argv[28]) != "0" && subsample_mode != NO_SUBSAMPLE_SWEEP) {
+                                                                    if(!parse_sweep_percents(argv[28], sweep_percents)) {
+                                                                        cerr << "error. the sweep percentages should be a comma separated list of values in (0, 100], not " << argv[28] << endl;
+                                                                        return -1;
+                                                                    }
+                                                                }
+                                                                if(argc >= 30) {
+                                                                    num_probe_queries = stoull(argv[29],nullptr,0);
+                                                                }
+                                                            }
+                                                        }
+                                                    }
+                                                }
+                                            }
+                                        }
+                                    }
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
     if(DEBUG) {
         cout << "USE_MPI: " << USE_MPI << endl;
         cout << "num_procs_to_test: " << num_procs_to_test << endl;
         cout << "comm_size: " << comm_size << endl;
         cout << "rank: " << rank << endl;
         cout << "valgrind: " << valgrind << endl;
+        cout << "num_threads: " << num_threads << endl;
+        cout << "max_batch_size: " << max_batch_size << endl;
+        cout << "count_only_queries: " << count_only_queries << endl;
+        cout << "use_perf_counters: " << use_perf_counters << endl;
+        cout << "use_mesh_snapshot: " << use_mesh_snapshot << endl;
+        cout << "retrieve_nodes_for_bboxes: " << retrieve_nodes_for_bboxes << endl;
+        cout << "data_source: " << data_source << endl;
+        cout << "num_synthetic_data_pts: " << num_synthetic_data_pts << endl;
+        cout << "query_selectivities.size(): " << query_selectivities.size() << endl;
+        cout << "query_trace_mode: " << query_trace_mode << endl;
+        cout << "query_trace_path: " << query_trace_path << endl;
+        cout << "query_set: " << query_set << endl;
+        cout << "query_overlap: " << query_overlap << endl;
+        cout << "mesh_tiling: " << mesh_tiling << endl;
+        cout << "mesh_jitter: " << mesh_jitter << endl;
+        cout << "subsample_mode: " << subsample_mode << endl;
+        cout << "sweep_percents.size(): " << sweep_percents.size() << endl;
+        cout << "num_probe_queries: " << num_probe_queries << endl;
     }
 
+    QueryTimer::calibrate();
+
     for(size_t i = 0; i < num_procs_to_test; i++) {
         if(num_procs_to_test > 1) {
             rank = i;
@@ -75,12 +196,81 @@ int main(int argc, char **argv) {
         vector<point> mesh_coordinates;
         bbox domain_bounds;
         uint32_t num_data_pts;
-        std::vector<std::vector<size_t>> element_node_ids;
-        if(data_type == POINTS) {
-            get_data_from_exodus_file(data_type, my_mesh_file, mesh_coordinates, domain_bounds, num_data_pts);
+        element_connectivity element_node_ids;
+        element_connectivity *snapshot_node_ids = (data_type == POINTS) ? nullptr : &element_node_ids;
+        string snapshot_path = get_mesh_snapshot_path(my_mesh_file, data_type);
+        bool loaded_from_snapshot = false;
+
+        if(data_type == TRIANGLES && retrieve_nodes_for_bboxes) {
+            cerr << "error. the nodes can only be retrieved for bboxes. counting the triangles instead" << endl;
+            retrieve_nodes_for_bboxes = false;
         }
-        else {
-            get_data_from_exodus_file(data_type, my_mesh_file, mesh_coordinates, domain_bounds, num_data_pts, element_node_ids);
+
+        //synthetic data has no elements, so there are no nodes to retrieve, and it is generated too quickly to be worth a snapshot
+        if(data_source != EXODUS_MESH) {
+            if(retrieve_nodes_for_bboxes) {
+                cerr << "error. synthetic data has no element connectivity, so the nodes for bboxes can't be retrieved. counting the ";
+                cerr << ((data_type == POINTS) ? "data points" : "bboxes") << " instead" << endl;
+                retrieve_nodes_for_bboxes = false;
+            }
+            use_mesh_snapshot = false;
+        }
+
+        //the probes are located in the elements' exact shapes, so they need the mesh's connectivity and node coordinates
+        if(num_probe_queries > 0) {
+            if(data_type != BBOXES || data_source != EXODUS_MESH) {
+                cerr << "error. probe queries are only supported for bboxes from an exodus mesh. skipping them" << endl;
+                num_probe_queries = 0;
+            }
+            else if(mesh_jitter > 0) {
+                cerr << "error. jittering moves the bboxes away from their elements' nodes. skipping the probe queries" << endl;
+                num_probe_queries = 0;
+            }
+            else if(use_mesh_snapshot) {
+                cerr << "error. the mesh snapshot doesn't store the node coordinates that probe queries need. reading the exodus file instead" << endl;
+                use_mesh_snapshot = false;
+            }
+        }
+
+        std::chrono::high_resolution_clock::time_point load_start_time = std::chrono::high_resolution_clock::now();
+        if(data_source != EXODUS_MESH) {
+            //each rank generates its own slice of one global data set
+            get_synthetic_data(data_source, data_type, num_synthetic_data_pts, rank*num_synthetic_data_pts, mesh_coordinates, domain_bounds);
+            num_data_pts = num_synthetic_data_pts;
+        }
+        else if(use_mesh_snapshot) {
+            loaded_from_snapshot = read_mesh_snapshot(snapshot_path, my_mesh_file, data_type, retrieve_nodes_for_bboxes, mesh_coordinates, domain_bounds, num_data_pts, snapshot_node_ids);
+        }
+        if(data_source == EXODUS_MESH && !loaded_from_snapshot) {
+            if(data_type == POINTS) {
+                get_data_from_exodus_file(data_type, my_mesh_file, mesh_coordinates, domain_bounds, num_data_pts);
+            }
+            else {
+                get_data_from_exodus_file(data_type, my_mesh_file, mesh_coordinates, domain_bounds, num_data_pts, retrieve_nodes_for_bboxes, element_node_ids, 
+                    num_probe_queries > 0);
+            }
+        }
+        std::chrono::high_resolution_clock::time_point load_stop_time = std::chrono::high_resolution_clock::now();
+        uint64_t load_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(load_stop_time - load_start_time).count();
+
+        //not part of the load time, so the exodus rows stay comparable to runs without the snapshot
+        if(use_mesh_snapshot && !loaded_from_snapshot) {
+            if(!write_mesh_snapshot(snapshot_path, my_mesh_file, data_type, retrieve_nodes_for_bboxes, mesh_coordinates, domain_bounds, num_data_pts, snapshot_node_ids)) {
+                cerr << "error. could not write the mesh snapshot: " << snapshot_path << endl;
+            }
+        }
+
+        //done after the snapshot is written, so the snapshot stays the untiled partition. the tiling is part of the load time
+        if(mesh_tiling != "0" || mesh_jitter > 0) {
+            size_t tiles[NUM_DIMS];
+            if(!parse_mesh_tiling(mesh_tiling, num_data_pts, tiles)) {
+                cerr << "error. the mesh tiling should be kxlxm or a number of data points, not " << mesh_tiling << endl;
+                return -1;
+            }
+            std::chrono::high_resolution_clock::time_point tiling_start_time = std::chrono::high_resolution_clock::now();
+            tile_mesh(data_type, tiles, mesh_jitter, mesh_coordinates, domain_bounds, num_data_pts, element_node_ids);
+            std::chrono::high_resolution_clock::time_point tiling_stop_time = std::chrono::high_resolution_clock::now();
+            load_time_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(tiling_stop_time - tiling_start_time).count();
         }
         
         if(DEBUG) {
@@ -91,21 +281,51 @@ int main(int argc, char **argv) {
         }
 
         std::vector<size_t> indices; // vector with 100 ints.
-        if(data_type == POINTS) {
-            indices.resize(mesh_coordinates.size());
-        }
-        else if(data_type == BBOXES) {
-            //only have 1 index for every box (every 2 points)
-            indices.resize(mesh_coordinates.size()/2);        
-        }
+        //only have 1 index for every box (every 2 points) or triangle (every 3 points)
+        indices.resize(mesh_coordinates.size() / get_pts_per_item(data_type));
         std::iota (std::begin(indices), std::end(indices), 0); // Fill with 0, 1, ..., indices.size()-1
 
-        testing_config config(domain_bounds.first, domain_bounds.second, num_data_pts, num_queries, library, data_type, library_option);
+        std::vector<double> domain_lower_bounds(domain_bounds.first.begin(), domain_bounds.first.end());
+        std::vector<double> domain_upper_bounds(domain_bounds.second.begin(), domain_bounds.second.end());
+        testing_config config(domain_lower_bounds, domain_upper_bounds, num_data_pts, num_queries, library, data_type, library_option, num_threads, max_batch_size, count_only_queries, use_perf_counters, retrieve_nodes_for_bboxes);
+        config.query_selectivities = query_selectivities;
+        config.query_trace_mode = query_trace_mode;
+        config.query_trace_path = get_query_trace_path(query_trace_path, rank, comm_size);
+        config.query_set = query_set;
+        config.query_overlap = query_overlap;
+        config.num_probe_queries = num_probe_queries;
         if(rank == 0) {
-            print_results_header();        
+            print_results_header(use_perf_counters);        
         }
+        print_load_time(data_source, loaded_from_snapshot, load_time_ns, config);
 
-        perform_test(mesh_coordinates, indices, config, element_node_ids);        
+        if(subsample_mode == NO_SUBSAMPLE_SWEEP) {
+            perform_test(mesh_coordinates, indices, config, element_node_ids);        
+        }
+        else {
+            //the partition is only loaded once. each size is a prefix of the same order, so the subsamples are nested
+            std::vector<size_t> subsample_order = get_subsample_order(subsample_mode, data_type, mesh_coordinates, domain_bounds);
+            start_sweep_recording();
+            for(double percent : sweep_percents) {
+                size_t num_items = std::max((size_t)1, (size_t)std::llround(percent / 100 * indices.size()));
+                vector<point> subsample_coordinates;
+                bbox subsample_bounds;
+                uint32_t subsample_num_data_pts;
+                element_connectivity subsample_node_ids;
+                get_subsample(data_type, mesh_coordinates, subsample_order, num_items, retrieve_nodes_for_bboxes, element_node_ids, 
+                    subsample_coordinates, subsample_bounds, subsample_num_data_pts, subsample_node_ids);
+
+                std::vector<size_t> subsample_indices(num_items);
+                std::iota(std::begin(subsample_indices), std::end(subsample_indices), 0);
+                testing_config subsample_config = config;
+                subsample_config.num_data_pts = subsample_num_data_pts;
+                subsample_config.query_trace_path = get_subsample_query_trace_path(config.query_trace_path, percent);
+                subsample_config.domain_lower_bounds.assign(subsample_bounds.first.begin(), subsample_bounds.first.end());
+                subsample_config.domain_upper_bounds.assign(subsample_bounds.second.begin(), subsample_bounds.second.end());
+                perform_test(subsample_coordinates, subsample_indices, subsample_config, subsample_node_ids);
+            }
+            print_complexity_exponents(config);
+        }
     }
     
 
@@ -116,8 +336,12 @@ int main(int argc, char **argv) {
 }
 
 void perform_test(const vector<point> &mesh_coordinates, const vector<size_t> &indices, const testing_config &config, 
-    const std::vector<std::vector<size_t>> &element_node_ids) 
+    const element_connectivity &element_node_ids) 
 {
+    //stopped by print_build_time. starting here only adds the construction of the (empty) test object to the build's counts
+    if(config.use_perf_counters) {
+        phase_perf_counters().start();
+    }
 
     switch(config.library) {
         #ifdef TEST_ALGLIB
@@ -152,6 +376,9 @@ void perform_test(const vector<point> &mesh_coordinates, const vector<size_t> &i
                 else if(config.data_type == BBOXES) {
                     test_boost_bboxes(mesh_coordinates, indices, config, element_node_ids);
                 }
+                else if(config.data_type == TRIANGLES) {
+                    test_boost_faces(mesh_coordinates, indices, config);
+                }
                 else {
                     cerr << "error. data_type " << config.data_type << " not defined for library " << config.library << endl;
                     exit(-1);
@@ -166,6 +393,65 @@ void perform_test(const vector<point> &mesh_coordinates, const vector<size_t> &i
                 else if(config.data_type == BBOXES) {
                     test_brute_force_bboxes(mesh_coordinates, indices, config, element_node_ids);
                 }
+                else if(config.data_type == TRIANGLES) {
+                    test_brute_force_faces(mesh_coordinates, indices, config);
+                }
+                else {
+                    cerr << "error. data_type " << config.data_type << " not defined for library " << config.library << endl;
+                    exit(-1);
+                }
+                break;
+            }
+            case NATIVE_KDTREE : {
+                if(config.data_type == POINTS) {
+                    test_native_kdtree_points(mesh_coordinates, indices, config);
+                }
+                else if(config.data_type == BBOXES) {
+                    test_native_kdtree_bboxes(mesh_coordinates, indices, config, element_node_ids);
+                }
+                else {
+                    cerr << "error. data_type " << config.data_type << " not defined for library " << config.library << endl;
+                    exit(-1);
+                }
+                break;
+            }
+            case NATIVE_RTREE : {
+                if(config.data_type == BBOXES) {
+                    test_native_rtree_bboxes(mesh_coordinates, indices, config, element_node_ids);
+                }
+                else {
+                    cerr << "error. data_type " << config.data_type << " not defined for library " << config.library << endl;
+                    exit(-1);
+                }
+                break;
+            }
+            case UNIFORM_GRID : {
+                if(config.data_type == POINTS) {
+                    test_uniform_grid_points(mesh_coordinates, indices, config);
+                }
+                else if(config.data_type == BBOXES) {
+                    test_uniform_grid_bboxes(mesh_coordinates, indices, config, element_node_ids);
+                }
+                else {
+                    cerr << "error. data_type " << config.data_type << " not defined for library " << config.library << endl;
+                    exit(-1);
+                }
+                break;
+            }
+            case LINEAR_OCTREE : {
+                if(config.data_type == POINTS) {
+                    test_linear_octree_points(mesh_coordinates, indices, config);
+                }
+                else {
+                    cerr << "error. data_type " << config.data_type << " not defined for library " << config.library << endl;
+                    exit(-1);
+                }
+                break;
+            }
+            case WIDE_BVH : {
+                if(config.data_type == BBOXES) {
+                    test_wide_bvh_bboxes(mesh_coordinates, indices, config, element_node_ids);
+                }
                 else {
                     cerr << "error. data_type " << config.data_type << " not defined for library " << config.library << endl;
                     exit(-1);
@@ -180,6 +466,9 @@ void perform_test(const vector<point> &mesh_coordinates, const vector<size_t> &i
                 else if(config.data_type == BBOXES) {
                     test_cgal_bboxes(mesh_coordinates, indices, config, element_node_ids);
                 }
+                else if(config.data_type == TRIANGLES) {
+                    test_cgal_faces(mesh_coordinates, indices, config);
+                }
                 else {
                     cerr << "error. data_type " << config.data_type << " not defined for library " << config.library << endl;
                     exit(-1);
@@ -313,6 +602,9 @@ void perform_test(const vector<point> &mesh_coordinates, const vector<size_t> &i
                 else if(config.data_type == BBOXES) {
                     test_libspatialindex_bboxes(mesh_coordinates, indices, config, element_node_ids);
                 }
+                else if(config.data_type == TRIANGLES) {
+                    test_libspatialindex_faces(mesh_coordinates, indices, config);
+                }
                 else {
                     cerr << "error. data_type " << config.data_type << " not defined for library " << config.library << endl;
                     exit(-1);
@@ -381,6 +673,9 @@ void perform_test(const vector<point> &mesh_coordinates, const vector<size_t> &i
                 else if(config.data_type == BBOXES) {
                     test_rtree_template_bboxes(mesh_coordinates, indices, config, element_node_ids);
                 }
+                else if(config.data_type == TRIANGLES) {
+                    test_rtree_template_faces(mesh_coordinates, indices, config);
+                }
                 else {
                     cerr << "error. data_type " << config.data_type << " not defined for library " << config.library << endl;
                     exit(-1);
@@ -1,7 +1,9 @@
 #include <boost/random.hpp> //needed for random range generation
 #include "common.hh"
+#include "counter_rng.hh"
 #include "exodusII.h"
 #include <thread>
+#include <numeric>
 
 #ifndef DOMAIN_LENGTH
     #error Your need to define DOMAIN_LENGTH in a common header file
@@ -9,6 +11,15 @@
 
 using namespace std;
 
+//calibrated queries are sized against (at most) this many of the data items
+#define CALIBRATION_MAX_SAMPLE_SIZE (1 << 20)
+#define CALIBRATION_SEED 200
+#define QUERY_SET_SEED 300
+#define NUM_HOTSPOTS 64
+#define ZIPF_EXPONENT 1.0
+//hotspot queries are shifted from their hotspot by a normally distributed offset with this standard deviation (as a fraction of the box's size)
+#define HOTSPOT_JITTER .1
+
 void get_queries_specific_feature_sizes(testing_config config, std::vector<std::vector<bbox>> &all_queries, std::vector<double> &queries_percent_data_covered
     ) 
 {
@@ -86,8 +97,9 @@ void get_queries_specific_feature_sizes(testing_config config, std::vector<std::
         cout << "config.domain_lower_bounds.size(): " << config.domain_lower_bounds.size() << endl;
     }
     for(size_t i = 0; i < all_query_sizes.size(); i++) {
+        all_queries[i].reserve(num_queries[i]);
         for(size_t j = 0; j < num_queries[i]; j++) {
-            point query_lower_corner(config.domain_lower_bounds.size()), query_upper_corner(config.domain_lower_bounds.size());
+            point query_lower_corner, query_upper_corner;
             for(size_t k = 0; k < config.domain_lower_bounds.size(); k++) {
                 query_lower_corner[k] = generators[i][k]();
                 double len = all_query_sizes[i][k];
@@ -114,6 +126,229 @@ void get_queries_specific_feature_sizes(testing_config config, std::vector<std::
     }
 }
 
+std::vector<double> get_log_spaced_selectivities(double min_percent, double max_percent, size_t num_selectivities) {
+    std::vector<double> selectivities;
+    for(size_t i = 0; i < num_selectivities; i++) {
+        double fraction = (num_selectivities == 1) ? 0 : i / (double)(num_selectivities - 1);
+        selectivities.push_back(min_percent * std::pow(max_percent / min_percent, fraction));
+    }
+    return selectivities;
+}
+
+bool parse_selectivity_range(const std::string &range, std::vector<double> &selectivities) {
+    size_t first_colon = range.find(':');
+    size_t second_colon = (first_colon == std::string::npos) ? std::string::npos : range.find(':', first_colon + 1);
+    if(second_colon == std::string::npos) {
+        return false;
+    }
+    try {
+        double min_percent = std::stod(range.substr(0, first_colon));
+        double max_percent = std::stod(range.substr(first_colon + 1, second_colon - first_colon - 1));
+        size_t num_selectivities = std::stoull(range.substr(second_colon + 1));
+        if(min_percent <= 0 || max_percent < min_percent || max_percent > 100 || num_selectivities == 0) {
+            return false;
+        }
+        selectivities = get_log_spaced_selectivities(min_percent, max_percent, num_selectivities);
+    }
+    catch(const std::exception &e) {
+        return false;
+    }
+    return true;
+}
+
+//how far outside the query box's scaled extents the item is, in units of the domain's half lengths. a box around the centre
+//whose half extents are scale * the domain's half lengths intersects the item iff its distance is <= scale
+static double get_scaled_distance(const bbox &item, const point &center, const double *half_lengths) {
+    double distance = 0;
+    for(int d = 0; d < NUM_DIMS; d++) {
+        double gap = std::max(std::max(item.first[d] - center[d], center[d] - item.second[d]), 0.0);
+        distance = std::max(distance, gap / half_lengths[d]);
+    }
+    return distance;
+}
+
+void get_queries_calibrated_selectivity(testing_config config, const std::vector<point> &pts, 
+    std::vector<std::vector<bbox>> &all_queries, std::vector<double> &queries_percent_data_covered) 
+{
+    size_t num_items = pts.size() / get_pts_per_item(config.data_type);
+    if(num_items == 0) {
+        std::cerr << "error. can't calibrate queries without any data" << std::endl;
+        return;
+    }
+    //points are stored as degenerate boxes and triangles as their bounding boxes, so every data type is handled the same way
+    std::vector<bbox> sample;
+    size_t sample_size = std::min(num_items, (size_t)CALIBRATION_MAX_SAMPLE_SIZE);
+    sample.reserve(sample_size);
+    for(size_t i = 0; i < sample_size; i++) {
+        size_t item = (sample_size == num_items) ? i : 
+            std::min((size_t)(counter_rng_uniform(CALIBRATION_SEED, i) * num_items), num_items - 1);
+        sample.push_back(get_item_bbox(config.data_type, pts, item));
+    }
+
+    double half_lengths[NUM_DIMS];
+    for(int d = 0; d < NUM_DIMS; d++) {
+        half_lengths[d] = (config.domain_upper_bounds[d] - config.domain_lower_bounds[d]) / 2;
+        if(half_lengths[d] <= 0) {
+            half_lengths[d] = 1;
+        }
+    }
+
+    queries_percent_data_covered = config.query_selectivities;
+    all_queries.assign(config.query_selectivities.size(), std::vector<bbox>());
+    for(size_t i = 0; i < config.query_selectivities.size(); i++) {
+        double target_percent = config.query_selectivities[i];
+        //the number of sample items the query should intersect
+        double target_count = target_percent / 100 * sample_size;
+        if(target_count < 1) {
+            std::cerr << "error. a sample of " << sample_size << " items is too small to calibrate queries covering " << target_percent 
+                << "% of the data. they will each cover about 1 item of the sample instead" << std::endl;
+        }
+        size_t kth_nearest = std::min(std::max((size_t)std::llround(target_count), (size_t)1), sample_size) - 1;
+
+        //only do 1/10 as many queries of the extra large sizes to save time, like the fixed feature sizes
+        size_t num_queries = (target_percent >= 10) ? config.num_queries/10 : config.num_queries;
+        all_queries[i].resize(num_queries);
+
+        #pragma omp parallel
+        {
+            std::vector<double> distances(sample_size);
+            #pragma omp for
+            for(int64_t j = 0; j < (int64_t)num_queries; j++) {
+                //centred on a data item, so the queries follow the data's density instead of landing in empty space
+                uint64_t counter = i * config.num_queries + j;
+                size_t center_item = std::min((size_t)(counter_rng_uniform(CALIBRATION_SEED + 1, counter) * num_items), num_items - 1);
+                bbox center_bbox = get_item_bbox(config.data_type, pts, center_item);
+                point center;
+                for(int d = 0; d < NUM_DIMS; d++) {
+                    center[d] = (center_bbox.first[d] + center_bbox.second[d]) / 2;
+                }
+                for(size_t k = 0; k < sample_size; k++) {
+                    distances[k] = get_scaled_distance(sample[k], center, half_lengths);
+                }
+                //the smallest box that reaches the target count is the one scaled to the kth smallest distance
+                std::nth_element(distances.begin(), distances.begin() + kth_nearest, distances.end());
+                double scale = distances[kth_nearest];
+                //on structured data many items can be tied at that distance, so the box may overshoot. if so, shrinking it 
+                //to the next smaller distance (which drops every tied item) may land closer to the target
+                double smaller_scale = -1;
+                size_t num_within_scale = 0;
+                for(size_t k = 0; k < sample_size; k++) {
+                    if(distances[k] < scale) {
+                        smaller_scale = std::max(smaller_scale, distances[k]);
+                    }
+                    else if(distances[k] == scale) {
+                        num_within_scale++;
+                    }
+                }
+                size_t num_within_smaller_scale = kth_nearest + 1;
+                for(size_t k = 0; k <= kth_nearest; k++) {
+                    num_within_smaller_scale -= (distances[k] == scale);
+                }
+                num_within_scale += num_within_smaller_scale;
+                if(smaller_scale >= 0 && std::fabs(num_within_smaller_scale - target_count) < std::fabs(num_within_scale - target_count)) {
+                    scale = smaller_scale;
+                }
+
+                point query_lower_corner, query_upper_corner;
+                for(int d = 0; d < NUM_DIMS; d++) {
+                    query_lower_corner[d] = center[d] - scale * half_lengths[d];
+                    query_upper_corner[d] = center[d] + scale * half_lengths[d];
+                }
+                all_queries[i][j] = bbox(query_lower_corner, query_upper_corner);
+            }
+        }
+    }
+    if(DEBUG) {
+        std::cout << "done with get_queries_calibrated_selectivity" << std::endl;
+    }
+}
+
+static point get_center(const bbox &box) {
+    point center;
+    for(int d = 0; d < NUM_DIMS; d++) {
+        center[d] = (box.first[d] + box.second[d]) / 2;
+    }
+    return center;
+}
+
+static bbox move_to_center(const bbox &box, const point &center) {
+    point lower_corner, upper_corner;
+    for(int d = 0; d < NUM_DIMS; d++) {
+        double half_length = (box.second[d] - box.first[d]) / 2;
+        lower_corner[d] = center[d] - half_length;
+        upper_corner[d] = center[d] + half_length;
+    }
+    return bbox(lower_corner, upper_corner);
+}
+
+void apply_query_set(testing_config config, std::vector<std::vector<bbox>> &all_queries) {
+    if(config.query_set == UNIFORM_QUERIES) {
+        return;
+    }
+    if(config.query_set == HOTSPOT_QUERIES) {
+        //the same hotspots are used for every category
+        std::vector<point> hotspots(NUM_HOTSPOTS);
+        for(size_t h = 0; h < NUM_HOTSPOTS; h++) {
+            for(int d = 0; d < NUM_DIMS; d++) {
+                double u = counter_rng_uniform(QUERY_SET_SEED, h*NUM_DIMS + d);
+                hotspots[h][d] = config.domain_lower_bounds[d] + u * (config.domain_upper_bounds[d] - config.domain_lower_bounds[d]);
+            }
+        }
+        //hotspot h (0-based) is picked with probability proportional to 1/(h+1)^ZIPF_EXPONENT
+        std::vector<double> cumulative_probabilities(NUM_HOTSPOTS);
+        double total = 0;
+        for(size_t h = 0; h < NUM_HOTSPOTS; h++) {
+            total += 1 / std::pow(h + 1, ZIPF_EXPONENT);
+            cumulative_probabilities[h] = total;
+        }
+
+        for(size_t i = 0; i < all_queries.size(); i++) {
+            for(size_t j = 0; j < all_queries[i].size(); j++) {
+                uint64_t first_counter = ((i << 32) + j) * 8;
+                double u = counter_rng_uniform(QUERY_SET_SEED + 1, first_counter) * total;
+                size_t hotspot = std::min((size_t)(std::upper_bound(cumulative_probabilities.begin(), cumulative_probabilities.end(), u) 
+                    - cumulative_probabilities.begin()), (size_t)NUM_HOTSPOTS-1);
+                point center;
+                for(int d = 0; d < NUM_DIMS; d++) {
+                    double length = all_queries[i][j].second[d] - all_queries[i][j].first[d];
+                    center[d] = hotspots[hotspot][d] + HOTSPOT_JITTER * length * counter_rng_normal(QUERY_SET_SEED + 1, first_counter + 1 + 2*d);
+                }
+                all_queries[i][j] = move_to_center(all_queries[i][j], center);
+            }
+        }
+    }
+    else if(config.query_set == RANDOM_WALK_QUERIES) {
+        double overlap = std::min(std::max(config.query_overlap, 0.0), 1.0);
+        //stepping every dimension by this fraction of the box's length leaves overlap of its volume shared with the previous box
+        double step_fraction = 1 - std::cbrt(overlap);
+        for(size_t i = 0; i < all_queries.size(); i++) {
+            if(all_queries[i].empty()) {
+                continue;
+            }
+            //each category starts its walk from where its first query was placed
+            point center = get_center(all_queries[i][0]);
+            for(size_t j = 1; j < all_queries[i].size(); j++) {
+                uint64_t first_counter = ((i << 32) + j) * 8;
+                for(int d = 0; d < NUM_DIMS; d++) {
+                    double step = step_fraction * (all_queries[i][j].second[d] - all_queries[i][j].first[d]);
+                    if(counter_rng_uniform(QUERY_SET_SEED + 2, first_counter + d) < .5) {
+                        step = -step;
+                    }
+                    //bounces off the edges of the domain
+                    if(center[d] + step < config.domain_lower_bounds[d] || center[d] + step > config.domain_upper_bounds[d]) {
+                        step = -step;
+                    }
+                    center[d] += step;
+                }
+                all_queries[i][j] = move_to_center(all_queries[i][j], center);
+            }
+        }
+    }
+    else {
+        std::cerr << "error. unknown query set " << config.query_set << ". using uniform queries" << std::endl;
+    }
+}
+
 void get_queries_random_feature_sizes(testing_config config, std::vector<bbox> &queries) {
     boost::mt19937 rng;
     //want it to be reproducible
@@ -157,7 +392,9 @@ void get_small_queries(std::vector<bbox> &queries) {
     queries.push_back(std::make_pair(point({.5,.5,.5}),point({1,1,1})));
 }
 
-void get_random_data(testing_config config, std::vector<point> &pts, std::vector<size_t> &indices) {
+//T is the coordinate type the points are stored in (e.g., float for reduced precision runs). they are still generated in double precision
+template <class T>
+void get_random_data(testing_config config, std::vector<scalar_point<T>> &pts, std::vector<size_t> &indices) {
     boost::mt19937 rng;
     //want it to be reproducible
     rng.seed(100);
@@ -185,11 +422,13 @@ void get_random_data(testing_config config, std::vector<point> &pts, std::vector
     }
 
     if(config.data_type == POINTS) {
+        pts.reserve(config.num_data_pts);
+        indices.reserve(config.num_data_pts);
         for(size_t i = 0; i < config.num_data_pts; i++) {
             double x = rnd_x();
             double y = rnd_y();
             double z = rnd_z();
-            pts.push_back(point({x, y, z}));
+            pts.push_back(scalar_point<T>{{(T)x, (T)y, (T)z}});
             indices.push_back(i);
 
             if(DEBUG) {
@@ -201,6 +440,8 @@ void get_random_data(testing_config config, std::vector<point> &pts, std::vector
         }        
     }
     else if(config.data_type == BBOXES) {
+        pts.reserve(2*config.num_data_pts);
+        indices.reserve(config.num_data_pts);
         for(size_t i = 0; i < config.num_data_pts; i++) {
             double x = rnd_x();
             double y = rnd_y();
@@ -208,18 +449,20 @@ void get_random_data(testing_config config, std::vector<point> &pts, std::vector
             double x_len = rnd_length_x();
             double y_len = rnd_length_y();
             double z_len = rnd_length_z();
-            pts.push_back(point({x, y, z}));
-            pts.push_back(point({x+x_len, y+y_len, z+z_len}));
+            pts.push_back(scalar_point<T>{{(T)x, (T)y, (T)z}});
+            pts.push_back(scalar_point<T>{{(T)(x+x_len), (T)(y+y_len), (T)(z+z_len)}});
             indices.push_back(i);
             if(DEBUG) {
                 if(i < 100) {
                     std::cout << "box: ";
-                    print_bbox(bbox(pts[pts.size()-2], pts.back()));
+                    print_bbox(scalar_bbox<T>(pts[pts.size()-2], pts.back()));
                 }
             }
         }        
     }
     else if(config.data_type == TRIANGLES) {
+        pts.reserve(3*config.num_data_pts);
+        indices.reserve(config.num_data_pts);
         for(size_t i = 0; i < config.num_data_pts; i++) {
             double x = rnd_x();
             double y = rnd_y();
@@ -230,9 +473,9 @@ void get_random_data(testing_config config, std::vector<point> &pts, std::vector
             double x_len2 = rnd_length_x();
             double y_len2 = rnd_length_y();
             double z_len2 = rnd_length_z();
-            pts.push_back(point({x, y, z}));
-            pts.push_back(point({x+x_len, y+y_len, z+z_len}));
-            pts.push_back(point({x+x_len2, y+y_len2, z+z_len2}));
+            pts.push_back(scalar_point<T>{{(T)x, (T)y, (T)z}});
+            pts.push_back(scalar_point<T>{{(T)(x+x_len), (T)(y+y_len), (T)(z+z_len)}});
+            pts.push_back(scalar_point<T>{{(T)(x+x_len2), (T)(y+y_len2), (T)(z+z_len2)}});
             indices.push_back(i);
             if(DEBUG) {
                 if(i < 100) {
@@ -252,6 +495,9 @@ void get_random_data(testing_config config, std::vector<point> &pts, std::vector
     }
 }
 
+template void get_random_data<double>(testing_config config, std::vector<point> &pts, std::vector<size_t> &indices);
+template void get_random_data<float>(testing_config config, std::vector<point_f> &pts, std::vector<size_t> &indices);
+
 void get_regular_mesh_data(testing_config config, std::vector<point> &pts, std::vector<size_t> &indices) {
     if(DEBUG) {
         std::cout << "about to make points" << std::endl;
@@ -312,8 +558,10 @@ int exodus_open_file(std::string file_name) {
     while(exodus_id < 0 && retry_count < 100) {
         exodus_id = ex_open (file_name.c_str(), EX_READ, &cpu_word_size, &io_word_size, &database_version);
         retry_count += 1;
-        //sleep just in case there is file system contention
-        std::this_thread::sleep_for(1000ms);
+        //sleep just in case there is file system contention. only on failure, otherwise every load pays for it
+        if(exodus_id < 0) {
+            std::this_thread::sleep_for(1000ms);
+        }
     }
     if(exodus_id < 0) {
         std::cerr << "error in ex_open" << std::endl;
@@ -342,9 +590,12 @@ void exodus_read_vertex_coordinates(int exodus_id, vector<double> &x_coords, vec
 }
 
 
+//reads the coordinates with ex_get_partial_coord in chunks of this many nodes, so the x/y/z staging buffers stay small for large partitions
+#define EXODUS_READ_CHUNK_SIZE (1 << 20)
+
 void exodus_read_vertex_coordinates(int exodus_id, std::vector<point> &coords, bbox &domain_bounds, uint32_t &num_nodes) {
-    double domain_lower_bounds[3] = {DBL_MAX, DBL_MAX, DBL_MAX};
-    double domain_upper_bounds[3] = {-DBL_MAX, -DBL_MAX, -DBL_MAX};
+    double min_x = DBL_MAX, min_y = DBL_MAX, min_z = DBL_MAX;
+    double max_x = -DBL_MAX, max_y = -DBL_MAX, max_z = -DBL_MAX;
 
     int num_dim, num_elem, num_elem_blocks, num_node_sets, num_side_sets;
     char  db_title[MAX_STR_LENGTH];
@@ -353,30 +604,35 @@ void exodus_read_vertex_coordinates(int exodus_id, std::vector<point> &coords, b
         exit(-1);             
     }
 
-    vector<double> x_coords, y_coords, z_coords;
-    x_coords.resize(num_nodes);
-    y_coords.resize(num_nodes);
-    z_coords.resize(num_nodes); 
-    if(ex_get_coord(exodus_id , &x_coords[0], &y_coords[0], &z_coords[0])) {
-        std::cerr << "error in ex_get_coord" << std::endl;
-        exit(-1);     
-    }
-
-    for(int i = 0; i < num_nodes; i++) {
-        coords.push_back(point({x_coords[i], y_coords[i], z_coords[i]}));
+    //sized once, then each chunk is written into place in parallel
+    size_t first_coord = coords.size();
+    coords.resize(first_coord + num_nodes);
+
+    size_t chunk_size = std::min((size_t)EXODUS_READ_CHUNK_SIZE, (size_t)num_nodes);
+    vector<double> x_coords(chunk_size), y_coords(chunk_size), z_coords(chunk_size);
+    for(size_t chunk_start = 0; chunk_start < num_nodes; chunk_start += chunk_size) {
+        int64_t num_chunk_nodes = std::min(chunk_size, num_nodes - chunk_start);
+        //exodus node numbers start at 1
+        if(ex_get_partial_coord(exodus_id, chunk_start + 1, num_chunk_nodes, &x_coords[0], &y_coords[0], &z_coords[0])) {
+            std::cerr << "error in ex_get_partial_coord" << std::endl;
+            exit(-1);     
+        }
 
-        domain_lower_bounds[0] = std::min(domain_lower_bounds[0], x_coords[i]);
-        domain_upper_bounds[0] = std::max(domain_upper_bounds[0], x_coords[i]);
-        domain_lower_bounds[1] = std::min(domain_lower_bounds[1], y_coords[i]);
-        domain_upper_bounds[1] = std::max(domain_upper_bounds[1], y_coords[i]);
-        domain_lower_bounds[2] = std::min(domain_lower_bounds[2], z_coords[i]);
-        domain_upper_bounds[2] = std::max(domain_upper_bounds[2], z_coords[i]);
+        point *chunk_coords = &coords[first_coord + chunk_start];
+        #pragma omp parallel for reduction(min:min_x,min_y,min_z) reduction(max:max_x,max_y,max_z)
+        for(int64_t i = 0; i < num_chunk_nodes; i++) {
+            chunk_coords[i] = point({x_coords[i], y_coords[i], z_coords[i]});
+
+            min_x = std::min(min_x, x_coords[i]);
+            max_x = std::max(max_x, x_coords[i]);
+            min_y = std::min(min_y, y_coords[i]);
+            max_y = std::max(max_y, y_coords[i]);
+            min_z = std::min(min_z, z_coords[i]);
+            max_z = std::max(max_z, z_coords[i]);
+        }
     }
 
-
-    domain_bounds = bbox(point({domain_lower_bounds[0], domain_lower_bounds[1], domain_lower_bounds[2]}), 
-                         point({domain_upper_bounds[0], domain_upper_bounds[1], domain_upper_bounds[2]})
-                    );
+    domain_bounds = bbox(point({min_x, min_y, min_z}), point({max_x, max_y, max_z}));
 }
 
 
@@ -387,37 +643,62 @@ void exodus_read_vertex_coordinates(const std::string &full_file_path, std::vect
 }
 
 
-void exodus_get_element_connectivity(int exodus_id, int elem_block_id, vector<uint32_t> &node_connectivity, uint32_t &num_nodes_per_elem) {
-    int error, num_elem_in_block, num_edges_per_elem, num_faces_per_elem, num_attr_per_elem;
+//reads the block's node connectivity (exodus' node ids, which start at 1) into node_connectivity, which has to fit every element's nodes
+static void exodus_read_block_connectivity(int exodus_id, int elem_block_id, uint32_t *node_connectivity) {
+    int num_elem_in_block, num_edges_per_elem, num_faces_per_elem, num_attr_per_elem;
+    uint32_t num_nodes_per_elem;
     char elem_description[MAX_STR_LENGTH +1];
-
     if(ex_get_block(exodus_id, EX_ELEM_BLOCK, elem_block_id, elem_description, &num_elem_in_block, &num_nodes_per_elem, &num_edges_per_elem, &num_faces_per_elem, &num_attr_per_elem)) {
         cerr << "error with ex_get_block" << endl;
         exit(-1);
     }
-    else {
-        if(num_elem_in_block > 0) {
-            /* read  element  connectivity  */
-            int *edge_connectivity = (int *)  calloc(num_edges_per_elem*num_elem_in_block ,sizeof(int ));
-            int *face_connectivity = (int *)  calloc(num_faces_per_elem*num_elem_in_block ,sizeof(int ));
-            node_connectivity.resize(num_nodes_per_elem*num_elem_in_block);
-
-            if(ex_get_conn(exodus_id, EX_ELEM_BLOCK, elem_block_id, &node_connectivity[0], edge_connectivity, face_connectivity)) {
-                cerr << "error with ex_get_conn, error: " << error << endl;
-                exit(-1);
-            }
+    if(num_elem_in_block > 0) {
+        /* read  element  connectivity  */
+        int *edge_connectivity = (int *)  calloc(num_edges_per_elem*num_elem_in_block ,sizeof(int ));
+        int *face_connectivity = (int *)  calloc(num_faces_per_elem*num_elem_in_block ,sizeof(int ));
+
+        if(ex_get_conn(exodus_id, EX_ELEM_BLOCK, elem_block_id, node_connectivity, edge_connectivity, face_connectivity)) {
+            cerr << "error with ex_get_conn" << endl;
+            exit(-1);
+        }
+
+        free(edge_connectivity);
+        free(face_connectivity);    
+    }
+}
+
+//the number of elements in the block and their number of nodes and type, without reading their connectivity
+static void exodus_get_block_size(int exodus_id, int elem_block_id, size_t &num_elem_in_block, uint32_t &num_nodes_per_elem, std::string *elem_type = nullptr) {
+    int num_elems, num_edges_per_elem, num_faces_per_elem, num_attr_per_elem;
+    char elem_description[MAX_STR_LENGTH +1];
+    if(ex_get_block(exodus_id, EX_ELEM_BLOCK, elem_block_id, elem_description, &num_elems, &num_nodes_per_elem, &num_edges_per_elem, &num_faces_per_elem, &num_attr_per_elem)) {
+        cerr << "error with ex_get_block" << endl;
+        exit(-1);
+    }
+    num_elem_in_block = std::max(num_elems, 0);
+    if(elem_type != nullptr) {
+        *elem_type = elem_description;
+    }
+}
 
-            free(edge_connectivity);
-            free(face_connectivity);    
-        }  
+void exodus_get_element_connectivity(int exodus_id, int elem_block_id, vector<uint32_t> &node_connectivity, uint32_t &num_nodes_per_elem,
+    std::string *elem_type = nullptr) 
+{
+    size_t num_elem_in_block;
+    exodus_get_block_size(exodus_id, elem_block_id, num_elem_in_block, num_nodes_per_elem, elem_type);
+    node_connectivity.resize(num_nodes_per_elem*num_elem_in_block);
+    if(num_elem_in_block > 0) {
+        exodus_read_block_connectivity(exodus_id, elem_block_id, &node_connectivity[0]);
     }
 }
 
+//the coordinates are read in chunks, and each block's connectivity is read straight into the csr connectivity (or, if the connectivity
+//isn't kept, into a buffer the size of the largest block), so the only full size buffers are the node coordinates and the results
 void exodus_read_element_bboxes(const std::string &full_file_path, std::vector<point> &element_bboxes_as_pts, bbox &domain_bounds,
-    uint32_t &num_nodes, vector<vector<size_t>> &node_ids_per_elem) 
+    uint32_t &num_nodes, bool retrieve_nodes, element_connectivity &connectivity, bool keep_element_geometry = false) 
 {
-    double domain_lower_bounds[3] = {DBL_MAX, DBL_MAX, DBL_MAX};
-    double domain_upper_bounds[3] = {-DBL_MAX, -DBL_MAX, -DBL_MAX};
+    double min_x = DBL_MAX, min_y = DBL_MAX, min_z = DBL_MAX;
+    double max_x = -DBL_MAX, max_y = -DBL_MAX, max_z = -DBL_MAX;
 
     int exodus_id = exodus_open_file(full_file_path);
 
@@ -427,13 +708,11 @@ void exodus_read_element_bboxes(const std::string &full_file_path, std::vector<p
         std::cerr << "Error with ex_get_init" << std::endl;
         exit(-1);
     }
-    if(!RETRIEVE_NODES_FOR_BBOXES) {
+    uint32_t num_mesh_nodes = num_nodes;
+    if(!retrieve_nodes) {
         num_nodes = num_elem; //want to keep track of the number of bounding boxes, not the number of nodes
     }
 
-    vector<vector<uint32_t>> connectivity_lists(num_elem_blocks);
-    uint32_t num_nodes_per_elem[num_elem_blocks];
-
     /* read in the ids for the element blocks */
     vector<int> elem_block_ids(num_elem_blocks);
 
@@ -442,48 +721,236 @@ void exodus_read_element_bboxes(const std::string &full_file_path, std::vector<p
         exit(-1);
     }
 
+    //where each block's elements and node ids start, so every block is read into place and every element's bbox is written in parallel
+    vector<uint32_t> num_nodes_per_elem(num_elem_blocks);
+    vector<size_t> block_first_elem(num_elem_blocks + 1, 0);
+    vector<size_t> block_first_entry(num_elem_blocks + 1, 0);
+    size_t max_block_entries = 0;
     for(size_t i = 0; i < num_elem_blocks; i++) {
         int elem_block_id = elem_block_ids[i];
-        exodus_get_element_connectivity(exodus_id, elem_block_id, connectivity_lists[i], num_nodes_per_elem[i]);
+        std::string elem_type;
+        size_t num_block_elems;
+        exodus_get_block_size(exodus_id, elem_block_id, num_block_elems, num_nodes_per_elem[i], &elem_type);
+        block_first_elem[i+1] = block_first_elem[i] + num_block_elems;
+        block_first_entry[i+1] = block_first_entry[i] + num_block_elems*num_nodes_per_elem[i];
+        max_block_entries = std::max(max_block_entries, num_block_elems*num_nodes_per_elem[i]);
+        if(keep_element_geometry && num_block_elems > 0) {
+            std::transform(elem_type.begin(), elem_type.end(), elem_type.begin(), ::toupper);
+            bool hex8 = elem_type.compare(0, 3, "HEX") == 0 && num_nodes_per_elem[i] == 8;
+            bool tet4 = elem_type.compare(0, 3, "TET") == 0 && num_nodes_per_elem[i] == 4;
+            if(!hex8 && !tet4) {
+                cerr << "error. probe containment is only tested for HEX8 and TET4 elements. no probes will be located in element block " << elem_block_id;
+                cerr << " (" << elem_type << " with " << num_nodes_per_elem[i] << " nodes)" << endl;
+            }
+        }
+    }
+    size_t num_read_elems = block_first_elem.back();
+
+    //kept as the connectivity's node coordinates for probe queries, rather than copied
+    std::vector<point> node_coords;
+    bbox node_bounds;
+    uint32_t num_coord_nodes;
+    exodus_read_vertex_coordinates(exodus_id, node_coords, node_bounds, num_coord_nodes);
+
+    //two corner points per element
+    element_bboxes_as_pts.resize(2*num_read_elems);
+    //the node ids are only used when retrieving the nodes for bboxes or locating probes, so the connectivity is left empty otherwise.
+    //the blocks are in element order, so the csr node ids are the blocks' connectivity, one after another
+    bool keep_connectivity = retrieve_nodes || keep_element_geometry;
+    connectivity.clear();
+    vector<uint32_t> block_buffer;
+    if(keep_connectivity) {
+        connectivity.num_nodes = num_mesh_nodes;
+        connectivity.offsets.resize(num_read_elems + 1);
+        connectivity.node_ids.resize(block_first_entry.back());
+    }
+    else {
+        block_buffer.resize(max_block_entries);
     }
 
-    element_bboxes_as_pts.reserve(num_elem);
-    vector<double> x_coords, y_coords, z_coords;
-    exodus_read_vertex_coordinates(exodus_id, x_coords, y_coords, z_coords);
-    ex_close (exodus_id);
-
-    for(size_t i = 0; i < connectivity_lists.size(); i++) {
+    for(size_t i = 0; i < num_elem_blocks; i++) {
         size_t elem_size = num_nodes_per_elem[i];
-        // cout << "new elem" << endl;
-        for(size_t j = 0; j < connectivity_lists[i].size(); j += elem_size) {
+        int64_t num_block_elems = block_first_elem[i+1] - block_first_elem[i];
+        if(keep_connectivity) {
+            connectivity.offsets[block_first_elem[i]] = block_first_entry[i];
+        }
+        if(num_block_elems == 0) {
+            continue;
+        }
+        uint32_t *block_connectivity = keep_connectivity ? &connectivity.node_ids[block_first_entry[i]] : block_buffer.data();
+        exodus_read_block_connectivity(exodus_id, elem_block_ids[i], block_connectivity);
+
+        #pragma omp parallel for reduction(min:min_x,min_y,min_z) reduction(max:max_x,max_y,max_z)
+        for(int64_t j = 0; j < num_block_elems; j++) {
+            size_t elem_index = block_first_elem[i] + j;
             double mins[3] = {DBL_MAX, DBL_MAX, DBL_MAX};
             double maxes[3] = {-DBL_MAX, -DBL_MAX, -DBL_MAX};
-            vector<size_t> node_ids;
             for(size_t k = 0; k < elem_size; k++) {
-                size_t node_id = connectivity_lists[i][j+k]-1; //node_ids start at 1 instead of 0
-                node_ids.push_back(node_id);
-                mins[0] = std::min(mins[0], x_coords[node_id]);
-                maxes[0] = std::max(maxes[0], x_coords[node_id]);
-                mins[1] = std::min(mins[1], y_coords[node_id]);
-                maxes[1] = std::max(maxes[1], y_coords[node_id]);
-                mins[2] = std::min(mins[2], z_coords[node_id]);
-                maxes[2] = std::max(maxes[2], z_coords[node_id]);
+                //node_ids start at 1 instead of 0. the csr's start at 0
+                uint32_t node_id = block_connectivity[j*elem_size+k]-1;
+                block_connectivity[j*elem_size+k] = node_id;
+                const point &node = node_coords[node_id];
+                for(int d = 0; d < NUM_DIMS; d++) {
+                    mins[d] = std::min(mins[d], node[d]);
+                    maxes[d] = std::max(maxes[d], node[d]);
+                }
+            }
+            if(keep_connectivity) {
+                connectivity.offsets[elem_index+1] = block_first_entry[i] + (j+1)*elem_size;
             }
-            node_ids_per_elem.push_back(node_ids);
-            element_bboxes_as_pts.push_back(point({mins[0], mins[1], mins[2]}));
-            element_bboxes_as_pts.push_back(point({maxes[0], maxes[1], maxes[2]}));
-            domain_lower_bounds[0] = std::min(domain_lower_bounds[0], mins[0]);
-            domain_upper_bounds[0] = std::max(domain_upper_bounds[0], maxes[0]);
-            domain_lower_bounds[1] = std::min(domain_lower_bounds[1], mins[1]);
-            domain_upper_bounds[1] = std::max(domain_upper_bounds[1], maxes[1]);
-            domain_lower_bounds[2] = std::min(domain_lower_bounds[2], mins[2]);
-            domain_upper_bounds[2] = std::max(domain_upper_bounds[2], maxes[2]);
+            element_bboxes_as_pts[2*elem_index] = point({mins[0], mins[1], mins[2]});
+            element_bboxes_as_pts[2*elem_index+1] = point({maxes[0], maxes[1], maxes[2]});
+
+            min_x = std::min(min_x, mins[0]);
+            max_x = std::max(max_x, maxes[0]);
+            min_y = std::min(min_y, mins[1]);
+            max_y = std::max(max_y, maxes[1]);
+            min_z = std::min(min_z, mins[2]);
+            max_z = std::max(max_z, maxes[2]);
         }
     }    
-    domain_bounds = bbox(point({domain_lower_bounds[0], domain_lower_bounds[1], domain_lower_bounds[2]}), 
-                         point({domain_upper_bounds[0], domain_upper_bounds[1], domain_upper_bounds[2]})
-                    );
+    ex_close (exodus_id);
+    domain_bounds = bbox(point({min_x, min_y, min_z}), point({max_x, max_y, max_z}));
+
+    if(keep_element_geometry) {
+        connectivity.node_coords = std::move(node_coords);
+    }
+}
+
+
+//the corner nodes of each face of a 3d element type, in exodus side order (so the faces' normals point out of the element).
+//higher order elements list their corner nodes first, so they have the same faces. triangular faces have -1 as their 4th node
+struct element_faces {
+    int num_faces;
+    int nodes[6][4];
+};
+
+static const element_faces HEX_FACES = {6, {{0,1,5,4}, {1,2,6,5}, {2,3,7,6}, {0,4,7,3}, {0,3,2,1}, {4,5,6,7}}};
+static const element_faces TET_FACES = {4, {{0,1,3,-1}, {1,2,3,-1}, {0,3,2,-1}, {0,2,1,-1}}};
+static const element_faces WEDGE_FACES = {5, {{0,1,4,3}, {1,2,5,4}, {0,3,5,2}, {0,2,1,-1}, {3,4,5,-1}}};
+static const element_faces PYRAMID_FACES = {5, {{0,1,4,-1}, {1,2,4,-1}, {2,3,4,-1}, {0,4,3,-1}, {0,3,2,1}}};
+
+//nullptr for element types without 3d faces (e.g., shells or beams)
+static const element_faces *get_element_faces(std::string elem_type) {
+    std::transform(elem_type.begin(), elem_type.end(), elem_type.begin(), ::toupper);
+    if(elem_type.compare(0, 3, "HEX") == 0) {
+        return &HEX_FACES;
+    }
+    else if(elem_type.compare(0, 3, "TET") == 0) {
+        return &TET_FACES;
+    }
+    else if(elem_type.compare(0, 5, "WEDGE") == 0) {
+        return &WEDGE_FACES;
+    }
+    else if(elem_type.compare(0, 3, "PYR") == 0) {
+        return &PYRAMID_FACES;
+    }
+    return nullptr;
+}
+
+//one face of one element. the key is the face's sorted corner nodes, so both elements sharing a face give it the same key
+struct element_face {
+    std::array<uint32_t, 4> key;
+    std::array<uint32_t, 4> nodes;
+};
+
+//the triangles of the partition's skin: the faces that belong to only one element, with each quad split into two triangles.
+//this includes the faces on the partition's boundaries with the other ranks, since those are the surface this rank can see
+void exodus_read_skin_triangles(const std::string &full_file_path, std::vector<point> &triangles_as_pts, bbox &domain_bounds,
+    uint32_t &num_triangles) 
+{
+    int exodus_id = exodus_open_file(full_file_path);
+
+    int num_dim, num_nodes, num_elem, num_elem_blocks, num_node_sets, num_side_sets;
+    char  db_title[MAX_STR_LENGTH];
+    if(ex_get_init (exodus_id, db_title, &num_dim, &num_nodes, &num_elem, &num_elem_blocks, &num_node_sets, &num_side_sets)) {
+        std::cerr << "Error with ex_get_init" << std::endl;
+        exit(-1);
+    }
+
+    vector<int> elem_block_ids(num_elem_blocks);
+    if(ex_get_ids (exodus_id, EX_ELEM_BLOCK, &elem_block_ids[0] )) {
+        std::cerr << "error with ex_get_ids" << std::endl;
+        exit(-1);
+    }
+
+    //every face of every element, in element order
+    vector<element_face> faces;
+    for(size_t i = 0; i < num_elem_blocks; i++) {
+        vector<uint32_t> block_connectivity;
+        uint32_t num_nodes_per_elem;
+        std::string elem_type;
+        exodus_get_element_connectivity(exodus_id, elem_block_ids[i], block_connectivity, num_nodes_per_elem, &elem_type);
+        const element_faces *elem_faces = get_element_faces(elem_type);
+        if(elem_faces == nullptr) {
+            if(!block_connectivity.empty()) {
+                std::cerr << "error. element block " << elem_block_ids[i] << " has elements of type " << elem_type << ", which have no 3d faces. skipping it" << std::endl;
+            }
+            continue;
+        }
+
+        size_t num_block_elems = block_connectivity.size() / num_nodes_per_elem;
+        size_t first_face = faces.size();
+        faces.resize(first_face + num_block_elems * elem_faces->num_faces);
+        #pragma omp parallel for
+        for(int64_t j = 0; j < (int64_t)num_block_elems; j++) {
+            for(int f = 0; f < elem_faces->num_faces; f++) {
+                element_face &face = faces[first_face + j*elem_faces->num_faces + f];
+                for(int k = 0; k < 4; k++) {
+                    int local_node = elem_faces->nodes[f][k];
+                    //node_ids start at 1 instead of 0
+                    face.nodes[k] = (local_node < 0) ? UINT32_MAX : block_connectivity[j*num_nodes_per_elem + local_node] - 1;
+                }
+                face.key = face.nodes;
+                std::sort(face.key.begin(), face.key.end());
+            }
+        }
+    }
+
+    vector<double> x_coords, y_coords, z_coords;
+    exodus_read_vertex_coordinates(exodus_id, x_coords, y_coords, z_coords);
+    ex_close (exodus_id);
 
+    //a face is on the skin if no other face has its key
+    vector<size_t> sorted_faces(faces.size());
+    std::iota(sorted_faces.begin(), sorted_faces.end(), 0);
+    std::sort(sorted_faces.begin(), sorted_faces.end(), [&faces](size_t a, size_t b) { return faces[a].key < faces[b].key; });
+    vector<bool> on_skin(faces.size(), false);
+    for(size_t i = 0; i < sorted_faces.size(); ) {
+        size_t j = i + 1;
+        while(j < sorted_faces.size() && faces[sorted_faces[j]].key == faces[sorted_faces[i]].key) {
+            j++;
+        }
+        on_skin[sorted_faces[i]] = (j == i + 1);
+        i = j;
+    }
+
+    //written in element order, which keeps the mesh's locality
+    double min_x = DBL_MAX, min_y = DBL_MAX, min_z = DBL_MAX;
+    double max_x = -DBL_MAX, max_y = -DBL_MAX, max_z = -DBL_MAX;
+    triangles_as_pts.clear();
+    for(size_t i = 0; i < faces.size(); i++) {
+        if(!on_skin[i]) {
+            continue;
+        }
+        const std::array<uint32_t, 4> &nodes = faces[i].nodes;
+        size_t num_face_triangles = (nodes[3] == UINT32_MAX) ? 1 : 2;
+        for(size_t t = 0; t < num_face_triangles; t++) {
+            //a quad (n0, n1, n2, n3) is split into (n0, n1, n2) and (n0, n2, n3)
+            uint32_t triangle_nodes[3] = {nodes[0], nodes[t+1], nodes[t+2]};
+            for(uint32_t node_id : triangle_nodes) {
+                triangles_as_pts.push_back(point({x_coords[node_id], y_coords[node_id], z_coords[node_id]}));
+                min_x = std::min(min_x, x_coords[node_id]);
+                max_x = std::max(max_x, x_coords[node_id]);
+                min_y = std::min(min_y, y_coords[node_id]);
+                max_y = std::max(max_y, y_coords[node_id]);
+                min_z = std::min(min_z, z_coords[node_id]);
+                max_z = std::max(max_z, z_coords[node_id]);
+            }
+        }
+    }
+    num_triangles = triangles_as_pts.size() / 3;
+    domain_bounds = bbox(point({min_x, min_y, min_z}), point({max_x, max_y, max_z}));
 }
 
 
@@ -494,9 +961,16 @@ void get_data_from_exodus_file(DataType data_type, const std::string &full_file_
 }
 
 void get_data_from_exodus_file(DataType data_type, const std::string &full_file_path, std::vector<point> &mesh_coords, bbox &domain_bounds,
-    uint32_t &num_data_pts, vector<vector<size_t>> &node_ids_per_elem) 
+    uint32_t &num_data_pts, bool retrieve_nodes, element_connectivity &connectivity, bool keep_element_geometry) 
 {
-    exodus_read_element_bboxes(full_file_path, mesh_coords, domain_bounds, num_data_pts, node_ids_per_elem);
+    if(data_type == TRIANGLES) {
+        //the skin's triangles have no element connectivity
+        connectivity.clear();
+        exodus_read_skin_triangles(full_file_path, mesh_coords, domain_bounds, num_data_pts);
+    }
+    else {
+        exodus_read_element_bboxes(full_file_path, mesh_coords, domain_bounds, num_data_pts, retrieve_nodes, connectivity, keep_element_geometry);
+    }
 }
 
 
@@ -0,0 +1,371 @@
+//common.hh comes first, so the test build (which has its own common.hh) doesn't pick up the benchmark's
+#include "common.hh"
+#include "element_containment.hh"
+#include "counter_rng.hh"
+
+//like the brute force kernels, the avx2 kernel is compiled with a per-function target attribute and picked at runtime
+#if defined(__x86_64__) && defined(__GNUC__)
+    #define ELEMENT_CONTAINMENT_X86 1
+    #include <immintrin.h>
+#else
+    #define ELEMENT_CONTAINMENT_X86 0
+#endif
+
+//how far outside of [0, 1] a parametric (or barycentric) coordinate can be with the probe still inside, so a probe on a face
+//shared by two elements is in both of them despite rounding
+#define CONTAINMENT_TOLERANCE 1e-10
+//newton's method converges in a few iterations for well shaped elements. a probe that hasn't converged by the last iteration is outside
+#define HEX_NEWTON_ITERATIONS 10
+#define HEX_NEWTON_CONVERGENCE 1e-12
+#define PROBE_SEED 600
+
+ElementContainment::ElementContainment(const element_connectivity &connectivity, bool use_avx2) {
+    #if ELEMENT_CONTAINMENT_X86
+        avx2 = use_avx2 && __builtin_cpu_supports("avx2");
+    #endif
+
+    size_t num_elements = connectivity.num_elements();
+    shapes.assign(num_elements, UNSUPPORTED_ELEMENT);
+    shape_indices.assign(num_elements, 0);
+    uint32_t num_hexes = 0, num_tets = 0;
+    for(size_t e = 0; e < num_elements; e++) {
+        size_t num_elem_nodes = connectivity.nodes_end(e) - connectivity.nodes_begin(e);
+        if(num_elem_nodes == 8) {
+            shapes[e] = HEX8_ELEMENT;
+            shape_indices[e] = num_hexes++;
+        }
+        else if(num_elem_nodes == 4) {
+            shapes[e] = TET4_ELEMENT;
+            shape_indices[e] = num_tets++;
+        }
+    }
+    for(int k = 0; k < 8; k++) {
+        for(int d = 0; d < NUM_DIMS; d++) {
+            hex_coeffs[k][d].resize(num_hexes);
+        }
+    }
+    for(int k = 0; k < 4; k++) {
+        for(int d = 0; d < NUM_DIMS; d++) {
+            tet_coeffs[k][d].resize(num_tets);
+        }
+    }
+
+    #pragma omp parallel for reduction(+:num_unsupported)
+    for(int64_t e = 0; e < (int64_t)num_elements; e++) {
+        const uint32_t *nodes = connectivity.nodes_begin(e);
+        uint32_t index = shape_indices[e];
+        if(shapes[e] == HEX8_ELEMENT) {
+            for(int d = 0; d < NUM_DIMS; d++) {
+                double x[8];
+                for(int k = 0; k < 8; k++) {
+                    x[k] = connectivity.node_coords[nodes[k]][d];
+                }
+                hex_coeffs[0][d][index] = x[0];
+                hex_coeffs[1][d][index] = x[1] - x[0];
+                hex_coeffs[2][d][index] = x[3] - x[0];
+                hex_coeffs[3][d][index] = x[4] - x[0];
+                hex_coeffs[4][d][index] = x[0] - x[1] + x[2] - x[3];
+                hex_coeffs[5][d][index] = x[0] - x[3] + x[7] - x[4];
+                hex_coeffs[6][d][index] = x[0] - x[1] + x[5] - x[4];
+                hex_coeffs[7][d][index] = -x[0] + x[1] - x[2] + x[3] + x[4] - x[5] + x[6] - x[7];
+            }
+        }
+        else if(shapes[e] == TET4_ELEMENT) {
+            const point &origin = connectivity.node_coords[nodes[0]];
+            double edges[3][NUM_DIMS];
+            for(int k = 0; k < 3; k++) {
+                for(int d = 0; d < NUM_DIMS; d++) {
+                    edges[k][d] = connectivity.node_coords[nodes[k+1]][d] - origin[d];
+                }
+            }
+            //the inverse's rows are the cross products of the other two edges over the determinant
+            double rows[3][NUM_DIMS];
+            for(int k = 0; k < 3; k++) {
+                const double *a = edges[(k + 1) % 3];
+                const double *b = edges[(k + 2) % 3];
+                for(int d = 0; d < NUM_DIMS; d++) {
+                    rows[k][d] = a[(d + 1) % NUM_DIMS] * b[(d + 2) % NUM_DIMS] - a[(d + 2) % NUM_DIMS] * b[(d + 1) % NUM_DIMS];
+                }
+            }
+            double determinant = edges[0][0]*rows[0][0] + edges[0][1]*rows[0][1] + edges[0][2]*rows[0][2];
+            if(determinant == 0 || !std::isfinite(determinant)) {
+                shapes[e] = UNSUPPORTED_ELEMENT;
+            }
+            for(int d = 0; d < NUM_DIMS; d++) {
+                tet_coeffs[0][d][index] = origin[d];
+                for(int k = 0; k < 3; k++) {
+                    tet_coeffs[k+1][d][index] = rows[k][d] / determinant;
+                }
+            }
+        }
+        num_unsupported += (shapes[e] == UNSUPPORTED_ELEMENT);
+    }
+}
+
+//solves for the probe's parametric coordinates. du, dv and dw are the newton step, from cramer's rule with the jacobian's columns
+static bool scalar_hex_contains(const std::vector<double> (&coeffs)[8][NUM_DIMS], size_t index, const point &probe) {
+    double c[8][NUM_DIMS];
+    for(int k = 0; k < 8; k++) {
+        for(int d = 0; d < NUM_DIMS; d++) {
+            c[k][d] = coeffs[k][d][index];
+        }
+    }
+    double u = .5, v = .5, w = .5;
+    for(int iteration = 0; iteration < HEX_NEWTON_ITERATIONS; iteration++) {
+        double f[NUM_DIMS];
+        double columns[3][NUM_DIMS];
+        for(int d = 0; d < NUM_DIMS; d++) {
+            //the probe is subtracted first, so the residual doesn't lose the mesh's absolute coordinates' precision
+            f[d] = (c[0][d] - probe[d]) + c[1][d]*u + c[2][d]*v + c[3][d]*w + c[4][d]*u*v + c[5][d]*v*w + c[6][d]*u*w + c[7][d]*u*v*w;
+            columns[0][d] = c[1][d] + c[4][d]*v + c[6][d]*w + c[7][d]*v*w;
+            columns[1][d] = c[2][d] + c[4][d]*u + c[5][d]*w + c[7][d]*u*w;
+            columns[2][d] = c[3][d] + c[5][d]*v + c[6][d]*u + c[7][d]*u*v;
+        }
+        double numerators[3] = {0, 0, 0};
+        double determinant = 0;
+        for(int k = 0; k < 3; k++) {
+            const double *a = columns[(k + 1) % 3];
+            const double *b = columns[(k + 2) % 3];
+            for(int d = 0; d < NUM_DIMS; d++) {
+                double cross = a[(d + 1) % NUM_DIMS] * b[(d + 2) % NUM_DIMS] - a[(d + 2) % NUM_DIMS] * b[(d + 1) % NUM_DIMS];
+                numerators[k] += f[d] * cross;
+                if(k == 0) {
+                    determinant += columns[0][d] * cross;
+                }
+            }
+        }
+        double du = numerators[0] / determinant;
+        double dv = numerators[1] / determinant;
+        double dw = numerators[2] / determinant;
+        u -= du;
+        v -= dv;
+        w -= dw;
+        //nan (from a singular jacobian) fails every comparison, so it is outside
+        if(std::fabs(du) < HEX_NEWTON_CONVERGENCE && std::fabs(dv) < HEX_NEWTON_CONVERGENCE && std::fabs(dw) < HEX_NEWTON_CONVERGENCE) {
+            return u >= -CONTAINMENT_TOLERANCE && u <= 1 + CONTAINMENT_TOLERANCE &&
+                v >= -CONTAINMENT_TOLERANCE && v <= 1 + CONTAINMENT_TOLERANCE &&
+                w >= -CONTAINMENT_TOLERANCE && w <= 1 + CONTAINMENT_TOLERANCE;
+        }
+    }
+    return false;
+}
+
+static bool scalar_tet_contains(const std::vector<double> (&coeffs)[4][NUM_DIMS], size_t index, const point &probe) {
+    double relative[NUM_DIMS];
+    for(int d = 0; d < NUM_DIMS; d++) {
+        relative[d] = probe[d] - coeffs[0][d][index];
+    }
+    double sum = 0;
+    for(int k = 1; k < 4; k++) {
+        double barycentric = coeffs[k][0][index]*relative[0] + coeffs[k][1][index]*relative[1] + coeffs[k][2][index]*relative[2];
+        if(!(barycentric >= -CONTAINMENT_TOLERANCE)) {
+            return false;
+        }
+        sum += barycentric;
+    }
+    return sum <= 1 + CONTAINMENT_TOLERANCE;
+}
+
+#if ELEMENT_CONTAINMENT_X86
+    //a * b + c. fma would need its own cpu check
+    __attribute__((target("avx2")))
+    static inline __m256d avx2_multiply_add(__m256d a, __m256d b, __m256d c) {
+        return _mm256_add_pd(_mm256_mul_pd(a, b), c);
+    }
+
+    __attribute__((target("avx2")))
+    static inline __m256d avx2_in_unit_interval(__m256d x) {
+        __m256d in_lower = _mm256_cmp_pd(x, _mm256_set1_pd(-CONTAINMENT_TOLERANCE), _CMP_GE_OQ);
+        __m256d in_upper = _mm256_cmp_pd(x, _mm256_set1_pd(1 + CONTAINMENT_TOLERANCE), _CMP_LE_OQ);
+        return _mm256_and_pd(in_lower, in_upper);
+    }
+
+    //the same newton iterations as scalar_hex_contains on 4 hexes at once, until every lane has converged.
+    //returns a mask with a bit set for each hex that contains the probe
+    __attribute__((target("avx2")))
+    static int avx2_contains_mask(const std::vector<double> (&coeffs)[8][NUM_DIMS], __m256i indices, const point &probe) {
+        const __m256d sign_bit = _mm256_set1_pd(-0.0);
+        __m256d c[8][NUM_DIMS];
+        __m256d p[NUM_DIMS];
+        for(int d = 0; d < NUM_DIMS; d++) {
+            for(int k = 0; k < 8; k++) {
+                c[k][d] = _mm256_i64gather_pd(coeffs[k][d].data(), indices, sizeof(double));
+            }
+            p[d] = _mm256_set1_pd(probe[d]);
+        }
+        __m256d u = _mm256_set1_pd(.5), v = u, w = u;
+        __m256d converged = _mm256_setzero_pd();
+        for(int iteration = 0; iteration < HEX_NEWTON_ITERATIONS; iteration++) {
+            __m256d uv = _mm256_mul_pd(u, v);
+            __m256d vw = _mm256_mul_pd(v, w);
+            __m256d uw = _mm256_mul_pd(u, w);
+            __m256d uvw = _mm256_mul_pd(uv, w);
+            __m256d f[NUM_DIMS];
+            __m256d columns[3][NUM_DIMS];
+            for(int d = 0; d < NUM_DIMS; d++) {
+                f[d] = _mm256_sub_pd(c[0][d], p[d]);
+                f[d] = avx2_multiply_add(c[1][d], u, f[d]);
+                f[d] = avx2_multiply_add(c[2][d], v, f[d]);
+                f[d] = avx2_multiply_add(c[3][d], w, f[d]);
+                f[d] = avx2_multiply_add(c[4][d], uv, f[d]);
+                f[d] = avx2_multiply_add(c[5][d], vw, f[d]);
+                f[d] = avx2_multiply_add(c[6][d], uw, f[d]);
+                f[d] = avx2_multiply_add(c[7][d], uvw, f[d]);
+                columns[0][d] = avx2_multiply_add(c[7][d], vw, avx2_multiply_add(c[6][d], w, avx2_multiply_add(c[4][d], v, c[1][d])));
+                columns[1][d] = avx2_multiply_add(c[7][d], uw, avx2_multiply_add(c[5][d], w, avx2_multiply_add(c[4][d], u, c[2][d])));
+                columns[2][d] = avx2_multiply_add(c[7][d], uv, avx2_multiply_add(c[6][d], u, avx2_multiply_add(c[5][d], v, c[3][d])));
+            }
+            __m256d numerators[3];
+            __m256d determinant = _mm256_setzero_pd();
+            for(int k = 0; k < 3; k++) {
+                const __m256d *a = columns[(k + 1) % 3];
+                const __m256d *b = columns[(k + 2) % 3];
+                numerators[k] = _mm256_setzero_pd();
+                for(int d = 0; d < NUM_DIMS; d++) {
+                    int d1 = (d + 1) % NUM_DIMS;
+                    int d2 = (d + 2) % NUM_DIMS;
+                    __m256d cross = _mm256_sub_pd(_mm256_mul_pd(a[d1], b[d2]), _mm256_mul_pd(a[d2], b[d1]));
+                    numerators[k] = avx2_multiply_add(f[d], cross, numerators[k]);
+                    if(k == 0) {
+                        determinant = avx2_multiply_add(columns[0][d], cross, determinant);
+                    }
+                }
+            }
+            __m256d du = _mm256_div_pd(numerators[0], determinant);
+            __m256d dv = _mm256_div_pd(numerators[1], determinant);
+            __m256d dw = _mm256_div_pd(numerators[2], determinant);
+            u = _mm256_sub_pd(u, du);
+            v = _mm256_sub_pd(v, dv);
+            w = _mm256_sub_pd(w, dw);
+            __m256d max_step = _mm256_max_pd(_mm256_andnot_pd(sign_bit, du), _mm256_max_pd(_mm256_andnot_pd(sign_bit, dv), _mm256_andnot_pd(sign_bit, dw)));
+            converged = _mm256_cmp_pd(max_step, _mm256_set1_pd(HEX_NEWTON_CONVERGENCE), _CMP_LT_OQ);
+            if(_mm256_movemask_pd(converged) == 0xF) {
+                break;
+            }
+        }
+        __m256d inside = _mm256_and_pd(converged, _mm256_and_pd(avx2_in_unit_interval(u), _mm256_and_pd(avx2_in_unit_interval(v), avx2_in_unit_interval(w))));
+        return _mm256_movemask_pd(inside);
+    }
+
+    //scalar_tet_contains on 4 tets at once
+    __attribute__((target("avx2")))
+    static int avx2_contains_mask(const std::vector<double> (&coeffs)[4][NUM_DIMS], __m256i indices, const point &probe) {
+        __m256d relative[NUM_DIMS];
+        for(int d = 0; d < NUM_DIMS; d++) {
+            relative[d] = _mm256_sub_pd(_mm256_set1_pd(probe[d]), _mm256_i64gather_pd(coeffs[0][d].data(), indices, sizeof(double)));
+        }
+        __m256d inside = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+        __m256d sum = _mm256_setzero_pd();
+        for(int k = 1; k < 4; k++) {
+            __m256d barycentric = _mm256_setzero_pd();
+            for(int d = 0; d < NUM_DIMS; d++) {
+                barycentric = avx2_multiply_add(_mm256_i64gather_pd(coeffs[k][d].data(), indices, sizeof(double)), relative[d], barycentric);
+            }
+            inside = _mm256_and_pd(inside, _mm256_cmp_pd(barycentric, _mm256_set1_pd(-CONTAINMENT_TOLERANCE), _CMP_GE_OQ));
+            sum = _mm256_add_pd(sum, barycentric);
+        }
+        inside = _mm256_and_pd(inside, _mm256_cmp_pd(sum, _mm256_set1_pd(1 + CONTAINMENT_TOLERANCE), _CMP_LE_OQ));
+        return _mm256_movemask_pd(inside);
+    }
+
+    //tests the candidates 4 at a time (leaving the last few for the scalar kernel). the coefficients' size picks the hex or tet mask
+    template <size_t NUM_COEFFS>
+    __attribute__((target("avx2")))
+    static size_t avx2_contains(const std::vector<double> (&coeffs)[NUM_COEFFS][NUM_DIMS], const std::vector<size_t> &candidates,
+        const std::vector<uint32_t> &shape_indices, const point &probe, size_t *out)
+    {
+        size_t num_matches = 0;
+        for(size_t i = 0; i + 4 <= candidates.size(); i += 4) {
+            __m256i indices = _mm256_set_epi64x(shape_indices[candidates[i+3]], shape_indices[candidates[i+2]],
+                shape_indices[candidates[i+1]], shape_indices[candidates[i]]);
+            for(int mask = avx2_contains_mask(coeffs, indices, probe); mask != 0; mask &= mask - 1) {
+                out[num_matches++] = candidates[i + __builtin_ctz(mask)];
+            }
+        }
+        return num_matches;
+    }
+#endif
+
+size_t ElementContainment::contains(const point &probe, const size_t *candidates, size_t num_candidates, size_t *out) {
+    hex_candidates.clear();
+    tet_candidates.clear();
+    for(size_t i = 0; i < num_candidates; i++) {
+        if(shapes[candidates[i]] == HEX8_ELEMENT) {
+            hex_candidates.push_back(candidates[i]);
+        }
+        else if(shapes[candidates[i]] == TET4_ELEMENT) {
+            tet_candidates.push_back(candidates[i]);
+        }
+    }
+
+    //the vector kernel leaves fewer than 4 of each shape for the scalar one
+    size_t num_matches = 0;
+    size_t num_vector_hexes = 0, num_vector_tets = 0;
+    #if ELEMENT_CONTAINMENT_X86
+        if(avx2) {
+            num_vector_hexes = hex_candidates.size() / 4 * 4;
+            num_vector_tets = tet_candidates.size() / 4 * 4;
+            num_matches += avx2_contains(hex_coeffs, hex_candidates, shape_indices, probe, out + num_matches);
+            num_matches += avx2_contains(tet_coeffs, tet_candidates, shape_indices, probe, out + num_matches);
+        }
+    #endif
+    for(size_t i = num_vector_hexes; i < hex_candidates.size(); i++) {
+        out[num_matches] = hex_candidates[i];
+        num_matches += scalar_hex_contains(hex_coeffs, shape_indices[hex_candidates[i]], probe);
+    }
+    for(size_t i = num_vector_tets; i < tet_candidates.size(); i++) {
+        out[num_matches] = tet_candidates[i];
+        num_matches += scalar_tet_contains(tet_coeffs, shape_indices[tet_candidates[i]], probe);
+    }
+    return num_matches;
+}
+
+//the parametric coordinates of a hex8's nodes, in exodus order
+static const double HEX8_NODE_PARAMS[8][NUM_DIMS] = {{0,0,0}, {1,0,0}, {1,1,0}, {0,1,0}, {0,0,1}, {1,0,1}, {1,1,1}, {0,1,1}};
+
+void get_probe_points(size_t num_probes, const element_connectivity &connectivity, std::vector<point> &probes) {
+    size_t num_elements = connectivity.num_elements();
+    probes.assign(num_probes, point({0, 0, 0}));
+    if(num_elements == 0) {
+        return;
+    }
+    //each probe draws its element and up to 4 coordinates
+    #pragma omp parallel for
+    for(int64_t i = 0; i < (int64_t)num_probes; i++) {
+        size_t element = counter_rng(PROBE_SEED, 5*i) % num_elements;
+        const uint32_t *nodes = connectivity.nodes_begin(element);
+        size_t num_elem_nodes = connectivity.nodes_end(element) - nodes;
+        double weights[8];
+        if(num_elem_nodes == 8) {
+            //trilinear shape functions at a uniformly random (u, v, w)
+            double params[NUM_DIMS];
+            for(int d = 0; d < NUM_DIMS; d++) {
+                params[d] = counter_rng_uniform(PROBE_SEED, 5*i + 1 + d);
+            }
+            for(int k = 0; k < 8; k++) {
+                weights[k] = 1;
+                for(int d = 0; d < NUM_DIMS; d++) {
+                    weights[k] *= HEX8_NODE_PARAMS[k][d] ? params[d] : 1 - params[d];
+                }
+            }
+        }
+        else if(num_elem_nodes == 4) {
+            //normalized exponentials are uniform on the simplex
+            double sum = 0;
+            for(int k = 0; k < 4; k++) {
+                weights[k] = -std::log(1 - counter_rng_uniform(PROBE_SEED, 5*i + 1 + k));
+                sum += weights[k];
+            }
+            for(int k = 0; k < 4; k++) {
+                weights[k] /= sum;
+            }
+        }
+        point &probe = probes[i];
+        for(size_t k = 0; k < num_elem_nodes; k++) {
+            double weight = (num_elem_nodes == 8 || num_elem_nodes == 4) ? weights[k] : 1.0 / num_elem_nodes;
+            for(int d = 0; d < NUM_DIMS; d++) {
+                probe[d] += weight * connectivity.node_coords[nodes[k]][d];
+            }
+        }
+    }
+}
@@ -0,0 +1,120 @@
+#include "latency_histogram.hh"
+#include "common.hh"
+#include <algorithm>
+#include <cmath>
+
+static uint64_t timer_overhead_ns = 0;
+
+size_t LatencyHistogram::bucket_index(uint64_t value) {
+    if(value < SUB_BUCKET_COUNT) {
+        return value;
+    }
+    //shift value down until it falls in [HALF_SUB_BUCKET_COUNT, SUB_BUCKET_COUNT)
+    int msb = 63 - __builtin_clzll(value);
+    int shift = msb - (SUB_BUCKET_BITS - 1);
+    return SUB_BUCKET_COUNT + (shift - 1) * HALF_SUB_BUCKET_COUNT + ((value >> shift) - HALF_SUB_BUCKET_COUNT);
+}
+
+uint64_t LatencyHistogram::highest_equivalent_value(size_t index) {
+    if(index < SUB_BUCKET_COUNT) {
+        return index;
+    }
+    int shift = (index - SUB_BUCKET_COUNT) / HALF_SUB_BUCKET_COUNT + 1;
+    uint64_t sub_bucket = (index - SUB_BUCKET_COUNT) % HALF_SUB_BUCKET_COUNT + HALF_SUB_BUCKET_COUNT;
+    return ((sub_bucket + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t value_ns) {
+    counts[bucket_index(value_ns)]++;
+    num_values++;
+    max_value = std::max(max_value, value_ns);
+}
+
+void LatencyHistogram::clear() {
+    std::fill(counts.begin(), counts.end(), 0);
+    num_values = 0;
+    max_value = 0;
+}
+
+uint64_t LatencyHistogram::value_at_percentile(double percentile) const {
+    if(num_values == 0) {
+        return 0;
+    }
+    uint64_t rank = std::max((uint64_t)1, (uint64_t)std::ceil(percentile / 100.0 * num_values));
+    uint64_t num_seen = 0;
+    for(size_t i = 0; i < counts.size(); i++) {
+        num_seen += counts[i];
+        if(num_seen >= rank) {
+            //the exact max is known, so don't report past it
+            return std::min(highest_equivalent_value(i), max_value);
+        }
+    }
+    return max_value;
+}
+
+void LatencyHistogram::merge_onto_rank_0() {
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    std::vector<uint64_t> all_counts(counts.size(), 0);
+    uint64_t all_num_values = 0;
+    uint64_t all_max_value = 0;
+    MPI_Reduce(counts.data(), all_counts.data(), counts.size(), MPI_UINT64_T, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&num_values, &all_num_values, 1, MPI_UINT64_T, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&max_value, &all_max_value, 1, MPI_UINT64_T, MPI_MAX, 0, MPI_COMM_WORLD);
+    if(rank == 0) {
+        counts.swap(all_counts);
+        num_values = all_num_values;
+        max_value = all_max_value;
+    }
+}
+
+void QueryTimer::calibrate() {
+    const int num_samples = 1000;
+    uint64_t min_elapsed_ns = UINT64_MAX;
+    for(int i = 0; i < num_samples; i++) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+        uint64_t elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+        min_elapsed_ns = std::min(min_elapsed_ns, elapsed_ns);
+    }
+    timer_overhead_ns = min_elapsed_ns;
+    if(DEBUG) {
+        std::cout << "query timer overhead: " << timer_overhead_ns << " ns" << std::endl;
+    }
+}
+
+uint64_t QueryTimer::overhead_ns() {
+    return timer_overhead_ns;
+}
+
+void print_query_latencies(double query_percent_data_covered, const std::string &test_name, LatencyHistogram &histogram,
+    double avg_perc_features_intersected, const testing_config &config)
+{
+    int rank = 0;
+    if(USE_MPI) {
+        int num_procs;
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+        MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
+        histogram.merge_onto_rank_0();
+
+        double sum_avg_perc_features_intersected = 0;
+        MPI_Reduce(&avg_perc_features_intersected, &sum_avg_perc_features_intersected, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+        avg_perc_features_intersected = sum_avg_perc_features_intersected / num_procs;
+    }
+    if(rank != 0) {
+        return;
+    }
+
+    const std::vector<std::pair<std::string, double>> percentiles = {
+        {"p50", 50}, {"p90", 90}, {"p99", 99}, {"p99.9", 99.9}
+    };
+    for(const std::pair<std::string, double> &percentile : percentiles) {
+        std::cout << "query latency " << percentile.first << " " << std::to_string(query_percent_data_covered) << ", " << test_name << ", ";
+        std::cout << histogram.value_at_percentile(percentile.second) << ", " << avg_perc_features_intersected;
+        print_config(config);
+    }
+    std::cout << "query latency max " << std::to_string(query_percent_data_covered) << ", " << test_name << ", ";
+    std::cout << histogram.max() << ", " << avg_perc_features_intersected;
+    print_config(config);
+}
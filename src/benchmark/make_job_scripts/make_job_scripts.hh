@@ -112,6 +112,21 @@ std::string get_library_name(Library lib) {
         case SPATIAL : {
             return "SPATIAL";
         }
+        case NATIVE_KDTREE : {
+            return "NATIVE_KDTREE";
+        }
+        case NATIVE_RTREE : {
+            return "NATIVE_RTREE";
+        }
+        case UNIFORM_GRID : {
+            return "UNIFORM_GRID";
+        }
+        case LINEAR_OCTREE : {
+            return "LINEAR_OCTREE";
+        }
+        case WIDE_BVH : {
+            return "WIDE_BVH";
+        }
         default : {
             return "ERROR";
         }
@@ -185,9 +200,9 @@ std::vector<run_config> get_run_configs() {
     std::vector<run_config> configs = {
         run_config(ALGLIB, 1),
         run_config(ANN, 4),
-        run_config(BOOST_RTREE, 4),
-        run_config(BRUTE_FORCE, 1),
-        run_config(CGAL_LIBRARY, 3),
+        run_config(BOOST_RTREE, 5),
+        run_config(BRUTE_FORCE, 5),
+        run_config(CGAL_LIBRARY, 4),
         run_config(FLANN, 4),
         run_config(KDTREE, 1),
         run_config(KDTREE2, 4),
@@ -198,18 +213,25 @@ std::vector<run_config> get_run_configs() {
         run_config(LIBKDTREE2, 1),
         run_config(LIBNABO, 4),
         run_config(LIBSPATIALINDEX, 4),
-        run_config(NANOFLANN, 4),
+        run_config(NANOFLANN, 5),
         run_config(OCTREE, 2),
         run_config(PCL, 5),
-        run_config(PICO_TREE, 2),
+        run_config(PICO_TREE, 3),
         run_config(RTREE_TEMPLATE, 2),
         run_config(SPATIAL, 1),
-        run_config(BOOST_RTREE, 2, BBOXES),
-        run_config(BRUTE_FORCE, 1, BBOXES),
+        run_config(NATIVE_KDTREE, 4),
+        run_config(UNIFORM_GRID, 4),
+        run_config(LINEAR_OCTREE, 4),
+        run_config(BOOST_RTREE, 3, BBOXES),
+        run_config(BRUTE_FORCE, 5, BBOXES),
         run_config(CGAL_LIBRARY, 1, BBOXES),
         run_config(LIBSPATIALINDEX, 4, BBOXES),
         run_config(RTREE_TEMPLATE, 2, BBOXES),
-        run_config(SPATIAL, 1, BBOXES)
+        run_config(SPATIAL, 1, BBOXES),
+        run_config(NATIVE_KDTREE, 4, BBOXES),
+        run_config(NATIVE_RTREE, 5, BBOXES),
+        run_config(UNIFORM_GRID, 4, BBOXES),
+        run_config(WIDE_BVH, 4, BBOXES)
     };
 
     std::vector<run_config> configs_adjusted;
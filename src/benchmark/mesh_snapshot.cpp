@@ -0,0 +1,170 @@
+#include "mesh_snapshot.hh"
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char MESH_SNAPSHOT_MAGIC[8] = {'R', 'T', 'S', 'N', 'A', 'P', '\0', '\0'};
+
+//everything is stored in the host's byte order. every field is 8 byte aligned, so the arrays after the header are too
+struct mesh_snapshot_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t data_type;
+    //changes what num_data_pts counts for bboxes
+    uint32_t retrieve_nodes_for_bboxes;
+    uint32_t num_data_pts;
+    //used to detect that the exodus file has changed since the snapshot was written
+    uint64_t source_size;
+    int64_t source_mtime_ns;
+    double domain_bounds[2*NUM_DIMS];
+    uint64_t num_coords;
+    uint64_t num_elements;
+    uint64_t num_connectivity_entries;
+    uint32_t num_connectivity_nodes;
+    uint32_t padding;
+};
+//followed by num_coords points (NUM_DIMS doubles each), then num_elements+1 offsets into the connectivity, then the connectivity's (uint32) node ids
+
+//unmaps the file when it goes out of scope
+class MappedFile {
+    public:
+        const char *data = nullptr;
+        size_t size = 0;
+
+        bool map(const std::string &path) {
+            int fd = open(path.c_str(), O_RDONLY);
+            if(fd == -1) {
+                return false;
+            }
+            struct stat file_stats;
+            if(fstat(fd, &file_stats) != 0 || file_stats.st_size == 0) {
+                close(fd);
+                return false;
+            }
+            void *mapping = mmap(nullptr, file_stats.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            //the mapping keeps its own reference to the file
+            close(fd);
+            if(mapping == MAP_FAILED) {
+                return false;
+            }
+            data = (const char *)mapping;
+            size = file_stats.st_size;
+            return true;
+        }
+
+        ~MappedFile() {
+            if(data != nullptr) {
+                munmap((void *)data, size);
+            }
+        }
+};
+
+static bool get_source_stats(const std::string &mesh_file_path, uint64_t &source_size, int64_t &source_mtime_ns) {
+    struct stat file_stats;
+    if(stat(mesh_file_path.c_str(), &file_stats) != 0) {
+        return false;
+    }
+    source_size = file_stats.st_size;
+    source_mtime_ns = (int64_t)file_stats.st_mtim.tv_sec * 1000000000 + file_stats.st_mtim.tv_nsec;
+    return true;
+}
+
+std::string get_mesh_snapshot_path(const std::string &mesh_file_path, DataType data_type) {
+    return mesh_file_path + ((data_type == POINTS) ? ".points" : ((data_type == BBOXES) ? ".bboxes" : ".triangles")) + ".snapshot";
+}
+
+bool read_mesh_snapshot(const std::string &snapshot_path, const std::string &mesh_file_path, DataType data_type,
+    bool retrieve_nodes, std::vector<point> &mesh_coords, bbox &domain_bounds, uint32_t &num_data_pts, element_connectivity *connectivity)
+{
+    MappedFile file;
+    if(!file.map(snapshot_path) || file.size < sizeof(mesh_snapshot_header)) {
+        return false;
+    }
+    const mesh_snapshot_header *header = (const mesh_snapshot_header *)file.data;
+
+    uint64_t source_size;
+    int64_t source_mtime_ns;
+    if(memcmp(header->magic, MESH_SNAPSHOT_MAGIC, sizeof(MESH_SNAPSHOT_MAGIC)) != 0 || header->version != MESH_SNAPSHOT_VERSION ||
+        header->data_type != data_type || header->retrieve_nodes_for_bboxes != retrieve_nodes ||
+        !get_source_stats(mesh_file_path, source_size, source_mtime_ns) ||
+        header->source_size != source_size || header->source_mtime_ns != source_mtime_ns)
+    {
+        return false;
+    }
+    size_t coords_bytes = header->num_coords * sizeof(point);
+    size_t offsets_bytes = (header->num_elements + 1) * sizeof(uint64_t);
+    size_t connectivity_bytes = header->num_connectivity_entries * sizeof(uint32_t);
+    if(file.size != sizeof(mesh_snapshot_header) + coords_bytes + offsets_bytes + connectivity_bytes) {
+        return false;
+    }
+
+    //the rest of the benchmark takes a std::vector<point>, so this is the one copy out of the mapping.
+    //point is a plain array of doubles, so it is a straight memory copy with nothing to decode
+    const point *coords = (const point *)(file.data + sizeof(mesh_snapshot_header));
+    mesh_coords.assign(coords, coords + header->num_coords);
+    domain_bounds = bbox(point({header->domain_bounds[0], header->domain_bounds[1], header->domain_bounds[2]}),
+                         point({header->domain_bounds[3], header->domain_bounds[4], header->domain_bounds[5]}));
+    num_data_pts = header->num_data_pts;
+
+    //the connectivity is already in csr form, so it is two straight copies as well
+    if(connectivity != nullptr) {
+        const uint64_t *offsets = (const uint64_t *)(file.data + sizeof(mesh_snapshot_header) + coords_bytes);
+        const uint32_t *node_ids = (const uint32_t *)(offsets + header->num_elements + 1);
+        connectivity->offsets.assign(offsets, offsets + header->num_elements + 1);
+        connectivity->node_ids.assign(node_ids, node_ids + header->num_connectivity_entries);
+        connectivity->num_nodes = header->num_connectivity_nodes;
+    }
+    return true;
+}
+
+bool write_mesh_snapshot(const std::string &snapshot_path, const std::string &mesh_file_path, DataType data_type,
+    bool retrieve_nodes, const std::vector<point> &mesh_coords, const bbox &domain_bounds, uint32_t num_data_pts, const element_connectivity *connectivity)
+{
+    mesh_snapshot_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MESH_SNAPSHOT_MAGIC, sizeof(MESH_SNAPSHOT_MAGIC));
+    header.version = MESH_SNAPSHOT_VERSION;
+    header.data_type = data_type;
+    header.retrieve_nodes_for_bboxes = retrieve_nodes;
+    header.num_data_pts = num_data_pts;
+    if(!get_source_stats(mesh_file_path, header.source_size, header.source_mtime_ns)) {
+        return false;
+    }
+    for(int i = 0; i < NUM_DIMS; i++) {
+        header.domain_bounds[i] = domain_bounds.first[i];
+        header.domain_bounds[NUM_DIMS+i] = domain_bounds.second[i];
+    }
+    header.num_coords = mesh_coords.size();
+
+    //an empty connectivity is still written, so the layout is the same either way
+    element_connectivity no_connectivity;
+    if(connectivity == nullptr) {
+        connectivity = &no_connectivity;
+    }
+    header.num_elements = connectivity->num_elements();
+    header.num_connectivity_entries = connectivity->node_ids.size();
+    header.num_connectivity_nodes = connectivity->num_nodes;
+
+    //unique per process, since every rank of a run on the same partition may try to write it
+    std::string temp_path = snapshot_path + ".tmp." + std::to_string(getpid());
+    {
+        std::ofstream out(temp_path, std::ios::binary);
+        out.write((const char *)&header, sizeof(header));
+        out.write((const char *)mesh_coords.data(), mesh_coords.size() * sizeof(point));
+        out.write((const char *)connectivity->offsets.data(), connectivity->offsets.size() * sizeof(uint64_t));
+        out.write((const char *)connectivity->node_ids.data(), connectivity->node_ids.size() * sizeof(uint32_t));
+        if(!out) {
+            out.close();
+            unlink(temp_path.c_str());
+            return false;
+        }
+    }
+    if(rename(temp_path.c_str(), snapshot_path.c_str()) != 0) {
+        unlink(temp_path.c_str());
+        return false;
+    }
+    return true;
+}
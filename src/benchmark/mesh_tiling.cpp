@@ -0,0 +1,170 @@
+#include "mesh_tiling.hh"
+#include "counter_rng.hh"
+#include <cfloat>
+
+#define MESH_JITTER_SEED 400
+
+bool parse_mesh_tiling(const std::string &spec, size_t num_base_data_pts, size_t tiles[NUM_DIMS]) {
+    for(int d = 0; d < NUM_DIMS; d++) {
+        tiles[d] = 1;
+    }
+    size_t num_tiles = 1;
+    try {
+        if(spec.find('x') != std::string::npos) {
+            size_t start = 0;
+            for(int d = 0; d < NUM_DIMS; d++) {
+                size_t end = spec.find('x', start);
+                if((d < NUM_DIMS-1) == (end == std::string::npos)) {
+                    return false;
+                }
+                tiles[d] = std::stoull(spec.substr(start, end - start));
+                //the number of tiles has to fit in a size_t
+                if(tiles[d] == 0 || num_tiles > std::numeric_limits<size_t>::max() / tiles[d]) {
+                    return false;
+                }
+                num_tiles *= tiles[d];
+                start = end + 1;
+            }
+        }
+        else {
+            size_t target_data_pts = std::stoull(spec);
+            if(target_data_pts == 0) {
+                return true;
+            }
+            //no number of copies of an empty mesh reaches the target
+            if(num_base_data_pts == 0) {
+                return false;
+            }
+            //compared in tiles, so the number of data points is never multiplied out
+            size_t target_num_tiles = target_data_pts / num_base_data_pts + (target_data_pts % num_base_data_pts != 0);
+            for(int d = 0; num_tiles < target_num_tiles; d = (d + 1) % NUM_DIMS) {
+                if(num_tiles / tiles[d] > std::numeric_limits<size_t>::max() - num_tiles) {
+                    return false;
+                }
+                num_tiles = num_tiles / tiles[d] * (tiles[d] + 1);
+                tiles[d]++;
+            }
+        }
+    }
+    catch(const std::exception &e) {
+        return false;
+    }
+    return true;
+}
+
+void tile_mesh(DataType data_type, const size_t tiles[NUM_DIMS], double jitter, std::vector<point> &pts, bbox &domain_bounds,
+    uint32_t &num_data_pts, element_connectivity &connectivity)
+{
+    size_t pts_per_item = get_pts_per_item(data_type);
+    size_t num_items = pts.size() / pts_per_item;
+    size_t num_tiles = tiles[0] * tiles[1] * tiles[2];
+    if(num_items == 0 || (num_tiles == 1 && jitter <= 0)) {
+        return;
+    }
+    //node ids and num_data_pts are 32 bit
+    uint64_t num_nodes = std::max((uint64_t)connectivity.num_nodes, (uint64_t)num_data_pts);
+    if(num_nodes * num_tiles > std::numeric_limits<uint32_t>::max()) {
+        std::cerr << "error. tiling the mesh " << num_tiles << " times would give more data points than fit in 32 bits" << std::endl;
+        exit(-1);
+    }
+
+    double extents[NUM_DIMS];
+    double max_jitter[NUM_DIMS];
+    for(int d = 0; d < NUM_DIMS; d++) {
+        extents[d] = domain_bounds.second[d] - domain_bounds.first[d];
+        max_jitter[d] = jitter * extents[d] / std::cbrt((double)num_items);
+    }
+
+    //tile 0 is the original mesh, which the other tiles are copied from
+    pts.resize(num_tiles * pts.size());
+    double min_x = DBL_MAX, min_y = DBL_MAX, min_z = DBL_MAX;
+    double max_x = -DBL_MAX, max_y = -DBL_MAX, max_z = -DBL_MAX;
+    #pragma omp parallel for reduction(min:min_x,min_y,min_z) reduction(max:max_x,max_y,max_z)
+    for(int64_t i = num_items; i < (int64_t)(num_tiles*num_items); i++) {
+        size_t tile = i / num_items;
+        size_t item = i % num_items;
+        size_t tile_indices[NUM_DIMS] = {tile % tiles[0], (tile / tiles[0]) % tiles[1], tile / (tiles[0] * tiles[1])};
+        double offsets[NUM_DIMS];
+        for(int d = 0; d < NUM_DIMS; d++) {
+            offsets[d] = tile_indices[d] * extents[d];
+            if(jitter > 0) {
+                offsets[d] += max_jitter[d] * (2*counter_rng_uniform(MESH_JITTER_SEED, i*NUM_DIMS + d) - 1);
+            }
+        }
+        for(size_t k = 0; k < pts_per_item; k++) {
+            const point &base_pt = pts[pts_per_item*item + k];
+            point &tiled_pt = pts[pts_per_item*i + k];
+            for(int d = 0; d < NUM_DIMS; d++) {
+                tiled_pt[d] = base_pt[d] + offsets[d];
+            }
+        }
+        bbox item_bbox = get_item_bbox(data_type, pts, i);
+        const point &lower = item_bbox.first;
+        const point &upper = item_bbox.second;
+        min_x = std::min(min_x, lower[0]);
+        max_x = std::max(max_x, upper[0]);
+        min_y = std::min(min_y, lower[1]);
+        max_y = std::max(max_y, upper[1]);
+        min_z = std::min(min_z, lower[2]);
+        max_z = std::max(max_z, upper[2]);
+    }
+
+    //tile 0 is only jittered once every other tile has copied it
+    #pragma omp parallel for reduction(min:min_x,min_y,min_z) reduction(max:max_x,max_y,max_z)
+    for(int64_t item = 0; item < (int64_t)num_items; item++) {
+        for(size_t k = 0; k < pts_per_item; k++) {
+            point &pt = pts[pts_per_item*item + k];
+            for(int d = 0; d < NUM_DIMS; d++) {
+                if(jitter > 0) {
+                    //the same offset for all of a bbox's (or triangle's) points
+                    pt[d] += max_jitter[d] * (2*counter_rng_uniform(MESH_JITTER_SEED, item*NUM_DIMS + d) - 1);
+                }
+            }
+        }
+        bbox item_bbox = get_item_bbox(data_type, pts, item);
+        const point &lower = item_bbox.first;
+        const point &upper = item_bbox.second;
+        min_x = std::min(min_x, lower[0]);
+        max_x = std::max(max_x, upper[0]);
+        min_y = std::min(min_y, lower[1]);
+        max_y = std::max(max_y, upper[1]);
+        min_z = std::min(min_z, lower[2]);
+        max_z = std::max(max_z, upper[2]);
+    }
+    domain_bounds = bbox(point({min_x, min_y, min_z}), point({max_x, max_y, max_z}));
+
+    //each copy's elements point at that copy's nodes
+    if(!connectivity.empty()) {
+        size_t num_elements = connectivity.num_elements();
+        size_t num_entries = connectivity.node_ids.size();
+        uint32_t num_base_nodes = connectivity.num_nodes;
+        connectivity.offsets.resize(num_tiles * num_elements + 1);
+        connectivity.node_ids.resize(num_tiles * num_entries);
+        #pragma omp parallel for
+        for(int64_t tile = 1; tile < (int64_t)num_tiles; tile++) {
+            for(size_t e = 0; e < num_elements; e++) {
+                connectivity.offsets[tile*num_elements + e + 1] = tile*num_entries + connectivity.offsets[e + 1];
+            }
+            for(size_t k = 0; k < num_entries; k++) {
+                connectivity.node_ids[tile*num_entries + k] = tile*num_base_nodes + connectivity.node_ids[k];
+            }
+        }
+        connectivity.num_nodes = num_tiles * num_base_nodes;
+
+        //probe queries aren't run on jittered meshes, so each copy's nodes only need the tile's offset
+        if(!connectivity.node_coords.empty()) {
+            connectivity.node_coords.resize(num_tiles * num_base_nodes);
+            #pragma omp parallel for
+            for(int64_t i = num_base_nodes; i < (int64_t)(num_tiles*num_base_nodes); i++) {
+                size_t tile = i / num_base_nodes;
+                size_t tile_indices[NUM_DIMS] = {tile % tiles[0], (tile / tiles[0]) % tiles[1], tile / (tiles[0] * tiles[1])};
+                const point &base_node = connectivity.node_coords[i % num_base_nodes];
+                point &tiled_node = connectivity.node_coords[i];
+                for(int d = 0; d < NUM_DIMS; d++) {
+                    tiled_node[d] = base_node[d] + tile_indices[d] * extents[d];
+                }
+            }
+        }
+    }
+    num_data_pts *= num_tiles;
+}
@@ -0,0 +1,140 @@
+#include "perf_counters.hh"
+#include <iostream>
+
+#ifdef __linux__
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+    #include <cstring>
+#endif
+
+const char *PERF_COUNTER_NAMES[NUM_PERF_COUNTERS] = {
+    "cycles", "instructions", "l1d misses", "llc misses", "dtlb misses", "branch misses", "page faults"
+};
+
+PerfCounters::PerfCounters() {
+    for(int i = 0; i < NUM_PERF_COUNTERS; i++) {
+        fds[i] = -1;
+    }
+}
+
+PerfCounters::~PerfCounters() {
+    #ifdef __linux__
+        for(int i = 0; i < NUM_PERF_COUNTERS; i++) {
+            if(fds[i] != -1) {
+                close(fds[i]);
+            }
+        }
+    #endif
+}
+
+#ifdef __linux__
+static uint64_t make_cache_config(uint64_t cache, uint64_t op, uint64_t result) {
+    return cache | (op << 8) | (result << 16);
+}
+
+static int open_counter(uint32_t type, uint64_t config) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    //lets us scale the count up if the kernel had to multiplex more counters than the PMU has
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    //this thread, on any cpu
+    return syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+#endif
+
+void PerfCounters::open_counters() {
+    opened = true;
+    #ifdef __linux__
+        fds[CYCLES] = open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        fds[INSTRUCTIONS] = open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        fds[L1D_MISSES] = open_counter(PERF_TYPE_HW_CACHE,
+            make_cache_config(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS));
+        fds[LLC_MISSES] = open_counter(PERF_TYPE_HW_CACHE,
+            make_cache_config(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS));
+        fds[DTLB_MISSES] = open_counter(PERF_TYPE_HW_CACHE,
+            make_cache_config(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS));
+        fds[BRANCH_MISSES] = open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+        fds[PAGE_FAULTS] = open_counter(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS);
+    #endif
+
+    size_t num_unavailable = 0;
+    for(int i = 0; i < NUM_PERF_COUNTERS; i++) {
+        if(fds[i] == -1) {
+            num_unavailable++;
+        }
+    }
+    if(num_unavailable > 0) {
+        std::cerr << "error. " << num_unavailable << " of the " << NUM_PERF_COUNTERS << " performance counters could not be opened. they will be reported as NA" << std::endl;
+    }
+}
+
+void PerfCounters::start() {
+    if(!opened) {
+        open_counters();
+    }
+    #ifdef __linux__
+        for(int i = 0; i < NUM_PERF_COUNTERS; i++) {
+            if(fds[i] != -1) {
+                ioctl(fds[i], PERF_EVENT_IOC_RESET, 0);
+                ioctl(fds[i], PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+    #endif
+}
+
+perf_counter_values PerfCounters::stop() {
+    perf_counter_values counters;
+    #ifdef __linux__
+        for(int i = 0; i < NUM_PERF_COUNTERS; i++) {
+            if(fds[i] != -1) {
+                ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+            }
+        }
+        for(int i = 0; i < NUM_PERF_COUNTERS; i++) {
+            //value, time enabled, time running
+            uint64_t data[3];
+            if(fds[i] == -1 || read(fds[i], data, sizeof(data)) != sizeof(data)) {
+                continue;
+            }
+            if(data[2] == 0) {
+                //never got scheduled onto the PMU
+                continue;
+            }
+            counters.values[i] = (data[2] < data[1]) ? (uint64_t)((double)data[0] * data[1] / data[2]) : data[0];
+        }
+    #endif
+    return counters;
+}
+
+void PerfCounters::pause() {
+    #ifdef __linux__
+        for(int i = 0; i < NUM_PERF_COUNTERS; i++) {
+            if(fds[i] != -1) {
+                ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+            }
+        }
+    #endif
+}
+
+void PerfCounters::resume() {
+    #ifdef __linux__
+        for(int i = 0; i < NUM_PERF_COUNTERS; i++) {
+            if(fds[i] != -1) {
+                ioctl(fds[i], PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+    #endif
+}
+
+PerfCounters &phase_perf_counters() {
+    static PerfCounters counters;
+    return counters;
+}
@@ -1,9 +1,12 @@
-//whether we are performing element-based computation using the nodes (meaning we need to retrieve the node ids) or using the elements
-#if RETRIEVE_NODES_FOR_BBOXES
-    #include <set>
-#endif
 #include "data_and_query_generation.hh"
 #include "range_tree_libraries.hh"
+#include "query_thread_pool.hh"
+#include "latency_histogram.hh"
+#include "allocation_counter.hh"
+#include "query_trace.hh"
+#include "element_containment.hh"
+#include <memory>
+#include <thread>
 
 extern bool VALGRIND;
 
@@ -18,31 +21,383 @@ bool check_intersection(const bbox &bounding_box, const point &pt) {
     );
 }
 
-void perform_queries(BboxIntersectionTest *test, const std::string &test_name,
+//make sure the query min is less than the box's max and the box's min is less than the query max
+bool check_bbox_intersection(const bbox &bounding_box, const point &min_corner, const point &max_corner) {
+    return(
+        bounding_box.first[0] <= max_corner[0] && 
+        bounding_box.second[0] >= min_corner[0] && 
+        bounding_box.first[1] <= max_corner[1] && 
+        bounding_box.second[1] >= min_corner[1] && 
+        bounding_box.first[2] <= max_corner[2] && 
+        bounding_box.second[2] >= min_corner[2]
+    );
+}
+
+static bool check_item_intersection(const bbox &query, const std::vector<point> &pts, size_t index, DataType data_type) {
+    if(data_type == BBOXES) {
+        return check_bbox_intersection(query, pts[2*index], pts[2*index+1]);
+    }
+    else if(data_type == TRIANGLES) {
+        return triangle_intersects_bbox(query, pts[3*index], pts[3*index+1], pts[3*index+2]);
+    }
+    return check_intersection(query, pts[index]);
+}
+
+//counts the distinct nodes of a query's elements. instead of clearing a set (or bitmap) for every query, each node is stamped
+//with the query's epoch the first time it is seen, so a query only touches the nodes of its own elements
+class UniqueNodeCounter {
+    public:
+        //sized up front, so counting never allocates
+        void init(const element_connectivity &connectivity) {
+            node_epochs.assign(connectivity.num_nodes, 0);
+            epoch = 0;
+        }
+
+        size_t count(const element_connectivity &connectivity, const size_t *element_indices, size_t num_elements) {
+            epoch++;
+            //the stamps from 2^32 queries ago would look current, so start over
+            if(epoch == 0) {
+                std::fill(node_epochs.begin(), node_epochs.end(), 0);
+                epoch = 1;
+            }
+            uint32_t *epochs = node_epochs.data();
+            size_t num_unique_nodes = 0;
+            for(size_t j = 0; j < num_elements; j++) {
+                const uint32_t *nodes_end = connectivity.nodes_end(element_indices[j]);
+                for(const uint32_t *node = connectivity.nodes_begin(element_indices[j]); node != nodes_end; node++) {
+                    num_unique_nodes += (epochs[*node] != epoch);
+                    epochs[*node] = epoch;
+                }
+            }
+            return num_unique_nodes;
+        }
+
+    private:
+        std::vector<uint32_t> node_epochs;
+        uint32_t epoch = 0;
+};
+
+//returns how many data points the query intersected, after filtering inexact results down to the exact ones.
+//takes a pointer range so it works on both a single query's vector and a slice of batched (CSR) results.
+//exact_intersections and node_counter are scratch space so callers can reuse them across queries
+static size_t count_intersected_data_points(BboxIntersectionTest *test, const bbox &query, const std::vector<point> &pts, 
+    const testing_config &config, const element_connectivity &element_node_ids, 
+    const size_t *result_indices, size_t num_results, std::vector<size_t> &exact_intersections, UniqueNodeCounter &node_counter) 
+{
+    //point queries may be inexact (e.g., because they use a circular radius), as are queries over reduced precision (float) coordinates. 
+    //filter those down to the exact (double precision) results before counting
+    if(!test->intersections_exact()) {
+        exact_intersections.clear();
+        exact_intersections.reserve(num_results);
+        for(size_t i = 0; i < num_results; i++) {
+            size_t index = result_indices[i];
+            if(check_item_intersection(query, pts, index, config.data_type)) {
+                exact_intersections.push_back(index);
+            }
+        }
+        result_indices = exact_intersections.data();
+        num_results = exact_intersections.size();
+    }
+
+    if(config.data_type == POINTS) {
+        return num_results;   
+    }
+    else if(config.retrieve_nodes_for_bboxes) {
+        //performing node-based computation, so we need the distinct nodes of the elements
+        return node_counter.count(element_node_ids, result_indices, num_results);
+    }
+    else {
+        //assumption: we are performing element-based computation, using centroid (or something other than nodes)
+        return num_results;
+    }
+}
+
+//each thread has its own result buffers, which keep their capacity across queries, and its own count. 
+//padded so the threads don't falsely share each other's counts
+struct thread_query_state {
+    std::vector<size_t> query_result_indices;
+    std::vector<size_t> exact_intersections;
+    UniqueNodeCounter node_counter;
+    size_t num_intersected_data_points = 0;
+    char padding[64];
+};
+
+//sleeps until shortly before the deadline and spins the rest of the way, since sleeping alone can overshoot by tens of microseconds
+static void wait_until(std::chrono::steady_clock::time_point deadline) {
+    std::chrono::steady_clock::time_point wait_start_time = std::chrono::steady_clock::now();
+    if(deadline <= wait_start_time) {
+        return;
+    }
+    std::chrono::steady_clock::time_point sleep_deadline = deadline - std::chrono::microseconds(100);
+    if(sleep_deadline > wait_start_time) {
+        std::this_thread::sleep_until(sleep_deadline);
+    }
+    while(std::chrono::steady_clock::now() < deadline) {
+    }
+}
+
+//issues one category of queries across all of the pool's threads against the shared tree. 
+//reports the wall clock time for the whole category and the aggregate throughput (queries per second)
+static void perform_threaded_queries(QueryThreadPool &pool, BboxIntersectionTest *test, const std::string &test_name, 
+    const std::vector<bbox> &queries, double query_percent_data_covered, const std::vector<point> &pts, const testing_config &config, 
+    const element_connectivity &element_node_ids) 
+{
+    std::vector<thread_query_state> thread_states(pool.size());
+    for(thread_query_state &state : thread_states) {
+        state.node_counter.init(element_node_ids);
+    }
+
+    std::chrono::high_resolution_clock::time_point query_start_time = std::chrono::high_resolution_clock::now();
+    pool.run(queries.size(), [&](size_t thread_id, size_t query_index) {
+        thread_query_state &state = thread_states[thread_id];
+        state.query_result_indices.clear();
+        test->get_intersections(queries[query_index], state.query_result_indices);
+        state.num_intersected_data_points += count_intersected_data_points(test, queries[query_index], pts, config, element_node_ids, 
+            state.query_result_indices.data(), state.query_result_indices.size(), state.exact_intersections, state.node_counter);
+    });
+    std::chrono::high_resolution_clock::time_point query_stop_time = std::chrono::high_resolution_clock::now();
+    uint64_t query_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(query_stop_time - query_start_time).count();
+
+    size_t num_intersected_data_points = 0;
+    for(const thread_query_state &state : thread_states) {
+        num_intersected_data_points += state.num_intersected_data_points;
+    }
+    double avg_perc_data_pts_intersected = (num_intersected_data_points / (double)queries.size()) / config.num_data_pts * 100;
+    uint64_t queries_per_second = (query_time_ns == 0) ? 0 : (uint64_t)(queries.size() * 1e9 / query_time_ns);
+
+    std::string threaded_test_name = test_name + " Threads = " + std::to_string(pool.size());
+    print_query_result("threaded query time ", query_percent_data_covered, threaded_test_name, query_time_ns, avg_perc_data_pts_intersected, config);
+    print_query_result("query throughput ", query_percent_data_covered, threaded_test_name, queries_per_second, avg_perc_data_pts_intersected, config);
+}
+
+//issues one category of queries through get_intersections_batch, batch_size queries per call, 
+//and reports the time for the whole category. the last batch may be smaller
+static void perform_batched_queries(size_t batch_size, BboxIntersectionTest *test, const std::string &test_name, 
+    const std::vector<bbox> &queries, double query_percent_data_covered, const std::vector<point> &pts, const testing_config &config, 
+    const element_connectivity &element_node_ids) 
+{
+    batch_results results;
+    std::vector<size_t> exact_intersections;
+    UniqueNodeCounter node_counter;
+    node_counter.init(element_node_ids);
+    size_t num_intersected_data_points = 0;
+
+    std::chrono::high_resolution_clock::time_point query_start_time = std::chrono::high_resolution_clock::now();
+    for(size_t first_query = 0; first_query < queries.size(); first_query += batch_size) {
+        size_t num_queries = std::min(batch_size, queries.size() - first_query);
+        results.clear();
+        test->get_intersections_batch(&queries[first_query], num_queries, results);
+        for(size_t j = 0; j < num_queries; j++) {
+            num_intersected_data_points += count_intersected_data_points(test, queries[first_query+j], pts, config, element_node_ids, 
+                results.results(j), results.num_results(j), exact_intersections, node_counter);
+        }
+    }
+    std::chrono::high_resolution_clock::time_point query_stop_time = std::chrono::high_resolution_clock::now();
+    uint64_t query_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(query_stop_time - query_start_time).count();
+
+    double avg_perc_data_pts_intersected = (num_intersected_data_points / (double)queries.size()) / config.num_data_pts * 100;
+    std::string batched_test_name = test_name + " Batch Size = " + std::to_string(batch_size);
+    print_query_result("batched query time ", query_percent_data_covered, batched_test_name, query_time_ns, avg_perc_data_pts_intersected, config);
+}
+
+//only counts the results that pass the exact (double precision) check, so inexact libraries can be timed without materializing their results
+class ExactCountSink : public ResultSink {
+    public:
+        size_t count = 0;
+
+        ExactCountSink(const bbox &query_, const std::vector<point> &pts_, DataType data_type_) : query(query_), pts(pts_), data_type(data_type_) {}
+
+        void push(size_t index) {
+            if(check_item_intersection(query, pts, index, data_type)) {
+                count++;
+            }
+        }
+
+    private:
+        const bbox &query;
+        const std::vector<point> &pts;
+        DataType data_type;
+};
+
+//issues one category of queries through visit_intersections with a sink that only counts the results, and reports the time for the whole category.
+//libraries that don't visit natively still materialize each query's results, so their rows are labeled "Count Only Materialized" to keep
+//them from being compared with the true count only rows
+static void perform_count_only_queries(BboxIntersectionTest *test, const std::string &test_name, 
+    const std::vector<bbox> &queries, double query_percent_data_covered, const std::vector<point> &pts, const testing_config &config) 
+{
+    size_t num_intersected_data_points = 0;
+
+    std::chrono::high_resolution_clock::time_point query_start_time = std::chrono::high_resolution_clock::now();
+    for(size_t j = 0; j < queries.size(); j++) {
+        if(test->intersections_exact()) {
+            CountSink sink;
+            test->visit_intersections(queries[j], sink);
+            num_intersected_data_points += sink.count;
+        }
+        else {
+            ExactCountSink sink(queries[j], pts, config.data_type);
+            test->visit_intersections(queries[j], sink);
+            num_intersected_data_points += sink.count;
+        }
+    }
+    std::chrono::high_resolution_clock::time_point query_stop_time = std::chrono::high_resolution_clock::now();
+    uint64_t query_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(query_stop_time - query_start_time).count();
+
+    double avg_perc_data_pts_intersected = (num_intersected_data_points / (double)queries.size()) / config.num_data_pts * 100;
+    std::string count_only_name = test_name + (test->visits_natively() ? " Count Only" : " Count Only Materialized");
+    print_query_result("count only query time ", query_percent_data_covered, count_only_name, query_time_ns, avg_perc_data_pts_intersected, config);
+}
+
+//locates each probe point: the test's intersections with the (degenerate) box at the probe are the candidates, which are then
+//filtered down to the elements that actually contain it. reports the time for all of the probes and per probe, and the total
+//number of candidates and of elements containing a probe. the % intersected is the average % of the elements containing a probe
+static void perform_probe_queries(BboxIntersectionTest *test, const std::string &test_name, const std::vector<point> &probes,
+    const testing_config &config, const element_connectivity &element_node_ids)
+{
+    ElementContainment containment(element_node_ids);
+    std::vector<size_t> candidates;
+    size_t num_candidates = 0;
+    size_t num_hits = 0;
+
+    std::chrono::high_resolution_clock::time_point query_start_time = std::chrono::high_resolution_clock::now();
+    for(const point &probe : probes) {
+        candidates.clear();
+        test->get_intersections(bbox(probe, probe), candidates);
+        num_candidates += candidates.size();
+        num_hits += containment.contains(probe, candidates.data(), candidates.size(), candidates.data());
+    }
+    std::chrono::high_resolution_clock::time_point query_stop_time = std::chrono::high_resolution_clock::now();
+    uint64_t query_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(query_stop_time - query_start_time).count();
+
+    double avg_perc_elements_hit = (num_hits / (double)probes.size()) / element_node_ids.num_elements() * 100;
+    print_query_result("probe query time ", 0, test_name, query_time_ns, avg_perc_elements_hit, config);
+    print_query_result("probe time per probe ", 0, test_name, query_time_ns / probes.size(), avg_perc_elements_hit, config);
+    print_query_result("probe candidates ", 0, test_name, num_candidates, avg_perc_elements_hit, config);
+    print_query_result("probe hits ", 0, test_name, num_hits, avg_perc_elements_hit, config);
+}
+
+void perform_queries(BboxIntersectionTest *test, const std::string &library_test_name,
     const std::vector<point> &pts, const std::vector<size_t> &indices, testing_config config, QueryType query_type,
-    const std::vector<std::vector<size_t>> &element_node_ids) 
+    const element_connectivity &element_node_ids) 
 {   
+    //so rows from different query sets can be told apart
+    std::string test_name = library_test_name;
+    if(config.query_set == HOTSPOT_QUERIES) {
+        test_name += " Hotspot Queries";
+    }
+    else if(config.query_set == RANDOM_WALK_QUERIES) {
+        test_name += " Random Walk Queries";
+    }
 
     if(!VALGRIND) {
 
         //contains queries for each category (those that cover a very small portion of the domain, a small portion, a moderate portion, and a large portion)
         std::vector<std::vector<bbox>> all_queries; 
         std::vector<double> queries_percent_data_covered;
-        get_queries_specific_feature_sizes(config, all_queries, queries_percent_data_covered);
+        //replayed queries keep their trace record's index, for its timestamp and think time
+        std::vector<query_trace_record> trace_records;
+        std::vector<std::vector<size_t>> trace_record_indices;
+        bool replay_trace = config.query_trace_mode == REPLAY_QUERY_TRACE_CLOSED_LOOP || config.query_trace_mode == REPLAY_QUERY_TRACE_TIMED;
+        bool record_trace = config.query_trace_mode == RECORD_QUERY_TRACE;
+        bool calibrated_queries = false;
+        if(replay_trace) {
+            bool trace_read = read_query_trace(config.query_trace_path, trace_records);
+            if(trace_read) {
+                get_queries_from_trace(trace_records, all_queries, queries_percent_data_covered, trace_record_indices);
+            }
+            //checked on every rank before any of them starts replaying, so they all exit together
+            if(!query_traces_match_across_ranks(trace_read, all_queries, queries_percent_data_covered)) {
+                exit(-1);
+            }
+        }
+        else if(config.query_selectivities.empty()) {
+            get_queries_specific_feature_sizes(config, all_queries, queries_percent_data_covered);
+        }
+        else {
+            get_queries_calibrated_selectivity(config, pts, all_queries, queries_percent_data_covered);
+            calibrated_queries = true;
+        }
+        //a replayed trace is already placed
+        if(!replay_trace) {
+            apply_query_set(config, all_queries);
+        }
+        if(record_trace) {
+            //so recording doesn't allocate during the queries
+            size_t num_queries = 0;
+            for(const std::vector<bbox> &queries : all_queries) {
+                num_queries += queries.size();
+            }
+            trace_records.reserve(num_queries);
+        }
+        std::chrono::steady_clock::time_point trace_start_time = std::chrono::steady_clock::now();
+
+        //the single threaded timing is always reported. the threaded run is in addition to it so the two can be compared
+        std::unique_ptr<QueryThreadPool> query_thread_pool;
+        if(config.num_threads > 1) {
+            if(query_type != STANDARD) {
+                std::cerr << "error. multithreaded queries are only supported for the STANDARD query type. only issuing queries serially" << std::endl;
+            }
+            else if(!test->concurrent_queries_safe()) {
+                std::cerr << "error. " << test_name << " does not support concurrent queries. only issuing queries serially" << std::endl;
+            }
+            else {
+                query_thread_pool.reset(new QueryThreadPool(config.num_threads));
+            }
+        }
+
+        //the node ids have to be gathered from each element's results, so there is nothing to count without materializing them
+        bool count_only_queries = config.count_only_queries && query_type == STANDARD;
+        if(count_only_queries && config.data_type == BBOXES && config.retrieve_nodes_for_bboxes) {
+            std::cerr << "error. count only queries are not supported when retrieving the nodes for bboxes. skipping them" << std::endl;
+            count_only_queries = false;
+        }
+        if(config.data_type == BBOXES && config.retrieve_nodes_for_bboxes && element_node_ids.num_elements() != pts.size()/2) {
+            std::cerr << "error. retrieving the nodes for bboxes requires the connectivity of every element. exiting" << std::endl;
+            exit(-1);
+        }
+
 
+        LatencyHistogram query_latencies;
+        QueryTimer query_timer;
+        //reused across queries so that once they have grown to fit the largest result, the harness itself doesn't allocate
+        std::vector<size_t> query_result_indices;
+        std::vector<size_t> exact_intersections;
+        UniqueNodeCounter node_counter;
+        node_counter.init(element_node_ids);
 
         for(size_t i = 0; i < all_queries.size(); i++) {
-            std::chrono::high_resolution_clock::time_point query_start_time = std::chrono::high_resolution_clock::now();
+            query_latencies.clear();
+            uint64_t num_allocations = 0;
+            uint64_t max_query_allocations = 0;
+            //the counters only run during the queries, like the category's time, which is the sum of the queries' times
+            if(config.use_perf_counters) {
+                phase_perf_counters().start();
+                phase_perf_counters().pause();
+            }
+            std::chrono::nanoseconds category_query_time(0);
+            std::chrono::steady_clock::time_point replay_start_time = std::chrono::steady_clock::now();
             size_t num_intersected_data_points = 0;
+            uint64_t num_nodes_visited_before = test->get_num_nodes_visited();
 
             for(int j = 0; j < all_queries[i].size(); j++) {
-                bbox query = all_queries[i][j];
-                std::vector<size_t> query_result_indices;
+                const bbox &query = all_queries[i][j];
+                //timed replay waits for the query's timestamp (relative to the category's first query)
+                if(config.query_trace_mode == REPLAY_QUERY_TRACE_TIMED) {
+                    const query_trace_record &record = trace_records[trace_record_indices[i][j]];
+                    uint64_t offset_ns = record.timestamp_ns - trace_records[trace_record_indices[i][0]].timestamp_ns;
+                    wait_until(replay_start_time + std::chrono::nanoseconds(offset_ns));
+                }
+                query_result_indices.clear();
                 if(DEBUG) {
                     std::cout << "query: ";
                     print_bbox(query);
                 }
 
+                uint64_t num_allocations_before_query = get_num_allocations();
+                if(config.use_perf_counters) {
+                    phase_perf_counters().resume();
+                }
+                query_timer.start();
                 if(query_type == GPU_DOMAIN_DECOMP) {
                     #ifdef TEST_PCL
                         size_t num_sub_queries = 24;
@@ -59,52 +414,103 @@ void perform_queries(BboxIntersectionTest *test, const std::string &test_name,
                     test->get_intersections(query, query_result_indices);
                 }
 
-                //point queries may be inexact (e.g., because they use a circular radius). Box and triangle queries will always be exact
-                if(!test->intersections_exact()) {
-                    std::vector<size_t> exact_intersections;
-                    exact_intersections.reserve(query_result_indices.size());
-                    for(auto index : query_result_indices) {
-                        if(check_intersection(query, pts[index])) {
-                            exact_intersections.push_back(index);
-                            if(DEBUG) {
-                                print_data(pts, index, config.data_type);
-                            }
-                        }
-                    }
-                    num_intersected_data_points += exact_intersections.size();
+                num_intersected_data_points += count_intersected_data_points(test, query, pts, config, element_node_ids, 
+                    query_result_indices.data(), query_result_indices.size(), exact_intersections, node_counter);
+                uint64_t query_latency_ns = query_timer.stop();
+                if(config.use_perf_counters) {
+                    phase_perf_counters().pause();
                 }
-                else {
-                    if(config.data_type == POINTS) {
-                        num_intersected_data_points += query_result_indices.size();   
-                    }
-                    else {
-                        #if RETRIEVE_NODES_FOR_BBOXES
-                            std::set<size_t> node_indices;
-                            for(size_t element_index : query_result_indices) {
-                                for(size_t i = 0; i < element_node_ids[element_index].size(); i++) {
-                                    node_indices.insert(element_node_ids[element_index][i]);
-                                }
-                            }
-                            num_intersected_data_points += node_indices.size();
-                        #else
-                            //assumption: we are performing element-based computation, using centroid (or something other than nodes)
-                            num_intersected_data_points += query_result_indices.size();
-                        #endif
+                query_latencies.record(query_latency_ns);
+                uint64_t query_allocations = get_num_allocations() - num_allocations_before_query;
+                num_allocations += query_allocations;
+                max_query_allocations = std::max(max_query_allocations, query_allocations);
+                category_query_time += query_timer.get_stop_time() - query_timer.get_start_time();
+
+                //the harness issues its queries back to back, so there is no think time to record. the gap between its queries is
+                //only its own bookkeeping, which a replay shouldn't reproduce
+                if(record_trace) {
+                    query_trace_record record;
+                    record.timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(query_timer.get_start_time() - trace_start_time).count();
+                    record.think_time_ns = 0;
+                    record.category = queries_percent_data_covered[i];
+                    for(int d = 0; d < NUM_DIMS; d++) {
+                        record.lower_corner[d] = query.first[d];
+                        record.upper_corner[d] = query.second[d];
                     }
-                    if(DEBUG) {
-                        std::cout << "query_result_indices.size(): "  << query_result_indices.size() << std::endl;    
-                    }        
+                    trace_records.push_back(record);
+                }
+                //closed loop replay pauses for the client's think time before the next query
+                if(config.query_trace_mode == REPLAY_QUERY_TRACE_CLOSED_LOOP && trace_records[trace_record_indices[i][j]].think_time_ns > 0) {
+                    uint64_t think_time_ns = trace_records[trace_record_indices[i][j]].think_time_ns;
+                    wait_until(std::chrono::steady_clock::now() + std::chrono::nanoseconds(think_time_ns));
                 }
-                if(DEBUG && test->intersections_exact()) {
+                if(DEBUG) {
+                    std::cout << "query_result_indices.size(): "  << query_result_indices.size() << std::endl;    
                     for(auto index : query_result_indices) {
                         print_data(pts, index, config.data_type);
                     }
                 }
             }
+            uint64_t query_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(category_query_time).count();
+            uint64_t num_nodes_visited = test->get_num_nodes_visited() - num_nodes_visited_before;
+            perf_counter_values counters;
+            if(config.use_perf_counters) {
+                counters = phase_perf_counters().stop();
+            }
 
-            //if data_type==BBOXES not RETRIEVE_NODES_FOR_BBOXES, num data pts will be set to num elements
+            //if data_type==BBOXES and not retrieve_nodes_for_bboxes, num data pts will be set to num elements
             double avg_perc_data_pts_intersected = (num_intersected_data_points / (double)all_queries[i].size()) / config.num_data_pts * 100;
-            print_query_time(queries_percent_data_covered[i], test_name, query_start_time, avg_perc_data_pts_intersected, config);
+            print_query_result("query time ", queries_percent_data_covered[i], test_name, query_time_ns, avg_perc_data_pts_intersected, config, counters);
+            print_query_latencies(queries_percent_data_covered[i], test_name, query_latencies, avg_perc_data_pts_intersected, config);
+            //the number of heap allocations made across all of the category's queries and by the single worst query
+            print_query_result("query allocations total ", queries_percent_data_covered[i], test_name, num_allocations, avg_perc_data_pts_intersected, config);
+            print_query_result("query allocations max ", queries_percent_data_covered[i], test_name, max_query_allocations, avg_perc_data_pts_intersected, config);
+            //how far the selectivity achieved on the full data is from the target, in parts per million of the target
+            if(calibrated_queries) {
+                uint64_t selectivity_error_ppm = std::llround(std::fabs(avg_perc_data_pts_intersected - queries_percent_data_covered[i]) / queries_percent_data_covered[i] * 1e6);
+                print_query_result("query selectivity error ", queries_percent_data_covered[i], test_name, selectivity_error_ppm, avg_perc_data_pts_intersected, config);
+            }
+            //so trees that count the nodes they visit can be compared by traversal work as well as by time
+            if(test->counts_nodes_visited() && !all_queries[i].empty()) {
+                print_query_result("nodes visited per query ", queries_percent_data_covered[i], test_name, num_nodes_visited / all_queries[i].size(), avg_perc_data_pts_intersected, config);
+                print_query_result("time per query ", queries_percent_data_covered[i], test_name, query_time_ns / all_queries[i].size(), avg_perc_data_pts_intersected, config);
+            }
+
+            if(query_thread_pool) {
+                perform_threaded_queries(*query_thread_pool, test, test_name, all_queries[i], queries_percent_data_covered[i], 
+                    pts, config, element_node_ids);
+            }
+
+            //sweeps the batch size by powers of two, always ending at max_batch_size
+            if(config.max_batch_size > 0 && query_type == STANDARD) {
+                for(size_t batch_size = 1; ; batch_size *= 2) {
+                    batch_size = std::min(batch_size, config.max_batch_size);
+                    perform_batched_queries(batch_size, test, test_name, all_queries[i], queries_percent_data_covered[i], 
+                        pts, config, element_node_ids);
+                    if(batch_size == config.max_batch_size) {
+                        break;
+                    }
+                }
+            }
+
+            if(count_only_queries) {
+                perform_count_only_queries(test, test_name, all_queries[i], queries_percent_data_covered[i], pts, config);
+            }
+        }
+
+        if(config.num_probe_queries > 0) {
+            if(config.data_type != BBOXES || element_node_ids.node_coords.empty()) {
+                std::cerr << "error. probe queries need the elements' connectivity and node coordinates. skipping them" << std::endl;
+            }
+            else {
+                std::vector<point> probes;
+                get_probe_points(config.num_probe_queries, element_node_ids, probes);
+                perform_probe_queries(test, test_name, probes, config, element_node_ids);
+            }
+        }
+
+        if(record_trace && !write_query_trace(config.query_trace_path, trace_records)) {
+            std::cerr << "error. could not write the query trace: " << config.query_trace_path << std::endl;
         }
 
     }
@@ -0,0 +1,110 @@
+#include "query_thread_pool.hh"
+
+QueryThreadPool::QueryThreadPool(size_t n_threads) {
+    num_threads = (n_threads == 0) ? 1 : n_threads;
+    queues.reserve(num_threads);
+    for(size_t i = 0; i < num_threads; i++) {
+        queues.push_back(std::unique_ptr<WorkQueue>(new WorkQueue()));
+    }
+    workers.reserve(num_threads-1);
+    for(size_t i = 1; i < num_threads; i++) {
+        workers.push_back(std::thread(&QueryThreadPool::worker_loop, this, i));
+    }
+}
+
+QueryThreadPool::~QueryThreadPool() {
+    {
+        std::lock_guard<std::mutex> guard(job_lock);
+        shutting_down = true;
+    }
+    job_ready.notify_all();
+    for(std::thread &worker : workers) {
+        worker.join();
+    }
+}
+
+void QueryThreadPool::run(size_t num_queries, const query_func &func) {
+    //hand out contiguous blocks so each thread walks its own portion of the queries in order
+    size_t block_size = num_queries / num_threads;
+    size_t remainder = num_queries % num_threads;
+    size_t start = 0;
+    for(size_t i = 0; i < num_threads; i++) {
+        size_t end = start + block_size + (i < remainder ? 1 : 0);
+        std::lock_guard<std::mutex> guard(queues[i]->lock);
+        queues[i]->query_indices.clear();
+        for(size_t j = start; j < end; j++) {
+            queues[i]->query_indices.push_back(j);
+        }
+        start = end;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(job_lock);
+        job = &func;
+        num_workers_done = 0;
+        job_generation++;
+    }
+    job_ready.notify_all();
+
+    process_queries(0, func);
+
+    std::unique_lock<std::mutex> lock(job_lock);
+    job_done.wait(lock, [this] { return num_workers_done == workers.size(); });
+    job = nullptr;
+}
+
+void QueryThreadPool::worker_loop(size_t thread_id) {
+    size_t last_generation = 0;
+    while(true) {
+        const query_func *my_job;
+        {
+            std::unique_lock<std::mutex> lock(job_lock);
+            job_ready.wait(lock, [this, last_generation] { return shutting_down || job_generation != last_generation; });
+            if(shutting_down) {
+                return;
+            }
+            last_generation = job_generation;
+            my_job = job;
+        }
+
+        process_queries(thread_id, *my_job);
+
+        {
+            std::lock_guard<std::mutex> guard(job_lock);
+            num_workers_done++;
+        }
+        job_done.notify_one();
+    }
+}
+
+void QueryThreadPool::process_queries(size_t thread_id, const query_func &func) {
+    size_t query_index;
+    while(pop_own(thread_id, query_index) || steal(thread_id, query_index)) {
+        func(thread_id, query_index);
+    }
+}
+
+bool QueryThreadPool::pop_own(size_t thread_id, size_t &query_index) {
+    WorkQueue &queue = *queues[thread_id];
+    std::lock_guard<std::mutex> guard(queue.lock);
+    if(queue.query_indices.empty()) {
+        return false;
+    }
+    query_index = queue.query_indices.front();
+    queue.query_indices.pop_front();
+    return true;
+}
+
+//no new work is added during a run, so once every queue is empty this thread is done
+bool QueryThreadPool::steal(size_t thread_id, size_t &query_index) {
+    for(size_t i = 1; i < num_threads; i++) {
+        WorkQueue &victim = *queues[(thread_id + i) % num_threads];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if(!victim.query_indices.empty()) {
+            query_index = victim.query_indices.back();
+            victim.query_indices.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
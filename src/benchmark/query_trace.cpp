@@ -0,0 +1,128 @@
+#include "query_trace.hh"
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+static const char QUERY_TRACE_MAGIC[8] = {'R', 'T', 'T', 'R', 'A', 'C', 'E', '\0'};
+
+//everything is stored in the host's byte order
+struct query_trace_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t num_records;
+};
+
+std::string get_query_trace_path(const std::string &path, int rank, int comm_size) {
+    return (comm_size > 1) ? path + "." + std::to_string(rank) : path;
+}
+
+std::string get_subsample_query_trace_path(const std::string &path, double subsample_percent) {
+    std::ostringstream subsample_path;
+    subsample_path << path << ".subsample_" << subsample_percent;
+    return subsample_path.str();
+}
+
+bool write_query_trace(const std::string &path, const std::vector<query_trace_record> &records) {
+    query_trace_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, QUERY_TRACE_MAGIC, sizeof(QUERY_TRACE_MAGIC));
+    header.version = QUERY_TRACE_VERSION;
+    header.record_size = sizeof(query_trace_record);
+    header.num_records = records.size();
+
+    std::ofstream out(path, std::ios::binary);
+    out.write((const char *)&header, sizeof(header));
+    out.write((const char *)records.data(), records.size() * sizeof(query_trace_record));
+    return (bool)out;
+}
+
+bool read_query_trace(const std::string &path, std::vector<query_trace_record> &records) {
+    std::ifstream in(path, std::ios::binary);
+    if(!in) {
+        std::cerr << "error. could not open the query trace: " << path << std::endl;
+        return false;
+    }
+    query_trace_header header;
+    if(!in.read((char *)&header, sizeof(header)) || memcmp(header.magic, QUERY_TRACE_MAGIC, sizeof(QUERY_TRACE_MAGIC)) != 0) {
+        std::cerr << "error. " << path << " is not a query trace" << std::endl;
+        return false;
+    }
+    if(header.version != QUERY_TRACE_VERSION || header.record_size != sizeof(query_trace_record)) {
+        std::cerr << "error. " << path << " is a version " << header.version << " query trace, but version " << QUERY_TRACE_VERSION << " is expected" << std::endl;
+        return false;
+    }
+    records.resize(header.num_records);
+    if(!in.read((char *)records.data(), records.size() * sizeof(query_trace_record))) {
+        std::cerr << "error. the query trace " << path << " is truncated" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void get_queries_from_trace(const std::vector<query_trace_record> &records, std::vector<std::vector<bbox>> &all_queries,
+    std::vector<double> &categories, std::vector<std::vector<size_t>> &record_indices)
+{
+    all_queries.clear();
+    categories.clear();
+    record_indices.clear();
+    for(size_t i = 0; i < records.size(); i++) {
+        const query_trace_record &record = records[i];
+        size_t category_index = std::find(categories.begin(), categories.end(), record.category) - categories.begin();
+        if(category_index == categories.size()) {
+            categories.push_back(record.category);
+            all_queries.push_back(std::vector<bbox>());
+            record_indices.push_back(std::vector<size_t>());
+        }
+        all_queries[category_index].push_back(bbox(point({record.lower_corner[0], record.lower_corner[1], record.lower_corner[2]}),
+                                                    point({record.upper_corner[0], record.upper_corner[1], record.upper_corner[2]})));
+        record_indices[category_index].push_back(i);
+    }
+}
+
+bool query_traces_match_across_ranks(bool trace_read, const std::vector<std::vector<bbox>> &all_queries, const std::vector<double> &categories) {
+    if(!USE_MPI) {
+        return trace_read;
+    }
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    //the min and max across the ranks of whether they read their trace and of their number of categories
+    uint64_t shape[2] = {trace_read, categories.size()};
+    uint64_t min_shape[2], max_shape[2];
+    MPI_Allreduce(shape, min_shape, 2, MPI_UINT64_T, MPI_MIN, MPI_COMM_WORLD);
+    MPI_Allreduce(shape, max_shape, 2, MPI_UINT64_T, MPI_MAX, MPI_COMM_WORLD);
+    if(min_shape[0] == 0) {
+        if(rank == 0) {
+            std::cerr << "error. not every rank could read its query trace" << std::endl;
+        }
+        return false;
+    }
+    if(min_shape[1] != max_shape[1]) {
+        if(rank == 0) {
+            std::cerr << "error. the ranks' query traces have between " << min_shape[1] << " and " << max_shape[1] << " categories. they need the same ones" << std::endl;
+        }
+        return false;
+    }
+
+    std::vector<uint64_t> num_queries(categories.size());
+    for(size_t i = 0; i < categories.size(); i++) {
+        num_queries[i] = all_queries[i].size();
+    }
+    std::vector<uint64_t> min_num_queries(categories.size()), max_num_queries(categories.size());
+    std::vector<double> min_categories(categories.size()), max_categories(categories.size());
+    MPI_Allreduce(num_queries.data(), min_num_queries.data(), num_queries.size(), MPI_UINT64_T, MPI_MIN, MPI_COMM_WORLD);
+    MPI_Allreduce(num_queries.data(), max_num_queries.data(), num_queries.size(), MPI_UINT64_T, MPI_MAX, MPI_COMM_WORLD);
+    MPI_Allreduce(categories.data(), min_categories.data(), categories.size(), MPI_DOUBLE, MPI_MIN, MPI_COMM_WORLD);
+    MPI_Allreduce(categories.data(), max_categories.data(), categories.size(), MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    for(size_t i = 0; i < categories.size(); i++) {
+        if(min_categories[i] != max_categories[i] || min_num_queries[i] != max_num_queries[i]) {
+            if(rank == 0) {
+                std::cerr << "error. the ranks' query traces don't match in category " << i << ": its value is between " << min_categories[i] << 
+                    " and " << max_categories[i] << " and it has between " << min_num_queries[i] << " and " << max_num_queries[i] << " queries" << std::endl;
+            }
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,220 @@
+#include "scaling_sweep.hh"
+#include "counter_rng.hh"
+#include <cfloat>
+#include <sstream>
+
+#define SUBSAMPLE_SEED 500
+
+//the morton codes use 21 bits per dimension
+#define MORTON_BITS_PER_DIM 21
+
+struct sweep_series {
+    std::string category;
+    std::string test_name;
+    std::vector<double> num_data_pts;
+    std::vector<double> values;
+};
+
+static bool recording_sweep = false;
+static std::vector<sweep_series> sweep_samples;
+
+bool parse_sweep_percents(const std::string &spec, std::vector<double> &percents) {
+    percents.clear();
+    try {
+        std::stringstream ss(spec);
+        std::string percent;
+        while(std::getline(ss, percent, ',')) {
+            percents.push_back(std::stod(percent));
+            if(percents.back() <= 0 || percents.back() > 100) {
+                return false;
+            }
+        }
+    }
+    catch(const std::exception &e) {
+        return false;
+    }
+    std::sort(percents.begin(), percents.end());
+    percents.erase(std::unique(percents.begin(), percents.end()), percents.end());
+    return !percents.empty();
+}
+
+//spreads the low 21 bits of x out to every third bit
+static uint64_t spread_morton_bits(uint64_t x) {
+    x &= 0x1fffff;
+    x = (x | x << 32) & 0x1f00000000ffffULL;
+    x = (x | x << 16) & 0x1f0000ff0000ffULL;
+    x = (x | x << 8) & 0x100f00f00f00f00fULL;
+    x = (x | x << 4) & 0x10c30c30c30c30c3ULL;
+    x = (x | x << 2) & 0x1249249249249249ULL;
+    return x;
+}
+
+std::vector<size_t> get_subsample_order(SubsampleMode subsample_mode, DataType data_type, const std::vector<point> &pts, const bbox &domain_bounds) {
+    size_t num_items = pts.size() / get_pts_per_item(data_type);
+
+    //sorted by key, with the item's index breaking ties so the order is the same on every platform
+    std::vector<std::pair<uint64_t, size_t>> keys(num_items);
+    #pragma omp parallel for
+    for(int64_t i = 0; i < (int64_t)num_items; i++) {
+        uint64_t key = 0;
+        if(subsample_mode == SPATIAL_SUBSAMPLES) {
+            //the code of the item's center
+            bbox item_bbox = get_item_bbox(data_type, pts, i);
+            for(int d = 0; d < NUM_DIMS; d++) {
+                double extent = domain_bounds.second[d] - domain_bounds.first[d];
+                double fraction = (extent > 0) ? ((item_bbox.first[d] + item_bbox.second[d]) / 2 - domain_bounds.first[d]) / extent : 0;
+                uint64_t cell = (uint64_t)(std::min(std::max(fraction, 0.0), 1.0) * ((1 << MORTON_BITS_PER_DIM) - 1));
+                key |= spread_morton_bits(cell) << d;
+            }
+        }
+        else {
+            key = counter_rng(SUBSAMPLE_SEED, i);
+        }
+        keys[i] = std::make_pair(key, (size_t)i);
+    }
+    std::sort(keys.begin(), keys.end());
+
+    std::vector<size_t> order(num_items);
+    for(size_t i = 0; i < num_items; i++) {
+        order[i] = keys[i].second;
+    }
+    return order;
+}
+
+void get_subsample(DataType data_type, const std::vector<point> &pts, const std::vector<size_t> &order, size_t num_items,
+    bool retrieve_nodes, const element_connectivity &connectivity, std::vector<point> &subsample_pts, bbox &subsample_bounds,
+    uint32_t &num_data_pts, element_connectivity &subsample_connectivity)
+{
+    size_t pts_per_item = get_pts_per_item(data_type);
+    //the loaded order keeps the mesh's locality, which some of the libraries' build times depend on
+    std::vector<size_t> items(order.begin(), order.begin() + num_items);
+    std::sort(items.begin(), items.end());
+
+    subsample_pts.resize(pts_per_item * num_items);
+    double min_x = DBL_MAX, min_y = DBL_MAX, min_z = DBL_MAX;
+    double max_x = -DBL_MAX, max_y = -DBL_MAX, max_z = -DBL_MAX;
+    #pragma omp parallel for reduction(min:min_x,min_y,min_z) reduction(max:max_x,max_y,max_z)
+    for(int64_t i = 0; i < (int64_t)num_items; i++) {
+        for(size_t k = 0; k < pts_per_item; k++) {
+            subsample_pts[pts_per_item*i + k] = pts[pts_per_item*items[i] + k];
+        }
+        bbox item_bbox = get_item_bbox(data_type, subsample_pts, i);
+        const point &lower = item_bbox.first;
+        const point &upper = item_bbox.second;
+        min_x = std::min(min_x, lower[0]);
+        max_x = std::max(max_x, upper[0]);
+        min_y = std::min(min_y, lower[1]);
+        max_y = std::max(max_y, upper[1]);
+        min_z = std::min(min_z, lower[2]);
+        max_z = std::max(max_z, upper[2]);
+    }
+    subsample_bounds = bbox(point({min_x, min_y, min_z}), point({max_x, max_y, max_z}));
+
+    subsample_connectivity.clear();
+    num_data_pts = num_items;
+    //probe queries need the connectivity (and node coordinates) even if the nodes aren't retrieved
+    if((retrieve_nodes || !connectivity.node_coords.empty()) && !connectivity.empty()) {
+        //the node ids aren't renumbered, so the node counters stay sized by the full mesh's node count
+        std::vector<bool> used_nodes(connectivity.num_nodes, false);
+        size_t num_used_nodes = 0;
+        for(size_t i = 0; i < num_items; i++) {
+            for(const uint32_t *node = connectivity.nodes_begin(items[i]); node != connectivity.nodes_end(items[i]); node++) {
+                subsample_connectivity.node_ids.push_back(*node);
+                if(!used_nodes[*node]) {
+                    used_nodes[*node] = true;
+                    num_used_nodes++;
+                }
+            }
+            subsample_connectivity.offsets.push_back(subsample_connectivity.node_ids.size());
+        }
+        subsample_connectivity.num_nodes = connectivity.num_nodes;
+        subsample_connectivity.node_coords = connectivity.node_coords;
+        if(retrieve_nodes) {
+            num_data_pts = num_used_nodes;
+        }
+    }
+}
+
+void record_sweep_sample(const std::string &category, const std::string &test_name, size_t num_data_pts, uint64_t value) {
+    if(!recording_sweep) {
+        return;
+    }
+    for(sweep_series &series : sweep_samples) {
+        if(series.category == category && series.test_name == test_name) {
+            series.num_data_pts.push_back(num_data_pts);
+            series.values.push_back(value);
+            return;
+        }
+    }
+    sweep_samples.push_back(sweep_series{category, test_name, {(double)num_data_pts}, {(double)value}});
+}
+
+void start_sweep_recording() {
+    sweep_samples.clear();
+    recording_sweep = true;
+}
+
+//NAN if there are fewer than 2 distinct sizes with a nonzero time
+static double get_complexity_exponent(const sweep_series &series) {
+    double sum_x = 0, sum_y = 0, sum_xx = 0, sum_xy = 0;
+    size_t n = 0;
+    for(size_t i = 0; i < series.values.size(); i++) {
+        if(series.values[i] <= 0 || series.num_data_pts[i] <= 0) {
+            continue;
+        }
+        double x = std::log(series.num_data_pts[i]);
+        double y = std::log(series.values[i]);
+        sum_x += x;
+        sum_y += y;
+        sum_xx += x*x;
+        sum_xy += x*y;
+        n++;
+    }
+    double denominator = n*sum_xx - sum_x*sum_x;
+    if(n < 2 || denominator <= 1e-12) {
+        return NAN;
+    }
+    return (n*sum_xy - sum_x*sum_y) / denominator;
+}
+
+static void print_complexity_exponent(const std::string &category, const std::string &test_name, double exponent, const testing_config &config) {
+    std::cout << "complexity exponent " << category << ", " << test_name << ", ";
+    if(std::isnan(exponent)) {
+        std::cout << "NA";
+    }
+    else {
+        std::cout << exponent;
+    }
+    std::cout << ", 0";
+    print_config(config);
+}
+
+void print_complexity_exponents(const testing_config &config) {
+    recording_sweep = false;
+    int num_procs, rank;
+
+    if(USE_MPI) {
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+        MPI_Comm_size(MPI_COMM_WORLD, &num_procs);
+        std::vector<testing_config> all_configs;
+        gatherv_ser_and_combine(config, num_procs, rank, MPI_COMM_WORLD, all_configs);
+
+        //every rank runs the same tests, so the series line up across the ranks
+        for(const sweep_series &series : sweep_samples) {
+            double exponent = get_complexity_exponent(series);
+            std::vector<double> all_exponents(num_procs);
+            MPI_Gather(&exponent, 1, MPI_DOUBLE, all_exponents.data(), 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+            if(rank == 0) {
+                for(int i = 0; i < all_configs.size(); i++) {
+                    print_complexity_exponent(series.category, series.test_name, all_exponents[i], all_configs[i]);
+                }
+            }
+        }
+    }
+    else {
+        for(const sweep_series &series : sweep_samples) {
+            print_complexity_exponent(series.category, series.test_name, get_complexity_exponent(series), config);
+        }
+    }
+    sweep_samples.clear();
+}
@@ -0,0 +1,140 @@
+#include "synthetic_data.hh"
+#include "counter_rng.hh"
+#include <cfloat>
+
+//counters reserved for each item. the generators use at most 7 for the position and 3 for a bbox's extents
+#define DRAWS_PER_ITEM 16
+#define EXTENT_DRAWS_OFFSET 8
+
+#define NUM_CLUSTERS 16
+//as a fraction of the domain length
+#define CLUSTER_STDDEV .02
+#define POWER_LAW_EXPONENT 4
+#define SHELL_RADIUS .4
+#define SHELL_THICKNESS .002
+#define NUM_SLABS 4
+#define SLAB_THICKNESS .002
+//number of distinct values per dimension
+#define DUPLICATE_LATTICE_SIZE 10
+//bbox extents are drawn from this range (as fractions of the domain length). smaller than get_random_data's boxes, so they don't blur the distribution
+#define MIN_BBOX_EXTENT .001
+#define MAX_BBOX_EXTENT .01
+
+//the cluster centres are shared by every item (and rank), so they come from their own seed
+static std::vector<point> get_cluster_centers() {
+    std::vector<point> centers(NUM_CLUSTERS);
+    for(size_t i = 0; i < NUM_CLUSTERS; i++) {
+        for(int d = 0; d < NUM_DIMS; d++) {
+            //keeps most of each cluster inside the unit cube
+            centers[i][d] = .1 + .8 * counter_rng_uniform(SYNTHETIC_DATA_SEED + 1, i*NUM_DIMS + d);
+        }
+    }
+    return centers;
+}
+
+static double clamp_to_unit(double value) {
+    return std::min(1.0, std::max(0.0, value));
+}
+
+//a point in the unit cube, drawn from counters [first_counter, first_counter + EXTENT_DRAWS_OFFSET)
+static point get_unit_point(DataSource data_source, uint64_t first_counter, const std::vector<point> &cluster_centers) {
+    uint64_t seed = SYNTHETIC_DATA_SEED;
+    point pt;
+    switch(data_source) {
+        case GAUSSIAN_CLUSTERS: {
+            size_t cluster = std::min((size_t)(counter_rng_uniform(seed, first_counter) * NUM_CLUSTERS), (size_t)NUM_CLUSTERS-1);
+            for(int d = 0; d < NUM_DIMS; d++) {
+                pt[d] = clamp_to_unit(cluster_centers[cluster][d] + CLUSTER_STDDEV * counter_rng_normal(seed, first_counter + 1 + 2*d));
+            }
+            break;
+        }
+        case POWER_LAW_DENSITY: {
+            for(int d = 0; d < NUM_DIMS; d++) {
+                pt[d] = std::pow(counter_rng_uniform(seed, first_counter + d), POWER_LAW_EXPONENT);
+            }
+            break;
+        }
+        case THIN_SHELLS: {
+            //normalized gaussian vectors are uniform over the sphere
+            double direction[NUM_DIMS];
+            double length = 0;
+            for(int d = 0; d < NUM_DIMS; d++) {
+                direction[d] = counter_rng_normal(seed, first_counter + 2*d);
+                length += direction[d] * direction[d];
+            }
+            length = std::max(std::sqrt(length), DBL_MIN);
+            double radius = SHELL_RADIUS + SHELL_THICKNESS * (counter_rng_uniform(seed, first_counter + 2*NUM_DIMS) - .5);
+            for(int d = 0; d < NUM_DIMS; d++) {
+                pt[d] = .5 + radius * direction[d] / length;
+            }
+            break;
+        }
+        case ANISOTROPIC_SLABS: {
+            pt[0] = counter_rng_uniform(seed, first_counter);
+            pt[1] = counter_rng_uniform(seed, first_counter + 1);
+            size_t slab = std::min((size_t)(counter_rng_uniform(seed, first_counter + 2) * NUM_SLABS), (size_t)NUM_SLABS-1);
+            pt[2] = (slab + .5) / NUM_SLABS + SLAB_THICKNESS * (counter_rng_uniform(seed, first_counter + 3) - .5);
+            break;
+        }
+        case DUPLICATE_COORDINATES: {
+            for(int d = 0; d < NUM_DIMS; d++) {
+                size_t lattice_index = std::min((size_t)(counter_rng_uniform(seed, first_counter + d) * DUPLICATE_LATTICE_SIZE), (size_t)DUPLICATE_LATTICE_SIZE-1);
+                pt[d] = (lattice_index + .5) / DUPLICATE_LATTICE_SIZE;
+            }
+            break;
+        }
+        default: {
+            for(int d = 0; d < NUM_DIMS; d++) {
+                pt[d] = counter_rng_uniform(seed, first_counter + d);
+            }
+            break;
+        }
+    }
+    return pt;
+}
+
+void get_synthetic_data(DataSource data_source, DataType data_type, size_t num_data_pts, uint64_t first_item,
+    std::vector<point> &pts, bbox &domain_bounds)
+{
+    if(data_source == EXODUS_MESH || data_source >= NUM_DATA_SOURCES) {
+        std::cerr << "error. get_synthetic_data was called with data source " << data_source << ", which isn't a synthetic data source" << std::endl;
+        exit(-1);
+    }
+    if(data_type != POINTS && data_type != BBOXES) {
+        std::cerr << "error. synthetic data is only supported for points and bboxes" << std::endl;
+        exit(-1);
+    }
+    size_t pts_per_item = (data_type == POINTS) ? 1 : 2;
+    std::vector<point> cluster_centers = get_cluster_centers();
+
+    double min_x = DBL_MAX, min_y = DBL_MAX, min_z = DBL_MAX;
+    double max_x = -DBL_MAX, max_y = -DBL_MAX, max_z = -DBL_MAX;
+
+    pts.resize(pts_per_item * num_data_pts);
+    #pragma omp parallel for reduction(min:min_x,min_y,min_z) reduction(max:max_x,max_y,max_z)
+    for(int64_t i = 0; i < (int64_t)num_data_pts; i++) {
+        uint64_t first_counter = (first_item + i) * DRAWS_PER_ITEM;
+        point unit_pt = get_unit_point(data_source, first_counter, cluster_centers);
+        point lower, upper;
+        for(int d = 0; d < NUM_DIMS; d++) {
+            lower[d] = DOMAIN_LENGTH * unit_pt[d];
+            upper[d] = lower[d];
+            if(data_type == BBOXES) {
+                double extent = MIN_BBOX_EXTENT + (MAX_BBOX_EXTENT - MIN_BBOX_EXTENT) * counter_rng_uniform(SYNTHETIC_DATA_SEED, first_counter + EXTENT_DRAWS_OFFSET + d);
+                upper[d] += DOMAIN_LENGTH * extent;
+            }
+        }
+        pts[pts_per_item*i] = lower;
+        if(data_type == BBOXES) {
+            pts[pts_per_item*i+1] = upper;
+        }
+
+        min_x = std::min(min_x, lower[0]);
+        max_x = std::max(max_x, upper[0]);
+        min_y = std::min(min_y, lower[1]);
+        max_y = std::max(max_y, upper[1]);
+        min_z = std::min(min_z, lower[2]);
+        max_z = std::max(max_z, upper[2]);
+    }
+    domain_bounds = bbox(point({min_x, min_y, min_z}), point({max_x, max_y, max_z}));
+}
@@ -1,6 +1,8 @@
 #include <stdlib.h>
 #include <iostream>
 #include "range_tree_libraries.hh"
+#include "../benchmark/element_containment.hh"
+#include "../benchmark/counter_rng.hh"
 #include <algorithm> /* sort */
 #include <chrono> /* std::chrono::high_resolution_clock */
 
@@ -30,8 +32,21 @@ void run_tests(BboxIntersectionTest *test, const string &test_name, const std::v
     bool is_bboxes = false, bool delete_tree = true
     );
 
+void test_element_containment();
 
 
+
+bool check_bbox_intersection(const bbox &bounding_box, const point &min_corner, const point &max_corner) {
+    return(
+        bounding_box.first[0] <= max_corner[0] && 
+        bounding_box.second[0] >= min_corner[0] && 
+        bounding_box.first[1] <= max_corner[1] && 
+        bounding_box.second[1] >= min_corner[1] && 
+        bounding_box.first[2] <= max_corner[2] && 
+        bounding_box.second[2] >= min_corner[2]
+    );
+}
+
 bool check_intersection(const bbox &bounding_box, const point &pt) {
     return(
         bounding_box.first[0] <= pt[0] && 
@@ -54,6 +69,7 @@ int main(int argc, char **argv) {
     const size_t large_bucket_size = 50;
     vector<vector<size_t>> brute_force_results;
     vector<vector<size_t>> brute_force_results_bboxes;
+    vector<vector<size_t>> brute_force_results_triangles;
     double total_domain_volume;
     size_t num_data_pts;
 
@@ -208,7 +224,7 @@ int main(int argc, char **argv) {
 
     cout << "about to test libraries" << endl;
 
-    TestBruteForce *test_brute_force = new TestBruteForce();
+    TestBruteForce<> *test_brute_force = new TestBruteForce<>();
     brute_force_results.resize(query_bboxes.size());
     test_brute_force->build_tree(pts, indices);
     for(size_t i = 0; i < query_bboxes.size(); i++) {
@@ -217,9 +233,9 @@ int main(int argc, char **argv) {
         std::sort(brute_force_results[i].begin(), brute_force_results[i].end());
     }
 
-    TestBruteForce *test_brute_force_bboxes = new TestBruteForce();
+    TestBruteForce<> *test_brute_force_bboxes = new TestBruteForce<>();
     brute_force_results_bboxes.resize(query_bboxes.size());
-    test_brute_force_bboxes->build_tree(bbox_pts, bbox_indices);
+    test_brute_force_bboxes->build_tree_bbox(bbox_pts, bbox_indices);
     for(size_t i = 0; i < query_bboxes.size(); i++) {
         test_brute_force_bboxes->get_intersections_bboxes(query_bboxes[i], brute_force_results_bboxes[i]);
         //sort the results so that later it is easier to check if the tests equal the brute force results
@@ -227,6 +243,139 @@ int main(int argc, char **argv) {
     }
     cout << "done with brute force solution" << endl;
 
+    //single precision brute force only returns a superset, so this also checks the double precision refinement
+    auto test_brute_force_float = new TestBruteForce<float>();
+    test_brute_force_float->build_tree(pts, indices);
+    run_tests(test_brute_force_float, "Brute Force Float", query_bboxes, pts, indices, brute_force_results);
+    auto test_brute_force_bboxes_float = new TestBruteForce<float>();
+    test_brute_force_bboxes_float->build_tree_bbox(bbox_pts, bbox_indices);
+    run_tests(test_brute_force_bboxes_float, "Brute Force Bboxes Float", query_bboxes, bbox_pts, bbox_indices, brute_force_results_bboxes, IS_BBOX);
+
+    //every structure-of-arrays kernel has to match the baseline. kernels the cpu doesn't support fall back to the scalar one
+    std::vector<std::pair<BruteForceKernel, std::string>> brute_force_kernels = {
+        {SCALAR_KERNEL, "Scalar"}, {AVX2_KERNEL, "AVX2"}, {AVX512_KERNEL, "AVX-512"}
+    };
+    for(const std::pair<BruteForceKernel, std::string> &kernel : brute_force_kernels) {
+        auto test_brute_force_simd = new TestBruteForceSIMD(kernel.first);
+        test_brute_force_simd->build_tree(pts, indices);
+        run_tests(test_brute_force_simd, "Brute Force SoA " + kernel.second, query_bboxes, pts, indices, brute_force_results);
+        auto test_brute_force_simd_bboxes = new TestBruteForceSIMD(kernel.first);
+        test_brute_force_simd_bboxes->build_tree_bbox(bbox_pts, bbox_indices);
+        run_tests(test_brute_force_simd_bboxes, "Brute Force Bboxes SoA " + kernel.second, query_bboxes, bbox_pts, bbox_indices, brute_force_results_bboxes, IS_BBOX);
+    }
+
+    //the native kd-tree's leaf scans use the same kernels. a leaf size of 1 leaves some nodes empty, and the serial build has to match the threaded one
+    std::vector<std::pair<size_t, size_t>> native_kdtree_options = {{NUM_ELEMS_PER_NODE, 0}, {1, 0}, {200, 1}};
+    for(const std::pair<BruteForceKernel, std::string> &kernel : brute_force_kernels) {
+        for(const std::pair<size_t, size_t> &option : native_kdtree_options) {
+            std::string test_name = "Native Kdtree " + kernel.second + " Bucket Size = " + std::to_string(option.first) + (option.second == 1 ? " Serial Build" : "");
+            auto test_native_kdtree = new TestNativeKdtree(option.first, kernel.first, option.second);
+            test_native_kdtree->build_tree(pts, indices);
+            run_tests(test_native_kdtree, test_name, query_bboxes, pts, indices, brute_force_results);
+            auto test_native_kdtree_bboxes = new TestNativeKdtree(option.first, kernel.first, option.second);
+            test_native_kdtree_bboxes->build_tree_bbox(bbox_pts, bbox_indices);
+            run_tests(test_native_kdtree_bboxes, "Native Kdtree Bboxes " + test_name.substr(14), query_bboxes, bbox_pts, bbox_indices, brute_force_results_bboxes, IS_BBOX);
+        }
+    }
+
+    //the packed rtree, with both packings, float bounds (whose candidates get refined), and fan outs that leave partly filled nodes
+    std::vector<std::pair<size_t, PackingOrder>> native_rtree_options = {{8, STR_PACKING}, {8, HILBERT_PACKING}, {2, STR_PACKING}, {NUM_ELEMS_PER_NODE, HILBERT_PACKING}};
+    for(const std::pair<size_t, PackingOrder> &option : native_rtree_options) {
+        std::string test_name = std::string(option.second == STR_PACKING ? "STR" : "Hilbert") + " Fan Out = " + std::to_string(option.first);
+        auto test_native_rtree = new TestNativeRtree<>(option.first, option.second);
+        test_native_rtree->build_tree(pts, indices);
+        run_tests(test_native_rtree, "Native Rtree " + test_name, query_bboxes, pts, indices, brute_force_results);
+        auto test_native_rtree_bboxes = new TestNativeRtree<>(option.first, option.second);
+        test_native_rtree_bboxes->build_tree_bbox(bbox_pts, bbox_indices);
+        run_tests(test_native_rtree_bboxes, "Native Rtree Bboxes " + test_name, query_bboxes, bbox_pts, bbox_indices, brute_force_results_bboxes, IS_BBOX);
+        auto test_native_rtree_bboxes_float = new TestNativeRtree<float>(option.first, option.second);
+        test_native_rtree_bboxes_float->build_tree_bbox(bbox_pts, bbox_indices);
+        run_tests(test_native_rtree_bboxes_float, "Native Rtree Bboxes Float " + test_name, query_bboxes, bbox_pts, bbox_indices, brute_force_results_bboxes, IS_BBOX);
+    }
+
+    //the uniform grid, from cells that hold a single item on average to cells that hold many
+    for(size_t items_per_cell : std::vector<size_t>({1, 8, NUM_ELEMS_PER_NODE})) {
+        std::string test_name = "Items Per Cell = " + std::to_string(items_per_cell);
+        auto test_uniform_grid = new TestUniformGrid(items_per_cell);
+        test_uniform_grid->build_tree(pts, indices);
+        run_tests(test_uniform_grid, "Uniform Grid " + test_name, query_bboxes, pts, indices, brute_force_results);
+        auto test_uniform_grid_bboxes = new TestUniformGrid(items_per_cell);
+        test_uniform_grid_bboxes->build_tree_bbox(bbox_pts, bbox_indices);
+        run_tests(test_uniform_grid_bboxes, "Uniform Grid Bboxes " + test_name, query_bboxes, bbox_pts, bbox_indices, brute_force_results_bboxes, IS_BBOX);
+    }
+
+    //the linear octree, down to single point buckets (which split cells to their last level), with galloping and binary searches
+    std::vector<std::pair<size_t, bool>> linear_octree_options = {{NUM_ELEMS_PER_NODE, true}, {1, true}, {NUM_ELEMS_PER_NODE, false}};
+    for(const std::pair<size_t, bool> &option : linear_octree_options) {
+        auto test_linear_octree = new TestLinearOctree(option.first, option.second);
+        test_linear_octree->build_tree(pts, indices);
+        run_tests(test_linear_octree, "Linear Octree Bucket Size = " + std::to_string(option.first) + (option.second ? "" : " Binary Search"), query_bboxes, pts, indices, brute_force_results);
+    }
+
+    //the wide bvhs, with leaves down to single items. 8 wide nodes are tested with every kernel, since they take two avx2 iterations
+    for(const std::pair<BruteForceKernel, std::string> &kernel : brute_force_kernels) {
+        for(size_t leaf_size : std::vector<size_t>({1, 8})) {
+            std::string test_name = kernel.second + " Leaf Size = " + std::to_string(leaf_size);
+            auto test_wide_bvh4 = new TestWideBvh<4>(leaf_size, kernel.first);
+            test_wide_bvh4->build_tree(pts, indices);
+            run_tests(test_wide_bvh4, "Wide BVH 4 " + test_name, query_bboxes, pts, indices, brute_force_results);
+            auto test_wide_bvh4_bboxes = new TestWideBvh<4>(leaf_size, kernel.first);
+            test_wide_bvh4_bboxes->build_tree_bbox(bbox_pts, bbox_indices);
+            run_tests(test_wide_bvh4_bboxes, "Wide BVH 4 Bboxes " + test_name, query_bboxes, bbox_pts, bbox_indices, brute_force_results_bboxes, IS_BBOX);
+            auto test_wide_bvh8_bboxes = new TestWideBvh<8>(leaf_size, kernel.first);
+            test_wide_bvh8_bboxes->build_tree_bbox(bbox_pts, bbox_indices);
+            run_tests(test_wide_bvh8_bboxes, "Wide BVH 8 Bboxes " + test_name, query_bboxes, bbox_pts, bbox_indices, brute_force_results_bboxes, IS_BBOX);
+        }
+    }
+
+    //the scalar triangle kernel is the reference for the avx2 one and for filtering every bbox structure's candidates
+    auto test_brute_force_triangles = new TestBruteForceTriangles(SCALAR_KERNEL);
+    brute_force_results_triangles.resize(query_bboxes.size());
+    test_brute_force_triangles->build_tree(triangle_pts, triangle_indices);
+    for(size_t i = 0; i < query_bboxes.size(); i++) {
+        test_brute_force_triangles->get_intersections(query_bboxes[i], brute_force_results_triangles[i]);
+        std::sort(brute_force_results_triangles[i].begin(), brute_force_results_triangles[i].end());
+    }
+    delete test_brute_force_triangles;
+
+    auto test_brute_force_triangles_avx2 = new TestBruteForceTriangles(AVX2_KERNEL);
+    test_brute_force_triangles_avx2->build_tree(triangle_pts, triangle_indices);
+    run_tests(test_brute_force_triangles_avx2, "Brute Force Triangles AVX2", query_bboxes, triangle_pts, triangle_indices, brute_force_results_triangles);
+
+    auto test_brute_force_simd_triangles = new TestTriangleBboxes<TestBruteForceSIMD>(new TestBruteForceSIMD(),
+        [](TestBruteForceSIMD *test, const std::vector<point> &pts_bbox, const std::vector<size_t> &indices_bbox) { test->build_tree_bbox(pts_bbox, indices_bbox); });
+    test_brute_force_simd_triangles->build_tree(triangle_pts, triangle_indices);
+    run_tests(test_brute_force_simd_triangles, "Brute Force SoA Triangle Bboxes", query_bboxes, triangle_pts, triangle_indices, brute_force_results_triangles);
+
+    auto test_native_kdtree_triangles = new TestTriangleBboxes<TestNativeKdtree>(new TestNativeKdtree(),
+        [](TestNativeKdtree *test, const std::vector<point> &pts_bbox, const std::vector<size_t> &indices_bbox) { test->build_tree_bbox(pts_bbox, indices_bbox); });
+    test_native_kdtree_triangles->build_tree(triangle_pts, triangle_indices);
+    run_tests(test_native_kdtree_triangles, "Native Kdtree Triangle Bboxes", query_bboxes, triangle_pts, triangle_indices, brute_force_results_triangles);
+
+    auto test_native_rtree_triangles = new TestTriangleBboxes<TestNativeRtree<>>(new TestNativeRtree<>(),
+        [](TestNativeRtree<> *test, const std::vector<point> &pts_bbox, const std::vector<size_t> &indices_bbox) { test->build_tree_bbox(pts_bbox, indices_bbox); });
+    test_native_rtree_triangles->build_tree(triangle_pts, triangle_indices);
+    run_tests(test_native_rtree_triangles, "Native Rtree Triangle Bboxes", query_bboxes, triangle_pts, triangle_indices, brute_force_results_triangles);
+
+    auto test_uniform_grid_triangles = new TestTriangleBboxes<TestUniformGrid>(new TestUniformGrid(),
+        [](TestUniformGrid *test, const std::vector<point> &pts_bbox, const std::vector<size_t> &indices_bbox) { test->build_tree_bbox(pts_bbox, indices_bbox); });
+    test_uniform_grid_triangles->build_tree(triangle_pts, triangle_indices);
+    run_tests(test_uniform_grid_triangles, "Uniform Grid Triangle Bboxes", query_bboxes, triangle_pts, triangle_indices, brute_force_results_triangles);
+
+    auto test_wide_bvh_triangles = new TestTriangleBboxes<TestWideBvh<8>>(new TestWideBvh<8>(),
+        [](TestWideBvh<8> *test, const std::vector<point> &pts_bbox, const std::vector<size_t> &indices_bbox) { test->build_tree_bbox(pts_bbox, indices_bbox); });
+    test_wide_bvh_triangles->build_tree(triangle_pts, triangle_indices);
+    run_tests(test_wide_bvh_triangles, "Wide BVH 8 Triangle Bboxes", query_bboxes, triangle_pts, triangle_indices, brute_force_results_triangles);
+
+    #ifdef TEST_BOOST
+        auto test_boost_triangles = new TestTriangleBboxes<TestBoost<boost::geometry::index::linear<NUM_ELEMS_PER_NODE>>>(new TestBoost<boost::geometry::index::linear<NUM_ELEMS_PER_NODE>>(),
+            [](TestBoost<boost::geometry::index::linear<NUM_ELEMS_PER_NODE>> *test, const std::vector<point> &pts_bbox, const std::vector<size_t> &indices_bbox) { test->build_tree_bbox(pts_bbox, indices_bbox); });
+        test_boost_triangles->build_tree(triangle_pts, triangle_indices);
+        run_tests(test_boost_triangles, "Boost Triangle Bboxes", query_bboxes, triangle_pts, triangle_indices, brute_force_results_triangles);
+    #endif
+
+    test_element_containment();
+
     if(DEBUG) {
         cout << endl << "results: points" << endl;
         for(size_t i = 0; i < brute_force_results.size(); i++) {
@@ -384,10 +533,32 @@ int main(int argc, char **argv) {
         #endif
         run_tests(test_boost6, "Boost Boxes Bucket Size = 50", query_bboxes, bbox_pts, bbox_indices, brute_force_results_bboxes, IS_BBOX);
 
+        auto test_boost7 = new TestBoost<boost::geometry::index::linear<NUM_ELEMS_PER_NODE>, float>();
+        #if OUTPUT_TIMING_RESULTS
+            build_start_time = std::chrono::high_resolution_clock::now();
+            test_boost7->build_tree(pts, indices);
+            build_stop_time = std::chrono::high_resolution_clock::now();
+            cout << "Boost Float build time: " << std::chrono::duration_cast<std::chrono::nanoseconds>(build_stop_time - build_start_time).count() << " ns" << endl;
+        #else
+            test_boost7->build_tree(pts, indices);
+        #endif
+        run_tests(test_boost7, "Boost Float", query_bboxes, pts, indices, brute_force_results);
+
+        auto test_boost8 = new TestBoost<boost::geometry::index::linear<NUM_ELEMS_PER_NODE>, float>();
+        #if OUTPUT_TIMING_RESULTS
+            build_start_time = std::chrono::high_resolution_clock::now();
+            test_boost8->build_tree_bbox(bbox_pts, bbox_indices);
+            build_stop_time = std::chrono::high_resolution_clock::now();
+            cout << "Boost Boxes Float build time: " << std::chrono::duration_cast<std::chrono::nanoseconds>(build_stop_time - build_start_time).count() << " ns" << endl;
+        #else
+            test_boost8->build_tree_bbox(bbox_pts, bbox_indices);
+        #endif
+        run_tests(test_boost8, "Boost Boxes Float", query_bboxes, bbox_pts, bbox_indices, brute_force_results_bboxes, IS_BBOX);
+
     #endif 
 
     #ifdef TEST_CGAL
-        TestCGAL::KDTree *test_cgal_kdtree = new TestCGAL::KDTree();
+        TestCGAL::KDTree<> *test_cgal_kdtree = new TestCGAL::KDTree<>();
         #if OUTPUT_TIMING_RESULTS
             build_start_time = std::chrono::high_resolution_clock::now();
             test_cgal_kdtree->build_tree(pts, indices);
@@ -398,7 +569,7 @@ int main(int argc, char **argv) {
         #endif
         run_tests(test_cgal_kdtree, "CGAL Kdtree", query_bboxes, pts, indices, brute_force_results);
 
-        TestCGAL::KDTree *test_cgal_kdtree2 = new TestCGAL::KDTree();
+        TestCGAL::KDTree<> *test_cgal_kdtree2 = new TestCGAL::KDTree<>();
         #if OUTPUT_TIMING_RESULTS
             build_start_time = std::chrono::high_resolution_clock::now();
             test_cgal_kdtree2->build_tree(pts, indices, large_bucket_size);
@@ -409,6 +580,17 @@ int main(int argc, char **argv) {
         #endif
         run_tests(test_cgal_kdtree2, "CGAL Kdtree Bucket Size = 50", query_bboxes, pts, indices, brute_force_results);
 
+        auto test_cgal_kdtree_float = new TestCGAL::KDTree<float>();
+        #if OUTPUT_TIMING_RESULTS
+            build_start_time = std::chrono::high_resolution_clock::now();
+            test_cgal_kdtree_float->build_tree(pts, indices);
+            build_stop_time = std::chrono::high_resolution_clock::now();
+            cout << "CGAL Kdtree Float build time: " << std::chrono::duration_cast<std::chrono::nanoseconds>(build_stop_time - build_start_time).count() << " ns" << endl;
+        #else
+            test_cgal_kdtree_float->build_tree(pts, indices);
+        #endif
+        run_tests(test_cgal_kdtree_float, "CGAL Kdtree Float", query_bboxes, pts, indices, brute_force_results);
+
         TestCGAL::RangeTree *test_cgal_range_tree = new TestCGAL::RangeTree();
         #if OUTPUT_TIMING_RESULTS
             build_start_time = std::chrono::high_resolution_clock::now();
@@ -440,7 +622,7 @@ int main(int argc, char **argv) {
         #else
             test_cgal_aabb_tree->build_tree(triangle_pts, triangle_indices);
         #endif
-        run_tests(test_cgal_aabb_tree, "CGAL AABBTree Triangles", query_bboxes, pts, indices, brute_force_results);
+        run_tests(test_cgal_aabb_tree, "CGAL AABBTree Triangles", query_bboxes, triangle_pts, triangle_indices, brute_force_results_triangles);
 
         TestCGAL::AABBTree::Bboxes *test_cgal_aabb_tree_bboxes = new TestCGAL::AABBTree::Bboxes();
         #if OUTPUT_TIMING_RESULTS
@@ -845,8 +1027,8 @@ int main(int argc, char **argv) {
     #endif
 
     #ifdef TEST_NANOFLANN
-        TestNanoflann *test_nanoflann;
-        test_nanoflann = new TestNanoflann();
+        TestNanoflann<> *test_nanoflann;
+        test_nanoflann = new TestNanoflann<>();
         #if OUTPUT_TIMING_RESULTS
             build_start_time = std::chrono::high_resolution_clock::now();
             test_nanoflann->build_tree(pts, indices);
@@ -857,7 +1039,7 @@ int main(int argc, char **argv) {
         #endif
         run_tests(test_nanoflann, "Nanoflann", query_bboxes, pts, indices, brute_force_results);
 
-        test_nanoflann = new TestNanoflann();
+        test_nanoflann = new TestNanoflann<>();
         #if OUTPUT_TIMING_RESULTS
             build_start_time = std::chrono::high_resolution_clock::now();
             test_nanoflann->build_tree(pts, indices, large_bucket_size);
@@ -868,7 +1050,7 @@ int main(int argc, char **argv) {
         #endif
         run_tests(test_nanoflann, "Nanoflann Bucket Size = 50", query_bboxes, pts, indices, brute_force_results);
 
-        test_nanoflann = new TestNanoflann();
+        test_nanoflann = new TestNanoflann<>();
         #if OUTPUT_TIMING_RESULTS
             build_start_time = std::chrono::high_resolution_clock::now();
             test_nanoflann->build_tree(pts, indices, NUM_ELEMS_PER_NODE, true);
@@ -879,7 +1061,7 @@ int main(int argc, char **argv) {
         #endif
         run_tests(test_nanoflann, "Nanoflann Duplicated Storage ", query_bboxes, pts, indices, brute_force_results);
 
-        test_nanoflann = new TestNanoflann();
+        test_nanoflann = new TestNanoflann<>();
         #if OUTPUT_TIMING_RESULTS
             build_start_time = std::chrono::high_resolution_clock::now();
             test_nanoflann->build_tree(pts, indices, large_bucket_size, true);
@@ -890,6 +1072,17 @@ int main(int argc, char **argv) {
         #endif
         run_tests(test_nanoflann, "Nanoflann Duplicated Storage Bucket Size = 50", query_bboxes, pts, indices, brute_force_results);
 
+        auto test_nanoflann_float = new TestNanoflann<float>();
+        #if OUTPUT_TIMING_RESULTS
+            build_start_time = std::chrono::high_resolution_clock::now();
+            test_nanoflann_float->build_tree(pts, indices);
+            build_stop_time = std::chrono::high_resolution_clock::now();
+            cout << "Nanoflann Float build time: " << std::chrono::duration_cast<std::chrono::nanoseconds>(build_stop_time - build_start_time).count() << " ns" << endl;
+        #else
+            test_nanoflann_float->build_tree(pts, indices);
+        #endif
+        run_tests(test_nanoflann_float, "Nanoflann Float", query_bboxes, pts, indices, brute_force_results);
+
     #endif
 
     #ifdef TEST_OCTREE
@@ -976,8 +1169,8 @@ int main(int argc, char **argv) {
     #endif
 
     #ifdef TEST_PICO_TREE
-        TestPicoTree *test_pico_tree;
-        test_pico_tree = new TestPicoTree();
+        TestPicoTree<> *test_pico_tree;
+        test_pico_tree = new TestPicoTree<>();
         #if OUTPUT_TIMING_RESULTS
             build_start_time = std::chrono::high_resolution_clock::now();
             test_pico_tree->build_tree(pts, indices);
@@ -988,7 +1181,7 @@ int main(int argc, char **argv) {
         #endif
         run_tests(test_pico_tree, "Pico tree", query_bboxes, pts, indices, brute_force_results);
 
-        test_pico_tree = new TestPicoTree();
+        test_pico_tree = new TestPicoTree<>();
         #if OUTPUT_TIMING_RESULTS
             build_start_time = std::chrono::high_resolution_clock::now();
             test_pico_tree->build_tree(pts, indices, large_bucket_size);
@@ -998,6 +1191,17 @@ int main(int argc, char **argv) {
             test_pico_tree->build_tree(pts, indices, large_bucket_size);
         #endif
         run_tests(test_pico_tree, "Pico tree Bucket Size = 50", query_bboxes, pts, indices, brute_force_results);
+
+        auto test_pico_tree_float = new TestPicoTree<float>();
+        #if OUTPUT_TIMING_RESULTS
+            build_start_time = std::chrono::high_resolution_clock::now();
+            test_pico_tree_float->build_tree(pts, indices);
+            build_stop_time = std::chrono::high_resolution_clock::now();
+            cout << "Pico tree Float build time: " << std::chrono::duration_cast<std::chrono::nanoseconds>(build_stop_time - build_start_time).count() << " ns" << endl;
+        #else
+            test_pico_tree_float->build_tree(pts, indices);
+        #endif
+        run_tests(test_pico_tree_float, "Pico tree Float", query_bboxes, pts, indices, brute_force_results);
     #endif 
 
     #ifdef TEST_RTREE_TEMPLATE
@@ -1115,8 +1319,8 @@ void run_tests(BboxIntersectionTest *test, const string &test_name, const std::v
             test->get_intersections(query_bboxes[i], query_result_indices);
         }
 
-        //we don't have a good way to do correctness checking for triangle intersection
-        if (test_name.find("Triangles") == std::string::npos) { 
+        //the triangle tests are all exact, and are checked against the scalar triangle kernel
+        { 
             if(test->intersections_exact()) {
                 std::sort(query_result_indices.begin(), query_result_indices.end());
                 if(query_result_indices != correct_results[i]) {
@@ -1145,7 +1349,9 @@ void run_tests(BboxIntersectionTest *test, const string &test_name, const std::v
                 vector<size_t> exact_intersections;
                 exact_intersections.reserve(query_result_indices.size());
                 for(auto index : query_result_indices) {
-                    if(check_intersection(query_bboxes[i], pts[index])) {
+                    bool intersects = is_bboxes ? 
+                        check_bbox_intersection(query_bboxes[i], pts[2*index], pts[2*index+1]) : check_intersection(query_bboxes[i], pts[index]);
+                    if(intersects) {
                         exact_intersections.push_back(index);
                     }
                 }
@@ -1192,11 +1398,11 @@ void run_tests(BboxIntersectionTest *test, const string &test_name, const std::v
                 }
                 else {
                     //print the triangle
-                    if (test_name.find("Triangles") != std::string::npos) { 
+                    if (test_name.find("Triangle") != std::string::npos) { 
                         cout << "triangle: " << endl; 
-                        print_point(pts[query_result_index]);
-                        print_point(pts[query_result_index+DOMAIN_LENGTH]);
-                        print_point(pts[query_result_index+DOMAIN_LENGTH*DOMAIN_LENGTH]);
+                        print_point(pts[3*query_result_index]);
+                        print_point(pts[3*query_result_index+1]);
+                        print_point(pts[3*query_result_index+2]);
                     }
                     else if(is_bboxes) {
                         cout << "bbox: " << endl; 
@@ -1218,6 +1424,63 @@ void run_tests(BboxIntersectionTest *test, const string &test_name, const std::v
         cout << "memory after issuing queries" << endl;
         MemTrack::TrackListMemoryUsage();
     #endif
+
+    //the batched entry point has to give the same (filtered) results as issuing the queries one at a time
+    if (test_name != "PCL OctreeGPU query domain decomposition") { 
+        batch_results results;
+        results.clear();
+        test->get_intersections_batch(query_bboxes.data(), query_bboxes.size(), results);
+        if(results.num_queries() != query_bboxes.size()) {
+            cout << "error. the batched query returned results for " << results.num_queries() << " queries when it should have for " << query_bboxes.size() << endl;
+        }
+        else {
+            for(size_t i = 0; i < query_bboxes.size(); i++) {
+                vector<size_t> batch_intersections;
+                for(size_t j = 0; j < results.num_results(i); j++) {
+                    size_t index = results.results(i)[j];
+                    bool intersects = is_bboxes ? 
+                        check_bbox_intersection(query_bboxes[i], pts[2*index], pts[2*index+1]) : check_intersection(query_bboxes[i], pts[index]);
+                    if(test->intersections_exact() || intersects) {
+                        batch_intersections.push_back(index);
+                    }
+                }
+                std::sort(batch_intersections.begin(), batch_intersections.end());
+                if(batch_intersections != correct_results[i]) {
+                    cout << "query " << i << ": ";
+                    print_bbox(query_bboxes[i]);
+                    cout << "error. batched results do not match. the library finds " <<  batch_intersections.size() << " results when it should find " << correct_results[i].size() << endl;
+                }
+            }
+        }
+
+        //so do the sinks, and the count only sink has to see exactly as many results as the one that stores them
+        for(size_t i = 0; i < query_bboxes.size(); i++) {
+            vector<size_t> visited_indices;
+            VectorSink vector_sink(visited_indices);
+            test->visit_intersections(query_bboxes[i], vector_sink);
+            CountSink count_sink;
+            test->visit_intersections(query_bboxes[i], count_sink);
+            if(count_sink.count != visited_indices.size()) {
+                cout << "error. the count only sink sees " << count_sink.count << " results when the vector sink sees " << visited_indices.size() << endl;
+            }
+
+            vector<size_t> visited_intersections;
+            for(size_t index : visited_indices) {
+                bool intersects = is_bboxes ? 
+                    check_bbox_intersection(query_bboxes[i], pts[2*index], pts[2*index+1]) : check_intersection(query_bboxes[i], pts[index]);
+                if(test->intersections_exact() || intersects) {
+                    visited_intersections.push_back(index);
+                }
+            }
+            std::sort(visited_intersections.begin(), visited_intersections.end());
+            if(visited_intersections != correct_results[i]) {
+                cout << "query " << i << ": ";
+                print_bbox(query_bboxes[i]);
+                cout << "error. visited results do not match. the library finds " <<  visited_intersections.size() << " results when it should find " << correct_results[i].size() << endl;
+            }
+        }
+    }
+
     if(delete_tree) {
         delete test; 
     }
@@ -1277,7 +1540,7 @@ void test_feature_generation() {
 
     for(size_t i = 0; i < all_query_sizes.size(); i++) {
        for(size_t j = 0; j < num_queries; j++) {
-            point query_lower_corner(domain_lower_bounds.size()), query_upper_corner(domain_lower_bounds.size());
+            point query_lower_corner, query_upper_corner;
             for(size_t k = 0; k < domain_lower_bounds.size(); k++) {
                 query_lower_corner[k] = generators[k]();
                 double len = all_query_sizes[i][k];
@@ -1298,3 +1561,126 @@ void test_feature_generation() {
     }
 
 }
+
+//appends an element with the given nodes (each offset by shift) to the connectivity
+static void add_element(element_connectivity &connectivity, const std::vector<point> &nodes, const point &shift) {
+    for(const point &node : nodes) {
+        connectivity.node_ids.push_back(connectivity.num_nodes++);
+        connectivity.node_coords.push_back(point({node[0] + shift[0], node[1] + shift[1], node[2] + shift[2]}));
+    }
+    connectivity.offsets.push_back(connectivity.node_ids.size());
+}
+
+//the sorted elements that contain the probe, out of every element
+static std::vector<size_t> get_containing_elements(ElementContainment &containment, const point &probe, size_t num_elements) {
+    std::vector<size_t> candidates(num_elements);
+    for(size_t e = 0; e < num_elements; e++) {
+        candidates[e] = e;
+    }
+    size_t num_matches = containment.contains(probe, candidates.data(), num_elements, candidates.data());
+    candidates.resize(num_matches);
+    std::sort(candidates.begin(), candidates.end());
+    return candidates;
+}
+
+//checks the scalar and avx2 point in element tests against probes whose containing elements are known. there are 4 hexes and 
+//4 good tets, so the avx2 kernel gets a full vector of each
+void test_element_containment() {
+    cout << "testing Element Containment" << endl;
+    const std::vector<point> unit_hex = {{0,0,0}, {1,0,0}, {1,1,0}, {0,1,0}, {0,0,1}, {1,0,1}, {1,1,1}, {0,1,1}};
+    std::vector<point> distorted_hex = unit_hex;
+    distorted_hex[6] = point({1.6, 1.5, 1.4});
+    std::vector<point> sheared_hex = unit_hex;
+    for(point &node : sheared_hex) {
+        node[0] += .3 * node[2];
+    }
+    const std::vector<point> unit_tet = {{0,0,0}, {1,0,0}, {0,1,0}, {0,0,1}};
+
+    element_connectivity connectivity;
+    add_element(connectivity, unit_hex, {0,0,0});                                   //0
+    add_element(connectivity, unit_hex, {1,0,0});                                   //1, shares the face x = 1 with 0
+    add_element(connectivity, distorted_hex, {3,0,0});                              //2
+    add_element(connectivity, sheared_hex, {0,3,0});                                //3
+    add_element(connectivity, unit_tet, {0,0,2});                                   //4
+    add_element(connectivity, {{1,0,2}, {0,1,2}, {0,0,3}, {1,1,3}}, {0,0,0});       //5, shares a face with 4
+    add_element(connectivity, unit_tet, {3,0,2});                                   //6
+    add_element(connectivity, unit_tet, {0,3,2});                                   //7
+    add_element(connectivity, {{0,0,0}, {1,0,0}, {0,1,0}, {1,1,0}}, {5,5,5});       //8, degenerate (flat)
+    add_element(connectivity, {{0,0,0}, {1,0,0}, {0,1,0}, {0,0,1}, {1,0,1}, {0,1,1}}, {7,0,0}); //9, a wedge
+    size_t num_elements = connectivity.num_elements();
+
+    //the distorted hex's center is the average of its nodes
+    point distorted_center = {3, 0, 0};
+    for(const point &node : distorted_hex) {
+        for(int d = 0; d < NUM_DIMS; d++) {
+            distorted_center[d] += node[d] / 8;
+        }
+    }
+    std::vector<std::pair<point, std::vector<size_t>>> known_probes = {
+        {{.5, .5, .5}, {0}},
+        {{1, .5, .5}, {0, 1}},
+        {{10, 10, 10}, {}},
+        {distorted_center, {2}},
+        //inside the distorted hex's bounding box, but outside of its bulging face
+        {{4.5, 1, .1}, {}},
+        {{.5 + .3*.5, 3.5, .5}, {3}},
+        {{.2, .2, 2.2}, {4}},
+        {{1.0/3, 1.0/3, 7.0/3}, {4, 5}},
+        {{3.1, .1, 2.1}, {6}},
+        {{5.5, 5.5, 5}, {}},
+        {{7.2, .2, .5}, {}}
+    };
+
+    ElementContainment scalar_containment(connectivity, false);
+    ElementContainment avx2_containment(connectivity, true);
+    if(scalar_containment.num_unsupported_elements() != 2 || avx2_containment.num_unsupported_elements() != 2) {
+        cout << "error. the degenerate tet and the wedge should be the only unsupported elements, but there are " << 
+            scalar_containment.num_unsupported_elements() << endl;
+    }
+    for(size_t i = 0; i < known_probes.size(); i++) {
+        std::vector<size_t> scalar_matches = get_containing_elements(scalar_containment, known_probes[i].first, num_elements);
+        std::vector<size_t> avx2_matches = get_containing_elements(avx2_containment, known_probes[i].first, num_elements);
+        if(scalar_matches != known_probes[i].second || avx2_matches != known_probes[i].second) {
+            cout << "error. probe " << i << " is in " << known_probes[i].second.size() << " elements, but the scalar test finds " << 
+                scalar_matches.size() << " and the avx2 test finds " << avx2_matches.size() << endl;
+        }
+    }
+
+    //every probe point is in the element it was drawn from (only the supported elements are used, since the others contain nothing)
+    element_connectivity supported_connectivity = connectivity;
+    supported_connectivity.offsets.resize(9);
+    supported_connectivity.node_ids.resize(supported_connectivity.offsets.back());
+    std::vector<point> probes;
+    get_probe_points(1000, supported_connectivity, probes);
+    ElementContainment scalar_supported_containment(supported_connectivity, false);
+    ElementContainment avx2_supported_containment(supported_connectivity, true);
+    for(const point &probe : probes) {
+        std::vector<size_t> scalar_matches = get_containing_elements(scalar_supported_containment, probe, 8);
+        std::vector<size_t> avx2_matches = get_containing_elements(avx2_supported_containment, probe, 8);
+        if(scalar_matches.empty() || scalar_matches != avx2_matches) {
+            cout << "error. a probe point is in " << scalar_matches.size() << " elements for the scalar test and " << 
+                avx2_matches.size() << " for the avx2 test. it should be in at least one, and they should agree" << endl;
+        }
+    }
+
+    //random points around the elements: the tests have to agree, and the axis aligned hexes can't report points outside of their boxes
+    for(size_t i = 0; i < 10000; i++) {
+        point probe;
+        for(int d = 0; d < NUM_DIMS; d++) {
+            probe[d] = -.5 + 9 * counter_rng_uniform(700, NUM_DIMS*i + d);
+        }
+        std::vector<size_t> scalar_matches = get_containing_elements(scalar_containment, probe, num_elements);
+        std::vector<size_t> avx2_matches = get_containing_elements(avx2_containment, probe, num_elements);
+        if(scalar_matches != avx2_matches) {
+            cout << "error. the scalar and avx2 tests disagree on a random point" << endl;
+        }
+        for(size_t element : scalar_matches) {
+            bool outside_box = (element < 2) && !check_bbox_intersection(std::make_pair(probe, probe), 
+                connectivity.node_coords[8*element], connectivity.node_coords[8*element + 6]);
+            if(outside_box || element >= 8) {
+                cout << "error. element " << element << " contains a point outside of it: ";
+                print_point(probe);
+            }
+        }
+    }
+}